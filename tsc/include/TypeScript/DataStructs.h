@@ -19,6 +19,17 @@ struct CompileOptions
     bool isWasm;
     bool isWindows;
     enum Exports exportOpt;
+    bool typeCacheStats;
+    bool allocProfile;
+};
+
+// counters of code generator (used in --time-report)
+struct CompileStatistics
+{
+    unsigned statements = 0;
+    unsigned processStatementsIterations = 0;
+    unsigned genericInstantiations = 0;
+    unsigned evaluateCalls = 0;
 };
 
 #endif // TYPESCRIPT_DATASTRUCT_H_
\ No newline at end of file
@@ -145,9 +145,23 @@ class LLVMCodeHelperBase
 
         auto llvmIndexType = tch.convertType(th.getIndexType());
 
-        // Create the global at the entry of the module.
+        // names of literals are hashes of values, do not reuse global of another literal with the same name
         LLVM::GlobalOp global;
-        if (!(global = parentModule.lookupSymbol<LLVM::GlobalOp>(name)))
+        std::string uniqueName = name.str();
+        auto suffix = 0;
+        while ((global = parentModule.lookupSymbol<LLVM::GlobalOp>(uniqueName)))
+        {
+            auto strAttr = global.getValueOrNull().dyn_cast_or_null<StringAttr>();
+            if (strAttr && strAttr.getValue() == value)
+            {
+                break;
+            }
+
+            uniqueName = (name + "_" + Twine(++suffix)).str();
+        }
+
+        // Create the global at the entry of the module.
+        if (!global)
         {
             OpBuilder::InsertionGuard insertGuard(rewriter);
             rewriter.setInsertionPointToStart(parentModule.getBody());
@@ -155,7 +169,7 @@ class LLVMCodeHelperBase
             seekLast<StringAttr>(parentModule.getBody());
 
             auto type = th.getArrayType(th.getI8Type(), value.size());
-            global = rewriter.create<LLVM::GlobalOp>(loc, type, true, LLVM::Linkage::Internal, name, rewriter.getStringAttr(value));
+            global = rewriter.create<LLVM::GlobalOp>(loc, type, true, LLVM::Linkage::Internal, uniqueName, rewriter.getStringAttr(value));
         }
 
         // Get the pointer to the first character in the global string.
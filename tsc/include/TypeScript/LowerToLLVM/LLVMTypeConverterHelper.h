@@ -22,9 +22,10 @@ namespace mlir_ts = mlir::typescript;
 namespace typescript
 {
 
+// LLVMContext is not thread safe, lowering runs in many threads (MLIR passes, tsc --batch)
 static llvm::LLVMContext &getGlobalContext() 
 {
-    static llvm::LLVMContext GlobalContext;
+    static thread_local llvm::LLVMContext GlobalContext;
     return GlobalContext;
 }
 
@@ -14,6 +14,7 @@ class MLIRContext;
 template <typename OpTy>
 class OwningOpRef;
 class ModuleOp;
+class TimingScope;
 } // namespace mlir
 
 namespace llvm
@@ -26,6 +27,8 @@ namespace typescript
 ::std::string dumpFromSource(const llvm::StringRef &fileName, const llvm::StringRef &source);
 mlir::OwningOpRef<mlir::ModuleOp> mlirGenFromSource(const mlir::MLIRContext &context, const llvm::StringRef &fileName, const llvm::SourceMgr &sourceMgr,
                                         CompileOptions &compileOptions);
+mlir::OwningOpRef<mlir::ModuleOp> mlirGenFromSource(const mlir::MLIRContext &context, const llvm::StringRef &fileName, const llvm::SourceMgr &sourceMgr,
+                                        CompileOptions &compileOptions, mlir::TimingScope &timing, CompileStatistics &statistics);
 } // namespace typescript
 
 #endif // MLIR_TYPESCRIPT_MLIRGEN_H_
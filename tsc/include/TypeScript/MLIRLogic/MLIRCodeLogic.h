@@ -828,6 +828,24 @@ class MLIRPropertyAccessCodeLogic
         if (propName == "map") return true;
         if (propName == "filter") return true;
         if (propName == "reduce") return true;
+        if (propName == "sort") return true;
+        if (propName == "indexOf") return true;
+        if (propName == "includes") return true;
+        if (propName == "slice") return true;
+        if (propName == "concat") return true;
+        if (propName == "join") return true;
+        return false;
+    }
+
+    // methods which are lowered into runtime kernels instead of loops
+    bool isArrayKernelMethod(StringRef propName)
+    {
+        if (propName == "sort") return true;
+        if (propName == "indexOf") return true;
+        if (propName == "includes") return true;
+        if (propName == "slice") return true;
+        if (propName == "concat") return true;
+        if (propName == "join") return true;
         return false;
     }
 
@@ -846,6 +864,12 @@ class MLIRPropertyAccessCodeLogic
         if (propName == "map") return "__array_map";
         if (propName == "filter") return "__array_filter";
         if (propName == "reduce") return "__array_reduce";
+        if (propName == "sort") return "__array_sort";
+        if (propName == "indexOf") return "__array_indexof";
+        if (propName == "includes") return "__array_includes";
+        if (propName == "slice") return "__array_slice";
+        if (propName == "concat") return "__array_concat";
+        if (propName == "join") return "__array_join";
         return nullptr;
     }
 
@@ -920,6 +944,11 @@ class MLIRPropertyAccessCodeLogic
                     elementType = arrayType.getElementType();
                 }
 
+                if (isArrayKernelMethod(propName))
+                {
+                    return ArrayKernelMethod(propName, elementType);
+                }
+
                 auto isReduce = propName == "reduce";
                 SmallVector<mlir::Type> resultArgs;
                 if (isArrayCustomMethodReturnsBool(propName))
@@ -959,6 +988,52 @@ class MLIRPropertyAccessCodeLogic
         return mlir::Value();
     }
 
+    mlir::Value ArrayKernelMethod(StringRef propName, mlir::Type elementType)
+    {
+        auto context = builder.getContext();
+        auto numberType = mlir_ts::NumberType::get(context);
+        auto stringType = mlir_ts::StringType::get(context);
+        auto arrayType = mlir_ts::ArrayType::get(elementType);
+
+        // types of parameters are used as receiver types of arguments
+        SmallVector<mlir::Type> funcArgs;
+        SmallVector<mlir::Type> resultArgs;
+        if (propName == "sort")
+        {
+            funcArgs.push_back(mlir_ts::FunctionType::get(context, {elementType, elementType}, {numberType}, false));
+            resultArgs.push_back(arrayType);
+        }
+        else if (propName == "indexOf" || propName == "includes")
+        {
+            funcArgs.push_back(elementType);
+            funcArgs.push_back(numberType);
+            resultArgs.push_back(propName == "includes" ? (mlir::Type)mlir_ts::BooleanType::get(context) : numberType);
+        }
+        else if (propName == "slice")
+        {
+            funcArgs.push_back(numberType);
+            funcArgs.push_back(numberType);
+            resultArgs.push_back(arrayType);
+        }
+        else if (propName == "concat")
+        {
+            // arguments are arrays or values
+            resultArgs.push_back(arrayType);
+        }
+        else if (propName == "join")
+        {
+            funcArgs.push_back(stringType);
+            resultArgs.push_back(stringType);
+        }
+
+        auto funcType = mlir_ts::FunctionType::get(context, funcArgs, resultArgs);
+        auto symbOp = builder.create<mlir_ts::ThisSymbolRefOp>(
+            location, funcType, expression,
+            mlir::FlatSymbolRefAttr::get(context, getArrayCustomMethodName(propName)));
+        symbOp->setAttr(VIRTUALFUNC_ATTR_NAME, mlir::BoolAttr::get(context, true));
+        return symbOp;
+    }
+
     template <typename T> mlir::Value Ref(T refType)
     {
         if (auto constTupleType = refType.getElementType().template dyn_cast<mlir_ts::ConstTupleType>())
@@ -7,9 +7,14 @@
 #include "TypeScript/MLIRLogic/MLIRTypeIterator.h"
 #include "TypeScript/MLIRLogic/MLIRHelper.h"
 
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/raw_ostream.h"
 
 #include <functional>
+#include <memory>
+#include <tuple>
 
 namespace mlir_ts = mlir::typescript;
 
@@ -43,15 +48,63 @@ inline bool isTrue(ExtendsResult val)
     return val == ExtendsResult::True || val == ExtendsResult::Any;
 }
 
+// Results of type relation queries. Types are uniqued by MLIRContext, so pointers of types are the keys.
+// Result is stored only when class/interface info was not requested during calculation, such info is
+// filled step by step while declarations are processed, and the same query can give other answer later.
+struct TypeRelationCache
+{
+    struct Counter
+    {
+        unsigned hits = 0;
+        unsigned misses = 0;
+    };
+
+    llvm::DenseMap<std::pair<mlir::Type, mlir::Type>, bool> canCastFromTo;
+    llvm::DenseMap<std::tuple<mlir::Type, mlir::Type, unsigned>, MatchResult> functionTypesMatch;
+    llvm::DenseMap<std::tuple<mlir::Type, mlir::Type, unsigned>, ExtendsResult> extendsType;
+    llvm::DenseMap<std::pair<mlir::Type, unsigned>, mlir::Type> unionTypeWithMerge;
+
+    Counter canCastFromToCounter;
+    Counter functionTypesMatchCounter;
+    Counter extendsTypeCounter;
+    Counter unionTypeWithMergeCounter;
+
+    unsigned nominalLookups = 0;
+
+    void print(llvm::raw_ostream &os) const
+    {
+        os << "type relation cache (hits / misses):\n";
+        printCounter(os, "canCastFromTo", canCastFromToCounter);
+        printCounter(os, "TestFunctionTypesMatch", functionTypesMatchCounter);
+        printCounter(os, "extendsType", extendsTypeCounter);
+        printCounter(os, "getUnionTypeWithMerge", unionTypeWithMergeCounter);
+    }
+
+  private:
+    static void printCounter(llvm::raw_ostream &os, StringRef name, const Counter &counter)
+    {
+        auto total = counter.hits + counter.misses;
+        os << "  " << name << ": " << counter.hits << " / " << counter.misses;
+        if (total > 0)
+        {
+            os << " (" << llvm::format("%.1f", 100.0 * counter.hits / total) << "% hits)";
+        }
+
+        os << "\n";
+    }
+};
+
 class MLIRTypeHelper
 {
     mlir::MLIRContext *context;
 
+    std::shared_ptr<TypeRelationCache> relationCache;
+
   public:
 
     MLIRTypeHelper(
         mlir::MLIRContext *context)
-        : context(context)
+        : context(context), relationCache(std::make_shared<TypeRelationCache>())
     {
     }
 
@@ -62,11 +115,17 @@ class MLIRTypeHelper
         std::function<InterfaceInfo::TypePtr(StringRef)> getInterfaceInfoByFullName,
         std::function<GenericInterfaceInfo::TypePtr(StringRef)> getGenericInterfaceInfoByFullName) 
         : context(context), 
-          getClassInfoByFullName(getClassInfoByFullName),
-          getGenericClassInfoByFullName(getGenericClassInfoByFullName),
-          getInterfaceInfoByFullName(getInterfaceInfoByFullName),
-          getGenericInterfaceInfoByFullName(getGenericInterfaceInfoByFullName)
+          relationCache(std::make_shared<TypeRelationCache>()),
+          getClassInfoByFullName(trackNominalLookups(getClassInfoByFullName)),
+          getGenericClassInfoByFullName(trackNominalLookups(getGenericClassInfoByFullName)),
+          getInterfaceInfoByFullName(trackNominalLookups(getInterfaceInfoByFullName)),
+          getGenericInterfaceInfoByFullName(trackNominalLookups(getGenericInterfaceInfoByFullName))
+    {
+    }
+
+    const TypeRelationCache &getTypeRelationCache() const
     {
+        return *relationCache;
     }
 
     // types
@@ -915,6 +974,14 @@ class MLIRTypeHelper
     }    
 
     MatchResult TestFunctionTypesMatch(mlir_ts::FunctionType inFuncType, mlir_ts::FunctionType resFuncType, unsigned startParam = 0)
+    {
+        return memoize(
+            relationCache->functionTypesMatch, relationCache->functionTypesMatchCounter,
+            std::make_tuple(mlir::Type(inFuncType), mlir::Type(resFuncType), startParam),
+            [&]() { return TestFunctionTypesMatchNoCache(inFuncType, resFuncType, startParam); });
+    }
+
+    MatchResult TestFunctionTypesMatchNoCache(mlir_ts::FunctionType inFuncType, mlir_ts::FunctionType resFuncType, unsigned startParam)
     {
         return TestFunctionTypesMatch(
             inFuncType.getInputs(), 
@@ -1200,7 +1267,14 @@ class MLIRTypeHelper
         {
             return true;
         }
-        
+
+        return memoize(
+            relationCache->canCastFromTo, relationCache->canCastFromToCounter, std::make_pair(srcType, destType),
+            [&]() { return canCastFromToNoCache(srcType, destType); });
+    }
+
+    bool canCastFromToNoCache(mlir::Type srcType, mlir::Type destType)
+    {
         if (canWideTypeWithoutDataLoss(srcType, destType))
         {
             return true;
@@ -1991,6 +2065,21 @@ class MLIRTypeHelper
     }
 
     ExtendsResult extendsType(mlir::Type srcType, mlir::Type extendType, llvm::StringMap<std::pair<ts::TypeParameterDOM::TypePtr,mlir::Type>> &typeParamsWithArgs, bool useTupleWhenMergeTypes = false)
+    {
+        // result depends on already inferred types, and inferred types are output of the call
+        if (!typeParamsWithArgs.empty())
+        {
+            return extendsTypeNoCache(srcType, extendType, typeParamsWithArgs, useTupleWhenMergeTypes);
+        }
+
+        return memoize(
+            relationCache->extendsType, relationCache->extendsTypeCounter,
+            std::make_tuple(srcType, extendType, static_cast<unsigned>(useTupleWhenMergeTypes)),
+            [&]() { return extendsTypeNoCache(srcType, extendType, typeParamsWithArgs, useTupleWhenMergeTypes); },
+            [&]() { return typeParamsWithArgs.empty(); });
+    }
+
+    ExtendsResult extendsTypeNoCache(mlir::Type srcType, mlir::Type extendType, llvm::StringMap<std::pair<ts::TypeParameterDOM::TypePtr,mlir::Type>> &typeParamsWithArgs, bool useTupleWhenMergeTypes)
     {
         LLVM_DEBUG(llvm::dbgs() << "\n!! is extending type: [ " << srcType << " ] extend type: [ " << extendType
                                 << " ]\n";);        
@@ -2592,6 +2681,21 @@ class MLIRTypeHelper
     }
 
     mlir::Type getUnionTypeWithMerge(mlir::ArrayRef<mlir::Type> types, bool mergeLiterals = true, bool mergeTypes = true)
+    {
+        if (llvm::any_of(types, [](mlir::Type type) { return !type; }))
+        {
+            llvm_unreachable("wrong type");
+        }
+
+        // builtin tuple is uniqued list of types
+        mlir::Type typesKey = mlir::TupleType::get(context, types);
+        return memoize(
+            relationCache->unionTypeWithMerge, relationCache->unionTypeWithMergeCounter,
+            std::make_pair(typesKey, (mergeLiterals ? 1u : 0u) | (mergeTypes ? 2u : 0u)),
+            [&]() { return getUnionTypeWithMergeNoCache(types, mergeLiterals, mergeTypes); });
+    }
+
+    mlir::Type getUnionTypeWithMergeNoCache(mlir::ArrayRef<mlir::Type> types, bool mergeLiterals, bool mergeTypes)
     {
         UnionTypeProcessContext unionContext = {};
 
@@ -3204,6 +3308,50 @@ class MLIRTypeHelper
     }
 
 protected:
+    template <typename T> std::function<T(StringRef)> trackNominalLookups(std::function<T(StringRef)> lookup)
+    {
+        if (!lookup)
+        {
+            return lookup;
+        }
+
+        // do not capture "this", helper can be copied
+        auto cache = relationCache;
+        return [=](StringRef fullName) {
+            cache->nominalLookups++;
+            return lookup(fullName);
+        };
+    }
+
+    template <typename K, typename V, typename F>
+    V memoize(llvm::DenseMap<K, V> &table, TypeRelationCache::Counter &counter, K key, F calc)
+    {
+        return memoize(table, counter, key, calc, []() { return true; });
+    }
+
+    template <typename K, typename V, typename F, typename C>
+    V memoize(llvm::DenseMap<K, V> &table, TypeRelationCache::Counter &counter, K key, F calc, C canStore)
+    {
+        auto it = table.find(key);
+        if (it != table.end())
+        {
+            counter.hits++;
+            return it->second;
+        }
+
+        counter.misses++;
+
+        auto nominalLookups = relationCache->nominalLookups;
+        V result = calc();
+        if (nominalLookups == relationCache->nominalLookups && canStore())
+        {
+            // do not use iterator from "find", table can be changed by recursive calls
+            table.try_emplace(key, result);
+        }
+
+        return result;
+    }
+
     std::function<ClassInfo::TypePtr(StringRef)> getClassInfoByFullName;
 
     std::function<GenericClassInfo::TypePtr(StringRef)> getGenericClassInfoByFullName;
@@ -26,6 +26,18 @@ std::unique_ptr<mlir::Pass> createLowerToLLVMPass(CompileOptions&);
 // TODO: should you process, switch satate in createLowerToAffinePass to resolve issue?
 std::unique_ptr<mlir::Pass> createRelocateConstantPass();
 
+/// Retypes local `number` variables proven to hold only integers (loop counters, indices) to i64
+std::unique_ptr<mlir::Pass> createIntegerRangePass();
+
+/// Lowers counted `for` loops with loop invariant bounds to scf.for
+std::unique_ptr<mlir::Pass> createStructuredLoopsPass();
+
+/// Replaces `throw` caught by `catch` of the same function with branch to the catch code
+std::unique_ptr<mlir::Pass> createLocalThrowPass();
+
+/// Leaves one LLVM global per unique string literal of module
+std::unique_ptr<mlir::Pass> createStringPoolPass();
+
 /// GC Pass to replace malloc, realloc, free with GC_malloc, GC_realloc, GC_free
 std::unique_ptr<mlir::Pass> createGCPass(CompileOptions&);
 /// MemAlloc Pass to replace ts_malloc, ts_realloc, ts_free
@@ -24,4 +24,18 @@ enum Exports
     IgnoreAll
 };
 
+enum LTOMode
+{
+    LTONone,
+    LTOThin,
+    LTOFull
+};
+
+enum TimeReport
+{
+    TimeReportNone,
+    TimeReportText,
+    TimeReportJson
+};
+
 #endif // TYPESCRIPT_COMPILER_DEFINES_H_
\ No newline at end of file
@@ -0,0 +1,388 @@
+#ifndef TYPESCRIPT_WORKSTEALINGTHREADPOOL_H_
+#define TYPESCRIPT_WORKSTEALINGTHREADPOOL_H_
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace mlir
+{
+namespace runtime
+{
+
+// -------------------------------------------------------------------------- //
+// Thread pool used by async runtime. Every worker owns a deque of tasks: the
+// worker pushes and pops tasks at the back of its own deque (LIFO, hot caches),
+// idle workers steal tasks from the front of deques of other workers (FIFO).
+// Tasks submitted from non-worker threads are distributed round-robin.
+// Deques are protected by own mutexes (not lock-free), thieves only try-lock
+// them. Idle workers sleep on condition variable until a task is pushed.
+//
+// Number of workers can be set by environment variable TSC_ASYNC_THREADS.
+// -------------------------------------------------------------------------- //
+
+class WorkStealingThreadPool
+{
+  public:
+    using Task = std::function<void()>;
+
+    WorkStealingThreadPool() : WorkStealingThreadPool(getDefaultThreadCount())
+    {
+    }
+
+    explicit WorkStealingThreadPool(unsigned threadCount)
+        : queues(threadCount > 0 ? threadCount : 1), pendingTasks(0), sleepingWorkers(0), nextQueue(0), stopping(false)
+    {
+        workers.reserve(queues.size());
+        for (unsigned index = 0; index < queues.size(); index++)
+        {
+            workers.emplace_back([this, index]() { workerLoop(index); });
+        }
+    }
+
+    ~WorkStealingThreadPool()
+    {
+        wait();
+
+        {
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            stopping = true;
+        }
+
+        sleepCondition.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+    }
+
+    WorkStealingThreadPool(const WorkStealingThreadPool &) = delete;
+    WorkStealingThreadPool &operator=(const WorkStealingThreadPool &) = delete;
+
+    static unsigned getDefaultThreadCount()
+    {
+        if (auto *value = std::getenv("TSC_ASYNC_THREADS"))
+        {
+            auto count = std::atoi(value);
+            if (count > 0)
+            {
+                return count;
+            }
+        }
+
+        auto count = std::thread::hardware_concurrency();
+        return count > 0 ? count : 1;
+    }
+
+    unsigned getThreadCount() const
+    {
+        return queues.size();
+    }
+
+    void async(Task task)
+    {
+        pendingTasks.fetch_add(1, std::memory_order_relaxed);
+
+        auto index = currentWorkerIndex();
+        if (index < 0)
+        {
+            index = nextQueue.fetch_add(1, std::memory_order_relaxed) % queues.size();
+        }
+
+        queues[index].push(std::move(task));
+
+        if (sleepingWorkers.load() > 0)
+        {
+            // take the lock to avoid lost wake up between empty check and wait in workerLoop
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleepCondition.notify_one();
+        }
+    }
+
+    // runs one pending task on the current thread (own queue first, then stealing), returns false if no tasks found
+    bool runPendingTask()
+    {
+        Task task;
+        if (!takeTask(currentWorkerIndex(), task))
+        {
+            return false;
+        }
+
+        runTask(task);
+        return true;
+    }
+
+    // true when called from one of the workers of this pool
+    bool isWorkerThread() const
+    {
+        return currentWorkerIndex() >= 0;
+    }
+
+    // blocks until all submitted tasks are completed, must not be called from worker
+    void wait()
+    {
+        assert(!isWorkerThread() && "can't wait for all tasks inside of task");
+
+        std::unique_lock<std::mutex> lock(completionMutex);
+        completionCondition.wait(lock, [this]() { return pendingTasks.load(std::memory_order_acquire) == 0; });
+    }
+
+  private:
+    class WorkQueue
+    {
+      public:
+        void push(Task task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            tasks.push_back(std::move(task));
+        }
+
+        bool popBack(Task &task)
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (tasks.empty())
+            {
+                return false;
+            }
+
+            task = std::move(tasks.back());
+            tasks.pop_back();
+            return true;
+        }
+
+        bool stealFront(Task &task, bool tryLock)
+        {
+            std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+            if (!tryLock)
+            {
+                lock.lock();
+            }
+            else if (!lock.try_lock())
+            {
+                return false;
+            }
+
+            if (tasks.empty())
+            {
+                return false;
+            }
+
+            task = std::move(tasks.front());
+            tasks.pop_front();
+            return true;
+        }
+
+      private:
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    int currentWorkerIndex() const
+    {
+        return currentPool() == this ? currentIndex() : -1;
+    }
+
+    static const WorkStealingThreadPool *&currentPool()
+    {
+        static thread_local const WorkStealingThreadPool *pool = nullptr;
+        return pool;
+    }
+
+    static int &currentIndex()
+    {
+        static thread_local int index = -1;
+        return index;
+    }
+
+    bool takeTask(int index, Task &task, bool tryLock = true)
+    {
+        if (index >= 0 && queues[index].popBack(task))
+        {
+            return true;
+        }
+
+        int count = queues.size();
+        auto start = index >= 0 ? index + 1 : 0;
+        for (auto attempt = 0; attempt < count; attempt++)
+        {
+            auto victim = (start + attempt) % count;
+            if (victim != index && queues[victim].stealFront(task, tryLock))
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void runTask(Task &task)
+    {
+        task();
+        task = nullptr;
+
+        if (pendingTasks.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            std::unique_lock<std::mutex> lock(completionMutex);
+            completionCondition.notify_all();
+        }
+    }
+
+    void workerLoop(int index)
+    {
+        currentPool() = this;
+        currentIndex() = index;
+
+        Task task;
+        while (true)
+        {
+            if (takeTask(index, task))
+            {
+                runTask(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            if (stopping)
+            {
+                break;
+            }
+
+            sleepingWorkers.fetch_add(1);
+            // re-check with blocking locks, task could be pushed before we registered as sleeping one. A task pushed
+            // after it is seen by async() as sleeping worker, and the notification waits for sleepMutex released by wait()
+            if (!takeTask(index, task, false))
+            {
+                sleepCondition.wait(lock);
+                sleepingWorkers.fetch_sub(1);
+                continue;
+            }
+
+            sleepingWorkers.fetch_sub(1);
+            lock.unlock();
+            runTask(task);
+        }
+    }
+
+    std::vector<WorkQueue> queues;
+    std::vector<std::thread> workers;
+
+    std::atomic<int64_t> pendingTasks;
+    std::atomic<int> sleepingWorkers;
+    std::atomic<unsigned> nextQueue;
+
+    std::mutex sleepMutex;
+    std::condition_variable sleepCondition;
+    bool stopping;
+
+    std::mutex completionMutex;
+    std::condition_variable completionCondition;
+};
+
+// -------------------------------------------------------------------------- //
+// Lock-free list of continuations of async token/value. Once the owner becomes
+// available the list is closed: all stored continuations are run by the
+// completing thread and continuations added later are run inline.
+// -------------------------------------------------------------------------- //
+
+class AwaiterList
+{
+  public:
+    using Awaiter = std::function<void()>;
+
+    AwaiterList() : head(nullptr)
+    {
+    }
+
+    ~AwaiterList()
+    {
+        auto *node = head.load(std::memory_order_acquire);
+        while (node && node != closedMarker())
+        {
+            auto *next = node->next;
+            delete node;
+            node = next;
+        }
+    }
+
+    AwaiterList(const AwaiterList &) = delete;
+    AwaiterList &operator=(const AwaiterList &) = delete;
+
+    bool isClosed() const
+    {
+        return head.load(std::memory_order_acquire) == closedMarker();
+    }
+
+    // stores continuation, or runs it on the current thread if the list is already closed
+    void addOrRun(Awaiter awaiter)
+    {
+        auto *current = head.load(std::memory_order_acquire);
+        if (current == closedMarker())
+        {
+            awaiter();
+            return;
+        }
+
+        auto *node = new Node{std::move(awaiter), current};
+        while (!head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_acquire))
+        {
+            if (node->next == closedMarker())
+            {
+                auto closedAwaiter = std::move(node->awaiter);
+                delete node;
+                closedAwaiter();
+                return;
+            }
+        }
+    }
+
+    // closes the list and runs all stored continuations in order they were added
+    void closeAndRun()
+    {
+        auto *node = head.exchange(closedMarker(), std::memory_order_acq_rel);
+        assert(node != closedMarker() && "awaiters list is already closed");
+
+        Node *reversed = nullptr;
+        while (node)
+        {
+            auto *next = node->next;
+            node->next = reversed;
+            reversed = node;
+            node = next;
+        }
+
+        while (reversed)
+        {
+            auto *next = reversed->next;
+            reversed->awaiter();
+            delete reversed;
+            reversed = next;
+        }
+    }
+
+  private:
+    struct Node
+    {
+        Awaiter awaiter;
+        Node *next;
+    };
+
+    static Node *closedMarker()
+    {
+        return reinterpret_cast<Node *>(static_cast<uintptr_t>(1));
+    }
+
+    std::atomic<Node *> head;
+};
+
+} // namespace runtime
+} // namespace mlir
+
+#endif // TYPESCRIPT_WORKSTEALINGTHREADPOOL_H_
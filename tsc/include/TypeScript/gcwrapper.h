@@ -20,3 +20,11 @@ void _mlir__GC_win32_free_heap();
 void *_mlir__GC_malloc_explicitly_typed(size_t size, int64_t descr);
 
 int64_t _mlir__GC_make_descriptor(const int64_t *descr, size_t size);
+
+void *_mlir__GC_malloc_profiled(size_t size, const char *site);
+
+void *_mlir__GC_malloc_atomic_profiled(size_t size, const char *site);
+
+void *_mlir__GC_malloc_explicitly_typed_profiled(size_t size, int64_t descr, const char *site);
+
+void *_mlir__GC_realloc_profiled(void *ptr, size_t size, const char *site);
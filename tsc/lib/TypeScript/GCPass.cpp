@@ -11,9 +11,13 @@
 
 #include "TypeScript/LowerToLLVMLogic.h"
 
+#include "mlir/Conversion/LLVMCommon/TypeConverter.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 
+#include "llvm/ADT/Hashing.h"
 #include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Debug.h"
 
 using namespace ::typescript;
@@ -76,6 +80,11 @@ class GCPass : public mlir::PassWrapper<GCPass, ModulePass>
                 }
 
                 renameCall(name, callOp);
+
+                if (tsContext.compileOptions.allocProfile)
+                {
+                    profileCall(callOp);
+                }
             }
         });
     }
@@ -154,6 +163,72 @@ class GCPass : public mlir::PassWrapper<GCPass, ModulePass>
         callOp.setCalleeAttr(::mlir::FlatSymbolRefAttr::get(callOp->getContext(), newName));
     }
 
+    // --alloc-profile: allocation is routed to "<name>_profiled" entry point of runtime with call site string as
+    // the last argument
+    void profileCall(LLVM::CallOp callOp)
+    {
+        auto name = callOp.getCallee().value();
+        if (name != "GC_malloc" && name != "GC_malloc_atomic" && name != "GC_malloc_explicitly_typed" && name != "GC_realloc")
+        {
+            return;
+        }
+
+        ConversionPatternRewriter rewriter(callOp.getContext());
+        rewriter.setInsertionPoint(callOp);
+
+        // type converter gives index type of the module to global strings
+        LowerToLLVMOptions options(callOp.getContext(), mlir::DataLayout(callOp->getParentOfType<mlir::ModuleOp>()));
+        LLVMTypeConverter typeConverter(callOp.getContext(), options);
+
+        TypeHelper th(callOp.getContext());
+        LLVMCodeHelper ch(callOp, rewriter, &typeConverter, tsContext.compileOptions);
+
+        auto i8PtrTy = th.getI8PtrType();
+        SmallVector<mlir::Type> argTypes(callOp.getOperandTypes());
+        argTypes.push_back(i8PtrTy);
+
+        auto profiledName = (name + "_profiled").str();
+        ch.getOrInsertFunction(profiledName, th.getFunctionType(i8PtrTy, argTypes));
+
+        auto siteValue = getOrCreateAllocSite(callOp, ch);
+        callOp->insertOperands(callOp->getNumOperands(), ValueRange{siteValue});
+        callOp.setCalleeAttr(::mlir::FlatSymbolRefAttr::get(callOp->getContext(), profiledName));
+    }
+
+    // site is "<function> (<file>:<line>:<col>)", the string is shared by all allocations of the same site
+    mlir::Value getOrCreateAllocSite(LLVM::CallOp callOp, LLVMCodeHelper &ch)
+    {
+        auto loc = callOp->getLoc();
+
+        std::string site;
+        llvm::raw_string_ostream os(site);
+        if (auto funcOp = callOp->getParentOfType<LLVM::LLVMFuncOp>())
+        {
+            os << funcOp.getName();
+        }
+
+        mlir::FileLineColLoc fileLineColLoc;
+        loc->walk([&](mlir::Location location) {
+            if (auto fileLoc = location.dyn_cast<mlir::FileLineColLoc>())
+            {
+                fileLineColLoc = fileLoc;
+                return WalkResult::interrupt();
+            }
+
+            return WalkResult::advance();
+        });
+
+        if (fileLineColLoc)
+        {
+            os << " (" << llvm::sys::path::filename(fileLineColLoc.getFilename()) << ":" << fileLineColLoc.getLine() << ":"
+               << fileLineColLoc.getColumn() << ")";
+        }
+
+        os.flush();
+
+        return ch.getOrCreateGlobalString("alloc_site_" + llvm::utohexstr(llvm::hash_value(site)), site);
+    }
+
     void injectAtomicDeclaration(LLVM::CallOp memSetCallOp)
     {
         ConversionPatternRewriter rewriter(memSetCallOp.getContext());
@@ -187,7 +262,7 @@ class GCPass : public mlir::PassWrapper<GCPass, ModulePass>
             }
 
             auto name = probMemAllocCall.getCallee().value();
-            if (name == "GC_malloc")
+            if (name == "GC_malloc" || name == "GC_malloc_profiled")
             {
                 ConversionPatternRewriter rewriter(memSetCallOp.getContext());
                 rewriter.replaceOp(memSetCallOp, ValueRange{probMemAllocCall.getResult()});
@@ -0,0 +1,471 @@
+#define DEBUG_TYPE "pass"
+
+#include "mlir/Pass/Pass.h"
+
+#include "TypeScript/TypeScriptDialect.h"
+#include "TypeScript/TypeScriptOps.h"
+#include "TypeScript/TypeScriptFunctionPass.h"
+#include "TypeScript/Passes.h"
+
+#include "TypeScript/Config.h"
+
+#include "scanner_enums.h"
+
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <cmath>
+#include <optional>
+
+namespace mlir_ts = mlir::typescript;
+
+// Retypes local `number` variables which can hold only integer values into i64.
+//
+// Variable is selected when:
+// - it is not captured and its reference is used only by ts.Load and as destination of ts.Store
+// - initializer and every stored value is one of:
+//     integer constant in i32 range,
+//     cast of signed integer (up to 32 bits) to number (i32 values, `length`),
+//     value of other selected variable,
+//     value of selected variable +/- 1 (including ++ and --)
+//
+// Every store can change the magnitude of the value at most by 1, so the value can leave the range where
+// floating point arithmetic is exact (2^53) only after 2^53 - 2^31 executed stores, which is not reachable
+// at runtime. In this range i64 arithmetic gives exactly the same results as f64.
+//
+// After retyping, comparisons of integer values (loop conditions as `i < a.length`) and casts to integer
+// (array indices, bitwise operands) are rewritten to use integer values directly, so the loop gets
+// integer induction variable.
+
+namespace
+{
+
+class IntegerRangePass : public mlir::PassWrapper<IntegerRangePass, TypeScriptFunctionPass>
+{
+  public:
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(IntegerRangePass)
+
+    void runOnFunction() override
+    {
+        auto f = getFunction();
+        castsOfRetyped.clear();
+
+        llvm::SetVector<mlir_ts::VariableOp> candidates;
+        f.walk([&](mlir_ts::VariableOp variableOp) {
+            if (isCandidate(variableOp))
+            {
+                candidates.insert(variableOp);
+            }
+        });
+
+        // remove variables with stores which are not proven to be integers, until nothing changes
+        auto changed = true;
+        while (changed && !candidates.empty())
+        {
+            changed = false;
+            for (auto variableOp : candidates.takeVector())
+            {
+                if (hasOnlyIntegerStores(variableOp, candidates))
+                {
+                    candidates.insert(variableOp);
+                }
+                else
+                {
+                    changed = true;
+                }
+            }
+        }
+
+        if (candidates.empty())
+        {
+            return;
+        }
+
+        mlir::OpBuilder builder(f.getContext());
+        auto intType = builder.getI64Type();
+
+        for (auto variableOp : candidates)
+        {
+            retypeLoads(builder, variableOp, intType);
+        }
+
+        for (auto variableOp : candidates)
+        {
+            retypeStores(builder, variableOp, intType);
+        }
+
+        f.walk([&](mlir::Operation *op) {
+            if (auto logicalBinaryOp = dyn_cast<mlir_ts::LogicalBinaryOp>(op))
+            {
+                rewriteCompare(builder, logicalBinaryOp, intType);
+            }
+            else if (auto castOp = dyn_cast<mlir_ts::CastOp>(op))
+            {
+                rewriteCastToInteger(castOp);
+            }
+        });
+
+        LLVM_DEBUG(llvm::dbgs() << "\n!! AFTER INTEGER RANGE FUNC DUMP: \n" << *getFunction() << "\n";);
+    }
+
+    bool isCandidate(mlir_ts::VariableOp variableOp)
+    {
+        auto refType = variableOp.getType().dyn_cast<mlir_ts::RefType>();
+        if (!refType || !refType.getElementType().isa<mlir_ts::NumberType>())
+        {
+            return false;
+        }
+
+        if (variableOp.getCaptured().value_or(false) || !variableOp.getInitializer())
+        {
+            return false;
+        }
+
+        for (auto &use : variableOp->getUses())
+        {
+            auto *user = use.getOwner();
+            if (auto loadOp = dyn_cast<mlir_ts::LoadOp>(user))
+            {
+                continue;
+            }
+
+            if (auto storeOp = dyn_cast<mlir_ts::StoreOp>(user))
+            {
+                if (storeOp.getReference() == variableOp.getResult() && storeOp.getValue() != variableOp.getResult())
+                {
+                    continue;
+                }
+            }
+
+            return false;
+        }
+
+        return true;
+    }
+
+    bool hasOnlyIntegerStores(mlir_ts::VariableOp variableOp, llvm::SetVector<mlir_ts::VariableOp> &candidates)
+    {
+        if (!isIntegerStep(variableOp.getInitializer(), candidates))
+        {
+            return false;
+        }
+
+        for (auto *user : variableOp->getUsers())
+        {
+            if (auto storeOp = dyn_cast<mlir_ts::StoreOp>(user))
+            {
+                if (!isIntegerStep(storeOp.getValue(), candidates))
+                {
+                    return false;
+                }
+            }
+
+            // ++ and -- are stores of value +/- 1
+        }
+
+        return true;
+    }
+
+    // value is not far than 1 from integer value
+    bool isIntegerStep(mlir::Value value, llvm::SetVector<mlir_ts::VariableOp> &candidates)
+    {
+        if (isInteger(value, candidates))
+        {
+            return true;
+        }
+
+        if (auto arithmeticBinaryOp = value.getDefiningOp<mlir_ts::ArithmeticBinaryOp>())
+        {
+            auto opCode = (SyntaxKind)arithmeticBinaryOp.getOpCode();
+            if (opCode != SyntaxKind::PlusToken && opCode != SyntaxKind::MinusToken)
+            {
+                return false;
+            }
+
+            auto left = arithmeticBinaryOp.getOperand1();
+            auto right = arithmeticBinaryOp.getOperand2();
+            if (!left.getType().isa<mlir_ts::NumberType>() || !right.getType().isa<mlir_ts::NumberType>())
+            {
+                return false;
+            }
+
+            auto isUnit = [](mlir::Value operand) {
+                auto constValue = getIntegerConstant(operand);
+                return constValue.has_value() && std::abs(constValue.value()) <= 1;
+            };
+
+            return (isInteger(left, candidates) && isUnit(right)) || (isUnit(left) && isInteger(right, candidates));
+        }
+
+        return false;
+    }
+
+    bool isInteger(mlir::Value value, llvm::SetVector<mlir_ts::VariableOp> &candidates)
+    {
+        if (auto constValue = getIntegerConstant(value))
+        {
+            return std::abs(constValue.value()) <= INT32_MAX;
+        }
+
+        if (auto castOp = value.getDefiningOp<mlir_ts::CastOp>())
+        {
+            return isSignedIntegerUpTo32(castOp.getIn().getType());
+        }
+
+        if (auto loadOp = value.getDefiningOp<mlir_ts::LoadOp>())
+        {
+            return isCandidateLoad(loadOp, candidates);
+        }
+
+        if (auto prefixUnaryOp = value.getDefiningOp<mlir_ts::PrefixUnaryOp>())
+        {
+            auto loadOp = prefixUnaryOp.getOperand1().getDefiningOp<mlir_ts::LoadOp>();
+            return loadOp && isCandidateLoad(loadOp, candidates);
+        }
+
+        if (auto postfixUnaryOp = value.getDefiningOp<mlir_ts::PostfixUnaryOp>())
+        {
+            auto loadOp = postfixUnaryOp.getOperand1().getDefiningOp<mlir_ts::LoadOp>();
+            return loadOp && isCandidateLoad(loadOp, candidates);
+        }
+
+        return false;
+    }
+
+    bool isCandidateLoad(mlir_ts::LoadOp loadOp, llvm::SetVector<mlir_ts::VariableOp> &candidates)
+    {
+        auto variableOp = loadOp.getReference().getDefiningOp<mlir_ts::VariableOp>();
+        return variableOp && candidates.contains(variableOp);
+    }
+
+    static bool isSignedIntegerUpTo32(mlir::Type type)
+    {
+        auto intType = type.dyn_cast<mlir::IntegerType>();
+        return intType && !intType.isUnsigned() && intType.getWidth() > 1 && intType.getWidth() <= 32;
+    }
+
+    // integer value of number constant (exactly representable one)
+    static std::optional<int64_t> getIntegerConstant(mlir::Value value)
+    {
+        if (auto castOp = value.getDefiningOp<mlir_ts::CastOp>())
+        {
+            if (!isSignedIntegerUpTo32(castOp.getIn().getType()))
+            {
+                return std::nullopt;
+            }
+
+            value = castOp.getIn();
+        }
+
+        auto constantOp = value.getDefiningOp<mlir_ts::ConstantOp>();
+        if (!constantOp)
+        {
+            return std::nullopt;
+        }
+
+        auto attr = constantOp.getValue();
+        if (auto intAttr = attr.dyn_cast_or_null<mlir::IntegerAttr>())
+        {
+            if (isSignedIntegerUpTo32(intAttr.getType()))
+            {
+                return intAttr.getValue().getSExtValue();
+            }
+
+            return std::nullopt;
+        }
+
+        if (auto floatAttr = attr.dyn_cast_or_null<mlir::FloatAttr>())
+        {
+            auto floatValue = floatAttr.getValueAsDouble();
+            // 2^53, floating point integers are exact up to it
+            if (std::trunc(floatValue) == floatValue && std::abs(floatValue) <= 9007199254740992.0 &&
+                !(floatValue == 0.0 && std::signbit(floatValue)))
+            {
+                return static_cast<int64_t>(floatValue);
+            }
+        }
+
+        return std::nullopt;
+    }
+
+    void retypeLoads(mlir::OpBuilder &builder, mlir_ts::VariableOp variableOp, mlir::Type intType)
+    {
+        auto numberType = variableOp.getType().cast<mlir_ts::RefType>().getElementType();
+        variableOp.getResult().setType(mlir_ts::RefType::get(intType));
+
+        for (auto *user : llvm::to_vector<4>(variableOp->getUsers()))
+        {
+            auto loadOp = dyn_cast<mlir_ts::LoadOp>(user);
+            if (!loadOp)
+            {
+                continue;
+            }
+
+            auto loaded = loadOp.getResult();
+            loaded.setType(intType);
+
+            // ++ and -- store result into loaded reference, they must keep using ts.Load directly
+            for (auto *loadUser : llvm::to_vector<4>(loaded.getUsers()))
+            {
+                if (isa<mlir_ts::PrefixUnaryOp>(loadUser) || isa<mlir_ts::PostfixUnaryOp>(loadUser))
+                {
+                    auto result = loadUser->getResult(0);
+                    result.setType(intType);
+                    castBack(builder, result, numberType);
+                }
+            }
+
+            castBack(builder, loaded, numberType);
+        }
+    }
+
+    void castBack(mlir::OpBuilder &builder, mlir::Value value, mlir::Type numberType)
+    {
+        builder.setInsertionPointAfterValue(value);
+        auto castOp = builder.create<mlir_ts::CastOp>(value.getLoc(), numberType, value);
+        castsOfRetyped.insert(castOp);
+        value.replaceUsesWithIf(castOp, [&](mlir::OpOperand &operand) {
+            auto *owner = operand.getOwner();
+            return owner != castOp && !isa<mlir_ts::PrefixUnaryOp>(owner) && !isa<mlir_ts::PostfixUnaryOp>(owner);
+        });
+    }
+
+    void retypeStores(mlir::OpBuilder &builder, mlir_ts::VariableOp variableOp, mlir::Type intType)
+    {
+        builder.setInsertionPoint(variableOp);
+        variableOp.getInitializerMutable().assign(toInteger(builder, variableOp.getInitializer(), intType));
+
+        for (auto *user : llvm::to_vector<4>(variableOp->getUsers()))
+        {
+            if (auto storeOp = dyn_cast<mlir_ts::StoreOp>(user))
+            {
+                builder.setInsertionPoint(storeOp);
+                storeOp.getValueMutable().assign(toInteger(builder, storeOp.getValue(), intType));
+            }
+        }
+    }
+
+    // builds integer equivalent of number value proven to be integer
+    mlir::Value toInteger(mlir::OpBuilder &builder, mlir::Value value, mlir::Type intType)
+    {
+        auto location = value.getLoc();
+        if (auto castOp = value.getDefiningOp<mlir_ts::CastOp>())
+        {
+            if (isCastOfRetyped(castOp))
+            {
+                return castOp.getIn();
+            }
+        }
+
+        if (auto constValue = getIntegerConstant(value))
+        {
+            return builder.create<mlir_ts::ConstantOp>(location, intType, builder.getI64IntegerAttr(constValue.value()));
+        }
+
+        if (auto arithmeticBinaryOp = value.getDefiningOp<mlir_ts::ArithmeticBinaryOp>())
+        {
+            auto left = toInteger(builder, arithmeticBinaryOp.getOperand1(), intType);
+            auto right = toInteger(builder, arithmeticBinaryOp.getOperand2(), intType);
+            return builder.create<mlir_ts::ArithmeticBinaryOp>(location, intType, arithmeticBinaryOp.getOpCodeAttr(), left, right);
+        }
+
+        // i32 -> number -> i64 is folded into sign extension by LLVM, cast i32 -> i64 would be zero extension
+        return builder.create<mlir_ts::CastOp>(location, intType, value);
+    }
+
+    // number value which is cast of integer (retyped variable or i32 value) or integer constant
+    bool isIntegerNumber(mlir::Value value)
+    {
+        if (!value.getType().isa<mlir_ts::NumberType>())
+        {
+            return false;
+        }
+
+        if (getIntegerConstant(value))
+        {
+            return true;
+        }
+
+        if (auto castOp = value.getDefiningOp<mlir_ts::CastOp>())
+        {
+            return isCastOfRetyped(castOp) || isSignedIntegerUpTo32(castOp.getIn().getType());
+        }
+
+        return false;
+    }
+
+    void rewriteCompare(mlir::OpBuilder &builder, mlir_ts::LogicalBinaryOp logicalBinaryOp, mlir::Type intType)
+    {
+        switch ((SyntaxKind)logicalBinaryOp.getOpCode())
+        {
+        case SyntaxKind::EqualsEqualsToken:
+        case SyntaxKind::EqualsEqualsEqualsToken:
+        case SyntaxKind::ExclamationEqualsToken:
+        case SyntaxKind::ExclamationEqualsEqualsToken:
+        case SyntaxKind::GreaterThanToken:
+        case SyntaxKind::GreaterThanEqualsToken:
+        case SyntaxKind::LessThanToken:
+        case SyntaxKind::LessThanEqualsToken:
+            break;
+        default:
+            return;
+        }
+
+        auto left = logicalBinaryOp.getOperand1();
+        auto right = logicalBinaryOp.getOperand2();
+        if (!isIntegerNumber(left) || !isIntegerNumber(right))
+        {
+            return;
+        }
+
+        // at least one side should be retyped variable, otherwise there is nothing to gain
+        auto isRetyped = [&](mlir::Value value) {
+            auto castOp = value.getDefiningOp<mlir_ts::CastOp>();
+            return castOp && isCastOfRetyped(castOp);
+        };
+
+        if (!isRetyped(left) && !isRetyped(right))
+        {
+            return;
+        }
+
+        builder.setInsertionPoint(logicalBinaryOp);
+        logicalBinaryOp.getOperand1Mutable().assign(toInteger(builder, left, intType));
+        logicalBinaryOp.getOperand2Mutable().assign(toInteger(builder, right, intType));
+    }
+
+    // number -> i32 of retyped variable (array index, operand of bitwise op)
+    void rewriteCastToInteger(mlir_ts::CastOp castOp)
+    {
+        auto resType = castOp.getType().dyn_cast<mlir::IntegerType>();
+        if (!resType || resType.getWidth() <= 1 || resType.getWidth() > 64)
+        {
+            return;
+        }
+
+        auto inCastOp = castOp.getIn().getDefiningOp<mlir_ts::CastOp>();
+        if (!inCastOp || !isCastOfRetyped(inCastOp))
+        {
+            return;
+        }
+
+        castOp.getInMutable().assign(inCastOp.getIn());
+    }
+
+    bool isCastOfRetyped(mlir_ts::CastOp castOp)
+    {
+        return castsOfRetyped.contains(castOp.getOperation());
+    }
+
+    // casts to number of loaded values of retyped variables
+    llvm::SmallPtrSet<mlir::Operation *, 16> castsOfRetyped;
+};
+} // end anonymous namespace
+
+/// Create pass.
+std::unique_ptr<mlir::Pass> mlir_ts::createIntegerRangePass()
+{
+    return std::make_unique<IntegerRangePass>();
+}
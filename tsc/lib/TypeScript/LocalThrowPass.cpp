@@ -0,0 +1,256 @@
+#define DEBUG_TYPE "pass"
+
+#include "mlir/Pass/Pass.h"
+
+#include "TypeScript/Defines.h"
+#include "TypeScript/TypeScriptDialect.h"
+#include "TypeScript/TypeScriptOps.h"
+#include "TypeScript/TypeScriptFunctionPass.h"
+#include "TypeScript/Passes.h"
+#include "TypeScript/MLIRLogic/MLIRTypeHelper.h"
+
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/CallInterfaces.h"
+
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <string>
+
+namespace mlir_ts = mlir::typescript;
+
+// Replaces "throw" which is caught by "catch" of the same function with jump to the catch code:
+//
+//   label .done {
+//     label .local {
+//       try { ... catchVar = value; break .local; ... } catch { <catch code> }
+//       break .done
+//     }
+//     <catch code>
+//   }
+//
+// Local throw does not allocate exception, does not unwind stack and does not match RTTI. If all exceptions
+// of "try" body are local, "try" is removed completely and its catch code is not duplicated.
+//
+// Only "try" without "finally" and cleanup code is processed, "throw" is local when the caught type is
+// exactly the type of thrown value (the same rule as RTTI match) and there is no other "try" in between.
+
+namespace
+{
+
+class LocalThrowPass : public mlir::PassWrapper<LocalThrowPass, TypeScriptFunctionPass>
+{
+  public:
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(LocalThrowPass)
+
+    void runOnFunction() override
+    {
+        auto f = getFunction();
+        labelIndex = 0;
+
+        // inner "try" first, so outer one sees already rewritten throws
+        mlir::SmallVector<mlir_ts::TryOp> tryOps;
+        f.walk([&](mlir_ts::TryOp tryOp) { tryOps.push_back(tryOp); });
+
+        for (auto tryOp : tryOps)
+        {
+            rewriteLocalThrows(tryOp);
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "\n!! AFTER LOCAL THROW FUNC DUMP: \n" << *getFunction() << "\n";);
+    }
+
+  private:
+    void rewriteLocalThrows(mlir_ts::TryOp tryOp)
+    {
+        if (hasOps(tryOp.getCleanup()) || hasOps(tryOp.getFinally()) || !hasOps(tryOp.getCatches()))
+        {
+            return;
+        }
+
+        if (!tryOp.getBody().hasOneBlock() || !tryOp.getCatches().hasOneBlock())
+        {
+            return;
+        }
+
+        // catch code and body are moved into labels, they must not have "break" and "continue" of outer loops
+        if (hasOuterBreakOrContinue(tryOp.getBody()) || hasOuterBreakOrContinue(tryOp.getCatches()))
+        {
+            return;
+        }
+
+        auto &catches = tryOp.getCatches().front();
+        auto catchOp = dyn_cast<mlir_ts::CatchOp>(&catches.front());
+        mlir::Type catchType;
+        if (catchOp)
+        {
+            catchType = catchOp.getCatchArg().getType().cast<mlir_ts::RefType>().getElementType();
+        }
+
+        mlir::SmallVector<mlir_ts::ThrowOp> localThrows;
+        auto allLocal = true;
+        tryOp.getBody().walk([&](mlir::Operation *op) {
+            if (auto throwOp = dyn_cast<mlir_ts::ThrowOp>(op))
+            {
+                if (isLocalThrow(throwOp, tryOp, catchType))
+                {
+                    localThrows.push_back(throwOp);
+                }
+                else
+                {
+                    allLocal = false;
+                }
+            }
+            else if (isa<mlir_ts::TryOp>(op) || isa<mlir::CallOpInterface>(op) ||
+                     !isa_and_nonnull<mlir_ts::TypeScriptDialect>(op->getDialect()))
+            {
+                // can throw or catch exception
+                allLocal = false;
+            }
+        });
+
+        if (localThrows.empty())
+        {
+            return;
+        }
+
+        auto location = tryOp.getLoc();
+        auto index = labelIndex++;
+        auto doneLabelName = (llvm::Twine(".catch.done.") + llvm::Twine(index)).str();
+        auto localLabelName = (llvm::Twine(".catch.local.") + llvm::Twine(index)).str();
+
+        mlir::OpBuilder builder(tryOp);
+        auto doneLabelOp = builder.create<mlir_ts::LabelOp>(location, builder.getStringAttr(doneLabelName));
+        doneLabelOp.addMergeBlock();
+
+        builder.setInsertionPoint(doneLabelOp.getMergeBlock()->getTerminator());
+        auto localLabelOp = builder.create<mlir_ts::LabelOp>(location, builder.getStringAttr(localLabelName));
+        localLabelOp.addMergeBlock();
+        auto catchCodeInsertionPoint = doneLabelOp.getMergeBlock()->getTerminator();
+
+        for (auto throwOp : localThrows)
+        {
+            builder.setInsertionPoint(throwOp);
+            if (catchOp)
+            {
+                mlir::Value exception = throwOp.getException();
+                if (exception.getType() != catchType)
+                {
+                    exception = builder.create<mlir_ts::CastOp>(throwOp.getLoc(), catchType, exception);
+                }
+
+                builder.create<mlir_ts::StoreOp>(throwOp.getLoc(), exception, catchOp.getCatchArg());
+            }
+
+            builder.create<mlir_ts::BreakOp>(throwOp.getLoc(), builder.getStringAttr(localLabelName));
+            throwOp.erase();
+        }
+
+        auto *localBlock = localLabelOp.getMergeBlock();
+        if (allLocal)
+        {
+            // try is not needed anymore
+            auto &body = tryOp.getBody().front();
+            localBlock->getOperations().splice(localBlock->getTerminator()->getIterator(), body.getOperations(),
+                                               body.begin(), body.getTerminator()->getIterator());
+
+            if (catchOp)
+            {
+                catchOp.erase();
+            }
+
+            catchCodeInsertionPoint->getBlock()->getOperations().splice(
+                catchCodeInsertionPoint->getIterator(), catches.getOperations(), catches.begin(),
+                catches.getTerminator()->getIterator());
+        }
+        else
+        {
+            tryOp->moveBefore(localBlock->getTerminator());
+
+            builder.setInsertionPoint(catchCodeInsertionPoint);
+            mlir::IRMapping mapping;
+            for (auto &op : catches.without_terminator())
+            {
+                if (&op != catchOp.getOperation())
+                {
+                    builder.clone(op, mapping);
+                }
+            }
+        }
+
+        builder.setInsertionPoint(localBlock->getTerminator());
+        builder.create<mlir_ts::BreakOp>(location, builder.getStringAttr(doneLabelName));
+
+        if (allLocal)
+        {
+            tryOp.erase();
+        }
+    }
+
+    bool isLocalThrow(mlir_ts::ThrowOp throwOp, mlir_ts::TryOp tryOp, mlir::Type catchType)
+    {
+        for (auto *parent = throwOp->getParentOp(); parent != tryOp; parent = parent->getParentOp())
+        {
+            // ops which are lowered into branches of the same region
+            if (!isa<mlir_ts::IfOp, mlir_ts::WhileOp, mlir_ts::DoWhileOp, mlir_ts::ForOp, mlir_ts::LabelOp,
+                     mlir_ts::SwitchOp>(parent))
+            {
+                return false;
+            }
+        }
+
+        if (!catchType)
+        {
+            // catch all
+            return true;
+        }
+
+        mlir_ts::MLIRTypeHelper mth(throwOp.getContext());
+        return mth.stripLiteralType(throwOp.getException().getType()) == catchType;
+    }
+
+    bool hasOuterBreakOrContinue(mlir::Region &region)
+    {
+        auto result = region.walk([&](mlir::Operation *op) {
+            auto isBreak = isa<mlir_ts::BreakOp>(op);
+            if (!isBreak && !isa<mlir_ts::ContinueOp>(op))
+            {
+                return mlir::WalkResult::advance();
+            }
+
+            auto labelAttr = op->getAttrOfType<mlir::StringAttr>(LABEL_ATTR_NAME);
+            if (labelAttr && !labelAttr.getValue().empty())
+            {
+                // labeled jumps do not match new labels
+                return mlir::WalkResult::advance();
+            }
+
+            for (auto *parent = op->getParentOp(); parent != region.getParentOp(); parent = parent->getParentOp())
+            {
+                if (isa<mlir_ts::WhileOp, mlir_ts::DoWhileOp, mlir_ts::ForOp>(parent) ||
+                    (isBreak && isa<mlir_ts::SwitchOp>(parent)))
+                {
+                    return mlir::WalkResult::advance();
+                }
+            }
+
+            return mlir::WalkResult::interrupt();
+        });
+
+        return result.wasInterrupted();
+    }
+
+    static bool hasOps(mlir::Region &region)
+    {
+        return llvm::any_of(region, [](auto &block) { return &block.front() != block.getTerminator(); });
+    }
+
+    int labelIndex;
+};
+} // end anonymous namespace
+
+/// Create pass.
+std::unique_ptr<mlir::Pass> mlir_ts::createLocalThrowPass()
+{
+    return std::make_unique<LocalThrowPass>();
+}
@@ -17,6 +17,7 @@
 #include "mlir/Dialect/ControlFlow/IR/ControlFlow.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/Async/IR/Async.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/DialectConversion.h"
@@ -1537,23 +1538,18 @@ class SwitchStateOpLowering : public TsPattern<mlir_ts::SwitchStateOp>
 
         SmallVector<mlir::Block *> caseDestinations;
 
-        SmallPtrSet<Operation *, 16> stateLabels;
+        // keep order of labels, index of label in switch is number of state
+        SmallVector<mlir_ts::StateLabelOp, 16> stateLabels;
 
         // select all states
-        auto visitorAllStateLabels = [&](Operation *op) {
-            if (auto stateLabelOp = dyn_cast_or_null<mlir_ts::StateLabelOp>(op))
-            {
-                stateLabels.insert(op);
-            }
-        };
-
-        switchStateOp->getParentOp()->walk(visitorAllStateLabels);
+        switchStateOp->getParentOp()->walk([&](mlir_ts::StateLabelOp stateLabelOp) {
+            stateLabels.push_back(stateLabelOp);
+        });
 
         {
             mlir::OpBuilder::InsertionGuard insertGuard(rewriter);
-            for (auto op : stateLabels)
+            for (auto stateLabelOp : stateLabels)
             {
-                auto stateLabelOp = dyn_cast_or_null<mlir_ts::StateLabelOp>(op);
                 rewriter.setInsertionPoint(stateLabelOp);
 
                 auto *continuationBlock = clh.BeginBlock(loc);
@@ -1857,6 +1853,8 @@ void AddTsAffineLegalOps(ConversionTarget &target)
     target.addLegalDialect<arith::ArithDialect>();
     target.addLegalDialect<cf::ControlFlowDialect>();
     target.addLegalDialect<func::FuncDialect>();
+    // counted loops, see StructuredLoopsPass
+    target.addLegalDialect<scf::SCFDialect>();
 
     // We also define the TypeScript dialect as Illegal so that the conversion will fail
     // if any of these operations are *not* converted. Given that we actually want
@@ -1875,7 +1873,8 @@ void AddTsAffineLegalOps(ConversionTarget &target)
         mlir_ts::ExtractPropertyOp, mlir_ts::LogicalBinaryOp, mlir_ts::UndefOp, mlir_ts::VariableOp, mlir_ts::AllocaOp,
         mlir_ts::InvokeOp, /*mlir_ts::ResultOp,*/ mlir_ts::VirtualSymbolRefOp,
         mlir_ts::ThisVirtualSymbolRefOp, mlir_ts::InterfaceSymbolRefOp, mlir_ts::ExtractInterfaceThisOp,
-        mlir_ts::ExtractInterfaceVTableOp, mlir_ts::PushOp, mlir_ts::PopOp, mlir_ts::NewInterfaceOp,
+        mlir_ts::ExtractInterfaceVTableOp, mlir_ts::PushOp, mlir_ts::PopOp, mlir_ts::SetLengthOfOp, mlir_ts::ArraySortOp,
+        mlir_ts::ArrayIndexOfOp, mlir_ts::ArraySliceOp, mlir_ts::ArrayConcatOp, mlir_ts::ArrayJoinOp, mlir_ts::NewInterfaceOp,
         mlir_ts::VTableOffsetRefOp, mlir_ts::GetThisOp, mlir_ts::GetMethodOp, mlir_ts::DebuggerOp,
         mlir_ts::LandingPadOp, mlir_ts::CompareCatchTypeOp, mlir_ts::BeginCatchOp, mlir_ts::SaveCatchVarOp,
         mlir_ts::EndCatchOp, mlir_ts::BeginCleanupOp, mlir_ts::EndCleanupOp, mlir_ts::ThrowUnwindOp,
@@ -17,9 +17,11 @@
 #include "mlir/Conversion/FuncToLLVM/ConvertFuncToLLVM.h"
 #include "mlir/Conversion/FuncToLLVM/ConvertFuncToLLVMPass.h"
 #include "mlir/Conversion/MathToLLVM/MathToLLVM.h"
+#include "mlir/Conversion/SCFToControlFlow/SCFToControlFlow.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/LLVMIR/LLVMDialect.h"
 #include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/IR/Matchers.h"
 
 #ifdef ENABLE_ASYNC
 #include "mlir/Conversion/AsyncToLLVM/AsyncToLLVM.h"
@@ -76,6 +78,49 @@ template <typename OpTy> class TsLlvmPattern : public OpConversionPattern<OpTy>
     TsLlvmContext *tsLlvmContext;
 };
 
+// returns value of string literal: ts.constant before conversion or address of constant llvm global after it
+static std::optional<StringRef> getConstantString(mlir::Value value)
+{
+    if (auto constantOp = value.getDefiningOp<mlir_ts::ConstantOp>())
+    {
+        if (auto strAttr = constantOp.getValue().dyn_cast<mlir::StringAttr>())
+        {
+            return strAttr.getValue().take_until([](char c) { return c == '\0'; });
+        }
+
+        return std::nullopt;
+    }
+
+    if (auto gepOp = value.getDefiningOp<LLVM::GEPOp>())
+    {
+        if (auto addressOfOp = gepOp.getBase().getDefiningOp<LLVM::AddressOfOp>())
+        {
+            // only pointer to the first char
+            for (auto index : gepOp.getIndices())
+            {
+                auto isZero = index.is<IntegerAttr>() ? index.get<IntegerAttr>().getValue().isZero()
+                                                      : matchPattern(index.get<mlir::Value>(), m_Zero());
+                if (!isZero)
+                {
+                    return std::nullopt;
+                }
+            }
+
+            auto globalOp = SymbolTable::lookupNearestSymbolFrom<LLVM::GlobalOp>(addressOfOp, addressOfOp.getGlobalNameAttr());
+            if (globalOp && globalOp.getConstant())
+            {
+                if (auto strAttr = globalOp.getValueOrNull().dyn_cast_or_null<mlir::StringAttr>())
+                {
+                    // stored with terminating zero, runtime string ends at the first one
+                    return strAttr.getValue().take_until([](char c) { return c == '\0'; });
+                }
+            }
+        }
+    }
+
+    return std::nullopt;
+}
+
 #ifdef PRINTF_SUPPORT
 class PrintOpLowering : public TsLlvmPattern<mlir_ts::PrintOp>
 {
@@ -245,24 +290,41 @@ class PrintOpLowering : public TsLlvmPattern<mlir_ts::PrintOp>
 
         auto strType = mlir_ts::StringType::get(rewriter.getContext());
 
+        // literals and separators are joined at compile time
         SmallVector<mlir::Value> values;
-        mlir::Value spaceString;
-        for (auto item : transformed.getInputs())
+        std::string literal;
+        auto hasLiteral = false;
+        auto flushLiteral = [&]() {
+            if (hasLiteral)
+            {
+                values.push_back(ch.getOrCreateGlobalString(literal));
+                literal.clear();
+                hasLiteral = false;
+            }
+        };
+
+        for (auto [item, origItem] : llvm::zip(transformed.getInputs(), op.getInputs()))
         {
             assert(item.getType() == i8PtrType);
-            if (values.size() > 0)
+            if (values.size() > 0 || hasLiteral)
             {
-                if (!spaceString)
-                {
-                    spaceString = rewriter.create<mlir_ts::ConstantOp>(loc, strType, rewriter.getStringAttr(" "));
-                }
+                literal += " ";
+                hasLiteral = true;
+            }
 
-                values.push_back(spaceString);
+            if (auto constString = getConstantString(origItem))
+            {
+                literal += *constString;
+                hasLiteral = true;
+                continue;
             }
 
+            flushLiteral();
             values.push_back(item);
         }
 
+        flushLiteral();
+
         if (values.size() > 1)
         {
             auto stack = rewriter.create<LLVM::StackSaveOp>(loc, i8PtrType);
@@ -541,15 +603,34 @@ class StringConcatOpLowering : public TsLlvmPattern<mlir_ts::StringConcatOp>
         auto llvmIndexType = tch.convertType(th.getIndexType());
 
         auto strlenFuncOp = ch.getOrInsertFunction("strlen", th.getFunctionType(llvmIndexType, {i8PtrTy}));
-        auto strcpyFuncOp = ch.getOrInsertFunction("strcpy", th.getFunctionType(i8PtrTy, {i8PtrTy, i8PtrTy}));
-        auto strcatFuncOp = ch.getOrInsertFunction("strcat", th.getFunctionType(i8PtrTy, {i8PtrTy, i8PtrTy}));
+        auto copyMemFuncOp = ch.getOrInsertFunction(
+            llvmIndexType.getIntOrFloatBitWidth() == 32 
+                ? "llvm.memcpy.p0.p0.i32" 
+                : "llvm.memcpy.p0.p0.i64", 
+            th.getFunctionType(th.getVoidType(), {i8PtrTy, i8PtrTy, llvmIndexType, th.getLLVMBoolType()}));
 
-        mlir::Value size = clh.createIndexConstantOf(llvmIndexType, 1);
-        // calc size
-        for (auto oper : transformed.getOps())
+        // calc size, lengths of literals are known at compile time
+        SmallVector<mlir::Value> sizes;
+        SmallVector<mlir::Value> runtimeSizes;
+        int64_t constSize = 1;
+        for (auto [oper, origOper] : llvm::zip(transformed.getOps(), op.getOps()))
         {
+            if (auto constString = getConstantString(origOper))
+            {
+                constSize += constString->size();
+                sizes.push_back(clh.createIndexConstantOf(llvmIndexType, constString->size()));
+                continue;
+            }
+
             auto size1 = rewriter.create<LLVM::CallOp>(loc, strlenFuncOp, oper);
-            size = rewriter.create<LLVM::AddOp>(loc, llvmIndexType, ValueRange{size, size1.getResult()});
+            sizes.push_back(size1.getResult());
+            runtimeSizes.push_back(size1.getResult());
+        }
+
+        mlir::Value size = clh.createIndexConstantOf(llvmIndexType, constSize);
+        for (auto size1 : runtimeSizes)
+        {
+            size = rewriter.create<LLVM::AddOp>(loc, llvmIndexType, ValueRange{size, size1});
         }
 
         auto allocInStack = op.getAllocInStack().has_value() && op.getAllocInStack().value();
@@ -557,25 +638,19 @@ class StringConcatOpLowering : public TsLlvmPattern<mlir_ts::StringConcatOp>
         mlir::Value newStringValue = allocInStack ? rewriter.create<LLVM::AllocaOp>(loc, i8PtrTy, size, true)
                                                   : ch.MemoryAllocBitcast(i8PtrTy, size);
 
-        // copy
-        auto concat = false;
-        auto result = newStringValue;
-        for (auto oper : transformed.getOps())
+        // copy, each part is copied at known offset, so the result is not scanned again as strcat does
+        auto immarg = clh.createI1ConstantOf(false);
+        mlir::Value offset = clh.createIndexConstantOf(llvmIndexType, 0);
+        for (auto [oper, size1] : llvm::zip(transformed.getOps(), sizes))
         {
-            if (concat)
-            {
-                auto callResult = rewriter.create<LLVM::CallOp>(loc, strcatFuncOp, ValueRange{result, oper});
-                result = callResult.getResult();
-            }
-            else
-            {
-                auto callResult = rewriter.create<LLVM::CallOp>(loc, strcpyFuncOp, ValueRange{result, oper});
-                result = callResult.getResult();
-            }
-
-            concat = true;
+            auto dest = rewriter.create<LLVM::GEPOp>(loc, i8PtrTy, newStringValue, ValueRange{offset});
+            rewriter.create<LLVM::CallOp>(loc, copyMemFuncOp, ValueRange{dest, oper, size1, immarg});
+            offset = rewriter.create<LLVM::AddOp>(loc, llvmIndexType, ValueRange{offset, size1});
         }
 
+        auto end = rewriter.create<LLVM::GEPOp>(loc, i8PtrTy, newStringValue, ValueRange{offset});
+        rewriter.create<LLVM::StoreOp>(loc, clh.createI8ConstantOf(0), end);
+
         rewriter.replaceOp(op, ValueRange{newStringValue});
 
         return success();
@@ -2369,6 +2444,459 @@ struct PopOpLowering : public TsLlvmPattern<mlir_ts::PopOp>
     }
 };
 
+struct SetLengthOfOpLowering : public TsLlvmPattern<mlir_ts::SetLengthOfOp>
+{
+    using TsLlvmPattern<mlir_ts::SetLengthOfOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::SetLengthOfOp setLengthOfOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        CodeLogicHelper clh(setLengthOfOp, rewriter);
+        TypeHelper th(rewriter);
+
+        auto loc = setLengthOfOp.getLoc();
+
+        auto ind0 = clh.createI32ConstantOf(0);
+        auto ind1 = clh.createI32ConstantOf(1);
+        auto countAsI32TypePtr = rewriter.create<LLVM::GEPOp>(loc, th.getPointerType(th.getI32Type()), transformed.getOp(),
+                                                              ValueRange{ind0, ind1});
+        rewriter.create<LLVM::StoreOp>(loc, transformed.getSize(), countAsI32TypePtr);
+
+        rewriter.eraseOp(setLengthOfOp);
+        return success();
+    }
+};
+
+static LLVM::LLVMFuncOp getOrInsertMemoryCopyFunction(LLVMCodeHelper &ch, TypeHelper &th, mlir::Type llvmIndexType)
+{
+    return ch.getOrInsertFunction(
+        llvmIndexType.getIntOrFloatBitWidth() == 32
+            ? "llvm.memcpy.p0.p0.i32"
+            : "llvm.memcpy.p0.p0.i64",
+        th.getFunctionType(th.getVoidType(), {th.getI8PtrType(), th.getI8PtrType(), llvmIndexType, th.getLLVMBoolType()}));
+}
+
+static mlir::Value getArrayData(mlir::Location loc, mlir::Value llvmArray, mlir::Type llvmElementType,
+                                ConversionPatternRewriter &rewriter)
+{
+    TypeHelper th(rewriter);
+    return rewriter.create<LLVM::ExtractValueOp>(loc, th.getPointerType(llvmElementType), llvmArray,
+                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_DATA_INDEX));
+}
+
+static mlir::Value getArrayLength(mlir::Location loc, mlir::Value llvmArray, ConversionPatternRewriter &rewriter)
+{
+    TypeHelper th(rewriter);
+    return rewriter.create<LLVM::ExtractValueOp>(loc, th.getI32Type(), llvmArray,
+                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_SIZE_INDEX));
+}
+
+struct ArraySortOpLowering : public TsLlvmPattern<mlir_ts::ArraySortOp>
+{
+    using TsLlvmPattern<mlir_ts::ArraySortOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::ArraySortOp sortOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        LLVMCodeHelper ch(sortOp, rewriter, getTypeConverter(), tsLlvmContext->compileOptions);
+        CodeLogicHelper clh(sortOp, rewriter);
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = sortOp.getLoc();
+
+        auto elementType = sortOp.getOp().getType().cast<mlir_ts::ArrayType>().getElementType();
+        auto llvmElementType = tch.convertType(elementType);
+        auto llvmIndexType = tch.convertType(th.getIndexType());
+        auto i8PtrTy = th.getI8PtrType();
+
+        auto data = getArrayData(loc, transformed.getOp(), llvmElementType, rewriter);
+        auto count = getArrayLength(loc, transformed.getOp(), rewriter);
+
+        if (auto comparefn = transformed.getComparefn())
+        {
+            auto adapterFuncOp = getOrInsertCompareAdapter(sortOp, llvmElementType, rewriter);
+            auto adapterFuncPtr = rewriter.create<LLVM::AddressOfOp>(
+                loc, th.getPointerType(adapterFuncOp.getFunctionType()), adapterFuncOp.getName());
+
+            // compare function is passed by reference
+            auto comparefnVar = rewriter.create<mlir_ts::VariableOp>(
+                loc, mlir_ts::RefType::get(sortOp.getComparefn().getType()), mlir::Value(), rewriter.getBoolAttr(false));
+            mlir::Value comparefnVarAsLLVMType =
+                rewriter.create<mlir_ts::DialectCastOp>(loc, tch.convertType(comparefnVar.getType()), comparefnVar);
+            rewriter.create<LLVM::StoreOp>(loc, comparefn, comparefnVarAsLLVMType);
+
+            auto sizeOfElementMLIR = rewriter.create<mlir_ts::SizeOfOp>(loc, th.getIndexType(), llvmElementType);
+            mlir::Value sizeOfElement = rewriter.create<mlir_ts::DialectCastOp>(loc, llvmIndexType, sizeOfElementMLIR);
+            if (llvmIndexType != th.getI32Type())
+            {
+                sizeOfElement = rewriter.create<LLVM::TruncOp>(loc, th.getI32Type(), sizeOfElement);
+            }
+
+            auto sortFuncOp = ch.getOrInsertFunction(
+                "__ts_array_sort_cmp",
+                th.getFunctionType(th.getVoidType(), {i8PtrTy, th.getI32Type(), th.getI32Type(),
+                                                      th.getPointerType(adapterFuncOp.getFunctionType()), i8PtrTy}));
+            rewriter.create<LLVM::CallOp>(
+                loc, sortFuncOp,
+                ValueRange{clh.castToI8Ptr(data), count, sizeOfElement, adapterFuncPtr, clh.castToI8Ptr(comparefnVarAsLLVMType)});
+
+            rewriter.eraseOp(sortOp);
+            return success();
+        }
+
+        if (sortOp.getNumeric())
+        {
+            if (!llvmElementType.isF64() && !llvmElementType.isInteger(32))
+            {
+                return rewriter.notifyMatchFailure(sortOp, "numeric sort of array of this type is not supported");
+            }
+
+            auto sortFuncOp = ch.getOrInsertFunction(
+                llvmElementType.isF64() ? "__ts_array_sort_f64" : "__ts_array_sort_i32",
+                th.getFunctionType(th.getVoidType(), {data.getType(), th.getI32Type(), th.getI32Type()}));
+            rewriter.create<LLVM::CallOp>(loc, sortFuncOp,
+                                          ValueRange{data, count, clh.createI32ConstantOf(sortOp.getDescending() ? 1 : 0)});
+
+            rewriter.eraseOp(sortOp);
+            return success();
+        }
+
+        // default order, values are compared as strings
+        StringRef sortFuncName;
+        if (elementType.isa<mlir_ts::StringType>())
+        {
+            sortFuncName = "__ts_array_sort_string";
+        }
+        else if (llvmElementType.isF64())
+        {
+            sortFuncName = "__ts_array_sort_number";
+        }
+        else
+        {
+            return rewriter.notifyMatchFailure(sortOp, "sort of array of this type requires compare function");
+        }
+
+        auto sortFuncOp = ch.getOrInsertFunction(
+            sortFuncName, th.getFunctionType(th.getVoidType(), {data.getType(), th.getI32Type()}));
+        rewriter.create<LLVM::CallOp>(loc, sortFuncOp, ValueRange{data, count});
+
+        rewriter.eraseOp(sortOp);
+        return success();
+    }
+
+    // double adapter(i8* comparefn, i8* left, i8* right), comparefn points to hybrid function {method, this},
+    // left and right point to elements
+    LLVM::LLVMFuncOp getOrInsertCompareAdapter(mlir_ts::ArraySortOp sortOp, mlir::Type llvmElementType,
+                                               ConversionPatternRewriter &rewriter) const
+    {
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = sortOp.getLoc();
+
+        auto comparefnType = sortOp.getComparefn().getType().cast<mlir_ts::HybridFunctionType>();
+        auto llvmComparefnType = tch.convertType(comparefnType);
+        auto llvmFuncPtrType = llvmComparefnType.cast<LLVM::LLVMStructType>().getBody().front();
+        auto llvmResultType = th.getF64Type();
+        auto i8PtrTy = th.getI8PtrType();
+
+        std::string signature;
+        llvm::raw_string_ostream signatureStream(signature);
+        signatureStream << llvmElementType << llvmComparefnType;
+        auto name = "__array_sort_cmp." + std::to_string(static_cast<size_t>(llvm::hash_value(signatureStream.str())));
+
+        auto parentModule = sortOp->getParentOfType<ModuleOp>();
+        if (auto funcOp = parentModule.lookupSymbol<LLVM::LLVMFuncOp>(name))
+        {
+            return funcOp;
+        }
+
+        OpBuilder::InsertionGuard insertGuard(rewriter);
+        rewriter.setInsertionPointToEnd(parentModule.getBody());
+
+        auto adapterFuncOp = rewriter.create<LLVM::LLVMFuncOp>(
+            loc, name, th.getFunctionType(llvmResultType, {i8PtrTy, i8PtrTy, i8PtrTy}), LLVM::Linkage::Internal);
+        auto *entryBlock = adapterFuncOp.addEntryBlock();
+        rewriter.setInsertionPointToEnd(entryBlock);
+
+        auto comparefnPtr = rewriter.create<LLVM::BitcastOp>(loc, th.getPointerType(llvmComparefnType), entryBlock->getArgument(0));
+        auto comparefn = rewriter.create<LLVM::LoadOp>(loc, llvmComparefnType, comparefnPtr);
+        auto funcPtr = rewriter.create<LLVM::ExtractValueOp>(loc, llvmFuncPtrType, comparefn, MLIRHelper::getStructIndex(rewriter, 0));
+        auto thisPtr = rewriter.create<LLVM::ExtractValueOp>(loc, i8PtrTy, comparefn, MLIRHelper::getStructIndex(rewriter, 1));
+
+        auto llvmElementPtrType = th.getPointerType(llvmElementType);
+        auto leftPtr = rewriter.create<LLVM::BitcastOp>(loc, llvmElementPtrType, entryBlock->getArgument(1));
+        auto left = rewriter.create<LLVM::LoadOp>(loc, llvmElementType, leftPtr);
+        auto rightPtr = rewriter.create<LLVM::BitcastOp>(loc, llvmElementPtrType, entryBlock->getArgument(2));
+        auto right = rewriter.create<LLVM::LoadOp>(loc, llvmElementType, rightPtr);
+
+        // as CallHybridInternalOp: method is called with "this" if it is not null
+        auto nullPtr = rewriter.create<LLVM::NullOp>(loc, i8PtrTy);
+        auto hasThis = rewriter.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::ne, thisPtr, nullPtr);
+
+        auto *withThisBlock = rewriter.createBlock(&adapterFuncOp.getBody());
+        auto methodType = th.getFunctionType(llvmResultType, {i8PtrTy, llvmElementType, llvmElementType});
+        auto methodPtr = rewriter.create<LLVM::BitcastOp>(loc, th.getPointerType(methodType), funcPtr);
+        auto methodResult = rewriter.create<LLVM::CallOp>(loc, TypeRange{llvmResultType}, ValueRange{methodPtr, thisPtr, left, right});
+        rewriter.create<LLVM::ReturnOp>(loc, methodResult.getResults());
+
+        auto *noThisBlock = rewriter.createBlock(&adapterFuncOp.getBody());
+        auto funcResult = rewriter.create<LLVM::CallOp>(loc, TypeRange{llvmResultType}, ValueRange{funcPtr, left, right});
+        rewriter.create<LLVM::ReturnOp>(loc, funcResult.getResults());
+
+        rewriter.setInsertionPointToEnd(entryBlock);
+        rewriter.create<LLVM::CondBrOp>(loc, hasThis, withThisBlock, noThisBlock);
+
+        return adapterFuncOp;
+    }
+};
+
+struct ArrayIndexOfOpLowering : public TsLlvmPattern<mlir_ts::ArrayIndexOfOp>
+{
+    using TsLlvmPattern<mlir_ts::ArrayIndexOfOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::ArrayIndexOfOp indexOfOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        LLVMCodeHelper ch(indexOfOp, rewriter, getTypeConverter(), tsLlvmContext->compileOptions);
+        CodeLogicHelper clh(indexOfOp, rewriter);
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = indexOfOp.getLoc();
+
+        auto elementType = indexOfOp.getOp().getType().cast<mlir_ts::ArrayType>().getElementType();
+        auto llvmElementType = tch.convertType(elementType);
+        auto i8PtrTy = th.getI8PtrType();
+
+        mlir::Value data = getArrayData(loc, transformed.getOp(), llvmElementType, rewriter);
+        auto count = getArrayLength(loc, transformed.getOp(), rewriter);
+        mlir::Value value = transformed.getValue();
+        auto fromIndex = transformed.getFromIndex();
+
+        if (llvmElementType.isF64())
+        {
+            auto indexOfFuncOp = ch.getOrInsertFunction(
+                "__ts_array_index_of_f64",
+                th.getFunctionType(th.getI32Type(), {data.getType(), th.getI32Type(), th.getF64Type(), th.getI32Type(), th.getI32Type()}));
+            auto sameValueZero = clh.createI32ConstantOf(indexOfOp.getSameValueZero() ? 1 : 0);
+            rewriter.replaceOpWithNewOp<LLVM::CallOp>(indexOfOp, indexOfFuncOp, ValueRange{data, count, value, fromIndex, sameValueZero});
+            return success();
+        }
+
+        StringRef indexOfFuncName;
+        if (llvmElementType.isInteger(32))
+        {
+            indexOfFuncName = "__ts_array_index_of_i32";
+        }
+        else if (elementType.isa<mlir_ts::StringType>())
+        {
+            indexOfFuncName = "__ts_array_index_of_string";
+        }
+        else if (llvmElementType.isa<LLVM::LLVMPointerType>())
+        {
+            // references are compared by address
+            indexOfFuncName = "__ts_array_index_of_ptr";
+            data = rewriter.create<LLVM::BitcastOp>(loc, th.getI8PtrPtrType(), data);
+            value = clh.castToI8Ptr(value);
+        }
+        else
+        {
+            return rewriter.notifyMatchFailure(indexOfOp, "indexOf in array of this type is not supported");
+        }
+
+        auto indexOfFuncOp = ch.getOrInsertFunction(
+            indexOfFuncName,
+            th.getFunctionType(th.getI32Type(), {data.getType(), th.getI32Type(), value.getType(), th.getI32Type()}));
+        rewriter.replaceOpWithNewOp<LLVM::CallOp>(indexOfOp, indexOfFuncOp, ValueRange{data, count, value, fromIndex});
+        return success();
+    }
+};
+
+struct ArraySliceOpLowering : public TsLlvmPattern<mlir_ts::ArraySliceOp>
+{
+    using TsLlvmPattern<mlir_ts::ArraySliceOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::ArraySliceOp sliceOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        LLVMCodeHelper ch(sliceOp, rewriter, getTypeConverter(), tsLlvmContext->compileOptions);
+        CodeLogicHelper clh(sliceOp, rewriter);
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = sliceOp.getLoc();
+
+        auto arrayType = sliceOp.getType().cast<mlir_ts::ArrayType>();
+        auto llvmElementType = tch.convertType(arrayType.getElementType());
+        auto llvmPtrElementType = th.getPointerType(llvmElementType);
+        auto llvmIndexType = tch.convertType(th.getIndexType());
+
+        auto data = getArrayData(loc, transformed.getOp(), llvmElementType, rewriter);
+        auto length = getArrayLength(loc, transformed.getOp(), rewriter);
+
+        auto zero = clh.createI32ConstantOf(0);
+
+        // negative index is counted from the end, result is in [0, length]
+        auto clampIndex = [&](mlir::Value index) -> mlir::Value {
+            auto fromEnd = rewriter.create<LLVM::AddOp>(loc, th.getI32Type(), ValueRange{length, index});
+            auto isFromEndNegative = rewriter.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::slt, fromEnd, zero);
+            auto fromEndClamped = rewriter.create<LLVM::SelectOp>(loc, isFromEndNegative, zero, fromEnd);
+            auto isGreater = rewriter.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::sgt, index, length);
+            auto clamped = rewriter.create<LLVM::SelectOp>(loc, isGreater, length, index);
+            auto isNegative = rewriter.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::slt, index, zero);
+            return rewriter.create<LLVM::SelectOp>(loc, isNegative, fromEndClamped, clamped);
+        };
+
+        auto start = clampIndex(transformed.getStart());
+        auto end = clampIndex(transformed.getEnd());
+
+        auto difference = rewriter.create<LLVM::SubOp>(loc, th.getI32Type(), ValueRange{end, start});
+        auto isEmpty = rewriter.create<LLVM::ICmpOp>(loc, LLVM::ICmpPredicate::slt, difference, zero);
+        mlir::Value count = rewriter.create<LLVM::SelectOp>(loc, isEmpty, zero, difference);
+
+        mlir::Value countAsIndexType = count;
+        mlir::Value startAsIndexType = start;
+        if (llvmIndexType != th.getI32Type())
+        {
+            countAsIndexType = rewriter.create<LLVM::ZExtOp>(loc, llvmIndexType, count);
+            startAsIndexType = rewriter.create<LLVM::ZExtOp>(loc, llvmIndexType, start);
+        }
+
+        auto sizeOfElementMLIR = rewriter.create<mlir_ts::SizeOfOp>(loc, th.getIndexType(), llvmElementType);
+        auto sizeOfElement = rewriter.create<mlir_ts::DialectCastOp>(loc, llvmIndexType, sizeOfElementMLIR);
+        auto size = rewriter.create<LLVM::MulOp>(loc, llvmIndexType, ValueRange{sizeOfElement, countAsIndexType});
+
+        auto allocated = ch.MemoryAllocBitcast(llvmPtrElementType, size);
+
+        auto src = rewriter.create<LLVM::GEPOp>(loc, llvmPtrElementType, data, ValueRange{startAsIndexType});
+        auto copyMemFuncOp = getOrInsertMemoryCopyFunction(ch, th, llvmIndexType);
+        rewriter.create<LLVM::CallOp>(
+            loc, copyMemFuncOp,
+            ValueRange{clh.castToI8Ptr(allocated), clh.castToI8Ptr(src), size, clh.createI1ConstantOf(false)});
+
+        auto llvmRtArrayStructType = tch.convertType(arrayType);
+        auto structValue = rewriter.create<LLVM::UndefOp>(loc, llvmRtArrayStructType);
+        auto structValue2 = rewriter.create<LLVM::InsertValueOp>(loc, llvmRtArrayStructType, structValue, allocated,
+                                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_DATA_INDEX));
+        auto structValue3 = rewriter.create<LLVM::InsertValueOp>(loc, llvmRtArrayStructType, structValue2, count,
+                                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_SIZE_INDEX));
+
+        rewriter.replaceOp(sliceOp, ValueRange{structValue3});
+        return success();
+    }
+};
+
+struct ArrayConcatOpLowering : public TsLlvmPattern<mlir_ts::ArrayConcatOp>
+{
+    using TsLlvmPattern<mlir_ts::ArrayConcatOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::ArrayConcatOp concatOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        LLVMCodeHelper ch(concatOp, rewriter, getTypeConverter(), tsLlvmContext->compileOptions);
+        CodeLogicHelper clh(concatOp, rewriter);
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = concatOp.getLoc();
+
+        auto arrayType = concatOp.getType().cast<mlir_ts::ArrayType>();
+        auto llvmElementType = tch.convertType(arrayType.getElementType());
+        auto llvmPtrElementType = th.getPointerType(llvmElementType);
+        auto llvmIndexType = tch.convertType(th.getIndexType());
+
+        auto toIndexType = [&](mlir::Value value) -> mlir::Value {
+            return llvmIndexType != th.getI32Type()
+                ? (mlir::Value) rewriter.create<LLVM::ZExtOp>(loc, llvmIndexType, value)
+                : value;
+        };
+
+        // all lengths are known before allocation
+        SmallVector<mlir::Value> lengths;
+        mlir::Value count = clh.createI32ConstantOf(0);
+        for (auto array : transformed.getOps())
+        {
+            auto length = getArrayLength(loc, array, rewriter);
+            lengths.push_back(length);
+            count = rewriter.create<LLVM::AddOp>(loc, th.getI32Type(), ValueRange{count, length});
+        }
+
+        auto sizeOfElementMLIR = rewriter.create<mlir_ts::SizeOfOp>(loc, th.getIndexType(), llvmElementType);
+        auto sizeOfElement = rewriter.create<mlir_ts::DialectCastOp>(loc, llvmIndexType, sizeOfElementMLIR);
+        auto size = rewriter.create<LLVM::MulOp>(loc, llvmIndexType, ValueRange{sizeOfElement, toIndexType(count)});
+
+        auto allocated = ch.MemoryAllocBitcast(llvmPtrElementType, size);
+
+        auto copyMemFuncOp = getOrInsertMemoryCopyFunction(ch, th, llvmIndexType);
+        auto immarg = clh.createI1ConstantOf(false);
+        mlir::Value offset = clh.createIndexConstantOf(llvmIndexType, 0);
+        for (auto [array, length] : llvm::zip(transformed.getOps(), lengths))
+        {
+            auto lengthAsIndexType = toIndexType(length);
+            auto data = getArrayData(loc, array, llvmElementType, rewriter);
+            auto dest = rewriter.create<LLVM::GEPOp>(loc, llvmPtrElementType, allocated, ValueRange{offset});
+            auto partSize = rewriter.create<LLVM::MulOp>(loc, llvmIndexType, ValueRange{sizeOfElement, lengthAsIndexType});
+            rewriter.create<LLVM::CallOp>(loc, copyMemFuncOp,
+                                          ValueRange{clh.castToI8Ptr(dest), clh.castToI8Ptr(data), partSize, immarg});
+            offset = rewriter.create<LLVM::AddOp>(loc, llvmIndexType, ValueRange{offset, lengthAsIndexType});
+        }
+
+        auto llvmRtArrayStructType = tch.convertType(arrayType);
+        auto structValue = rewriter.create<LLVM::UndefOp>(loc, llvmRtArrayStructType);
+        auto structValue2 = rewriter.create<LLVM::InsertValueOp>(loc, llvmRtArrayStructType, structValue, allocated,
+                                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_DATA_INDEX));
+        auto structValue3 = rewriter.create<LLVM::InsertValueOp>(loc, llvmRtArrayStructType, structValue2, count,
+                                                                 MLIRHelper::getStructIndex(rewriter, ARRAY_SIZE_INDEX));
+
+        rewriter.replaceOp(concatOp, ValueRange{structValue3});
+        return success();
+    }
+};
+
+struct ArrayJoinOpLowering : public TsLlvmPattern<mlir_ts::ArrayJoinOp>
+{
+    using TsLlvmPattern<mlir_ts::ArrayJoinOp>::TsLlvmPattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::ArrayJoinOp joinOp, Adaptor transformed,
+                                  ConversionPatternRewriter &rewriter) const final
+    {
+        LLVMCodeHelper ch(joinOp, rewriter, getTypeConverter(), tsLlvmContext->compileOptions);
+        TypeConverterHelper tch(getTypeConverter());
+        TypeHelper th(rewriter);
+
+        auto loc = joinOp.getLoc();
+
+        auto elementType = joinOp.getOp().getType().cast<mlir_ts::ArrayType>().getElementType();
+        if (!elementType.isa<mlir_ts::StringType>())
+        {
+            return rewriter.notifyMatchFailure(joinOp, "join of array of strings is expected");
+        }
+
+        auto i8PtrTy = th.getI8PtrType();
+        auto i8PtrPtrTy = th.getI8PtrPtrType();
+        auto llvmIndexType = tch.convertType(th.getIndexType());
+
+        auto data = getArrayData(loc, transformed.getOp(), i8PtrTy, rewriter);
+        auto count = getArrayLength(loc, transformed.getOp(), rewriter);
+        auto separator = transformed.getSeparator();
+
+        // result is allocated once, size is calculated by runtime
+        auto lengthFuncOp = ch.getOrInsertFunction(
+            "__ts_array_join_length", th.getFunctionType(llvmIndexType, {i8PtrPtrTy, th.getI32Type(), i8PtrTy}));
+        auto copyFuncOp = ch.getOrInsertFunction(
+            "__ts_array_join_copy", th.getFunctionType(th.getVoidType(), {i8PtrTy, i8PtrPtrTy, th.getI32Type(), i8PtrTy}));
+
+        auto size = rewriter.create<LLVM::CallOp>(loc, lengthFuncOp, ValueRange{data, count, separator});
+        auto newStringValue = ch.MemoryAllocBitcast(i8PtrTy, size.getResult());
+        rewriter.create<LLVM::CallOp>(loc, copyFuncOp, ValueRange{newStringValue, data, count, separator});
+
+        rewriter.replaceOp(joinOp, ValueRange{newStringValue});
+        return success();
+    }
+};
+
 struct DeleteOpLowering : public TsLlvmPattern<mlir_ts::DeleteOp>
 {
     using TsLlvmPattern<mlir_ts::DeleteOp>::TsLlvmPattern;
@@ -4376,25 +4904,20 @@ class SwitchStateOpLowering : public TsLlvmPattern<mlir_ts::SwitchStateOp>
         SmallVector<int32_t> caseValues;
         SmallVector<mlir::Block *> caseDestinations;
 
-        SmallPtrSet<Operation *, 16> stateLabels;
+        // keep order of labels, index of label in switch is number of state
+        SmallVector<mlir_ts::StateLabelOp, 16> stateLabels;
 
         auto index = 1;
 
         // select all states
-        auto visitorAllStateLabels = [&](Operation *op) {
-            if (auto stateLabelOp = dyn_cast_or_null<mlir_ts::StateLabelOp>(op))
-            {
-                stateLabels.insert(op);
-            }
-        };
-
-        switchStateOp->getParentOp()->walk(visitorAllStateLabels);
+        switchStateOp->getParentOp()->walk([&](mlir_ts::StateLabelOp stateLabelOp) {
+            stateLabels.push_back(stateLabelOp);
+        });
 
         {
             mlir::OpBuilder::InsertionGuard insertGuard(rewriter);
-            for (auto op : stateLabels)
+            for (auto stateLabelOp : stateLabels)
             {
-                auto stateLabelOp = dyn_cast_or_null<mlir_ts::StateLabelOp>(op);
                 rewriter.setInsertionPoint(stateLabelOp);
 
                 auto *continuationBlock = clh.BeginBlock(loc);
@@ -5371,6 +5894,7 @@ void TypeScriptToLLVMLoweringPass::runOnOperation()
     // set of legal ones.
     RewritePatternSet patterns(&getContext());
     populateAffineToStdConversionPatterns(patterns);
+    populateSCFToControlFlowConversionPatterns(patterns);
     arith::populateArithToLLVMConversionPatterns(typeConverter, patterns);
     cf::populateControlFlowToLLVMConversionPatterns(typeConverter, patterns);
     populateMathToLLVMConversionPatterns(typeConverter, patterns);
@@ -5389,7 +5913,8 @@ void TypeScriptToLLVMLoweringPass::runOnOperation()
         FuncOpLowering, LoadOpLowering, ElementRefOpLowering, PropertyRefOpLowering, ExtractPropertyOpLowering,
         PointerOffsetRefOpLowering, LogicalBinaryOpLowering, NullOpLowering, NewOpLowering, CreateTupleOpLowering,
         DeconstructTupleOpLowering, CreateArrayOpLowering, NewEmptyArrayOpLowering, NewArrayOpLowering, PushOpLowering,
-        PopOpLowering, DeleteOpLowering, ParseFloatOpLowering, ParseIntOpLowering, IsNaNOpLowering, PrintOpLowering,
+        PopOpLowering, SetLengthOfOpLowering, ArraySortOpLowering, ArrayIndexOfOpLowering, ArraySliceOpLowering,
+        ArrayConcatOpLowering, ArrayJoinOpLowering, DeleteOpLowering, ParseFloatOpLowering, ParseIntOpLowering, IsNaNOpLowering, PrintOpLowering,
         StoreOpLowering, SizeOfOpLowering, InsertPropertyOpLowering, LengthOfOpLowering, StringLengthOpLowering,
         StringConcatOpLowering, StringCompareOpLowering, CharToStringOpLowering, UndefOpLowering, MemoryCopyOpLowering,
         LoadSaveValueLowering, ThrowUnwindOpLowering, ThrowCallOpLowering, VariableOpLowering,
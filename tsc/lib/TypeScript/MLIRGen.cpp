@@ -41,6 +41,7 @@
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/Types.h"
 #include "mlir/IR/Verifier.h"
+#include "mlir/Support/Timing.h"
 
 #include "mlir/Dialect/ControlFlow/IR/ControlFlowOps.h"
 #include "mlir/Dialect/Func/IR/FuncOps.h"
@@ -55,6 +56,7 @@
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
@@ -123,6 +125,16 @@ enum class DisposeDepth
 typedef std::tuple<mlir::Type, mlir::Value, TypeProvided> TypeValueInitType;
 typedef std::function<TypeValueInitType(mlir::Location, const GenContext &)> TypeValueInitFuncType;
 
+// include files (lib.d.ts and its references) parsed by the thread are kept while their text is the same,
+// so compiling many files in one process (--batch) parses default lib once
+struct ParsedIncludeFile
+{
+    std::string text;
+    SourceFile sourceFile;
+};
+
+static thread_local llvm::StringMap<ParsedIncludeFile> parsedIncludeFiles;
+
 /// Implementation of a simple MLIR emission from the TypeScript AST.
 ///
 /// This will emit operations that are specific to the TypeScript language, preserving
@@ -243,9 +255,16 @@ class MLIRGenImpl
 
             const auto *sourceBuf = sourceMgr.getMemoryBuffer(id);
 
-            Parser parser;
-            auto includeFile =
-                parser.parseSourceFile(ConvertUTF8toWide(actualFilePath), stows(sourceBuf->getBuffer().str()), ScriptTarget::Latest);
+            auto &parsedIncludeFile = parsedIncludeFiles[actualFilePath];
+            if (!parsedIncludeFile.sourceFile || parsedIncludeFile.text != sourceBuf->getBuffer())
+            {
+                Parser parser;
+                parsedIncludeFile.text = sourceBuf->getBuffer().str();
+                parsedIncludeFile.sourceFile =
+                    parser.parseSourceFile(ConvertUTF8toWide(actualFilePath), stows(parsedIncludeFile.text), ScriptTarget::Latest);
+            }
+
+            auto includeFile = parsedIncludeFile.sourceFile;
             for (auto refFile : includeFile->referencedFiles)
             {
                 filesToProcess.push_back(refFile.fileName);
@@ -273,7 +292,12 @@ class MLIRGenImpl
         return mlir::success();
     }
 
-    mlir::ModuleOp mlirGenSourceFile(SourceFile module, std::vector<SourceFile> includeFiles)
+    const CompileStatistics &getStatistics() const
+    {
+        return statistics;
+    }
+
+    mlir::ModuleOp mlirGenSourceFile(SourceFile module, std::vector<SourceFile> includeFiles, mlir::TimingScope &timing)
     {
         if (mlir::failed(showMessages(module, includeFiles)))
         {
@@ -298,8 +322,20 @@ class MLIRGenImpl
         llvm::ScopedHashTableScope<StringRef, GenericInterfaceInfo::TypePtr> fullNameGenericInterfacesMapScope(
             fullNameGenericInterfacesMap);
 
-        if (mlir::succeeded(mlirDiscoverAllDependencies(module, includeFiles)) &&
-            mlir::succeeded(mlirCodeGenModule(module, includeFiles)))
+        auto discoveryTiming = timing.nest("discovery");
+        auto result = mlir::succeeded(mlirDiscoverAllDependencies(module, includeFiles));
+        discoveryTiming.stop();
+
+        auto codegenTiming = timing.nest("codegen");
+        result = result && mlir::succeeded(mlirCodeGenModule(module, includeFiles));
+        codegenTiming.stop();
+
+        if (compileOptions.typeCacheStats)
+        {
+            mth.getTypeRelationCache().print(llvm::errs());
+        }
+
+        if (result)
         {
             return theModule;
         }
@@ -383,6 +419,8 @@ class MLIRGenImpl
         auto notResolved = 0;
         do
         {
+            statistics.processStatementsIterations++;
+
             // clear previous errors
             postponedMessages.clear();
 
@@ -398,6 +436,7 @@ class MLIRGenImpl
                     continue;
                 }
 
+                statistics.statements++;
                 if (failed(mlirGen(statement, genContext)))
                 {
                     emitError(loc(statement), "failed statement");
@@ -2230,6 +2269,7 @@ class MLIRGenImpl
                 }
 
                 // create new instance of function with TypeArguments
+                statistics.genericInstantiations++;
                 functionGenericTypeInfo->processing = true;
                 auto [result, funcOp, funcName, isGeneric] =
                     mlirGenFunctionLikeDeclaration(functionGenericTypeInfo->functionDeclaration, genericTypeGenContext);
@@ -2342,6 +2382,7 @@ class MLIRGenImpl
                        llvm::dbgs() << "\n";);
 
             // create new instance of interface with TypeArguments
+            statistics.genericInstantiations++;
             if (mlir::failed(std::get<0>(mlirGen(genericClassInfo->classDeclaration, genericTypeGenContext))))
             {
                 return {mlir::failure(), mlir::Type()};
@@ -2391,6 +2432,7 @@ class MLIRGenImpl
                        llvm::dbgs() << "\n";);
 
             // create new instance of interface with TypeArguments
+            statistics.genericInstantiations++;
             if (mlir::failed(mlirGen(genericInterfaceInfo->interfaceDeclaration, genericTypeGenContext)))
             {
                 // return mlir::Type();
@@ -4173,6 +4215,13 @@ class MLIRGenImpl
             attrs.push_back({mlir::StringAttr::get(builder.getContext(), "import"), mlir::UnitAttr::get(builder.getContext())});
         }
 
+#ifdef ENABLE_ASYNC
+        if (hasModifier(functionLikeDeclarationBaseAST, SyntaxKind::AsyncKeyword))
+        {
+            asyncFunctions.insert(fullName);
+        }
+#endif
+
         auto it = getCaptureVarsMap().find(funcProto->getName());
         auto hasCapturedVars = funcProto->getHasCapturedVars() || (it != getCaptureVarsMap().end());
         if (hasCapturedVars)
@@ -5572,6 +5621,12 @@ class MLIRGenImpl
     ValueOrLogicalResult mlirGen(AwaitExpression awaitExpressionAST, const GenContext &genContext)
     {
 #ifdef ENABLE_ASYNC
+        // fast path: value is already available (or produced by non-async function), no need to create task
+        if (!isAsyncExpression(awaitExpressionAST->expression))
+        {
+            return mlirGen(awaitExpressionAST->expression, genContext);
+        }
+
         auto location = loc(awaitExpressionAST);
 
         auto resultType = evaluate(awaitExpressionAST->expression, genContext);
@@ -5603,6 +5658,8 @@ class MLIRGenImpl
             });
         EXIT_IF_FAILED_OR_NO_VALUE(result)
 
+        // inside of async.execute region (for example body of "for await") AwaitOp is lowered into
+        // coroutine suspension (async.runtime.await_and_resume), otherwise it blocks current thread
         if (resultType)
         {
             auto asyncAwaitOp = builder.create<mlir::async::AwaitOp>(location, asyncExecOp.getResults().back());
@@ -5619,6 +5676,38 @@ class MLIRGenImpl
 #endif
     }
 
+#ifdef ENABLE_ASYNC
+    // only call of async function produces value which is not available yet
+    bool isAsyncExpression(Expression expressionAST)
+    {
+        SyntaxKind kind = expressionAST;
+        if (kind == SyntaxKind::ParenthesizedExpression)
+        {
+            return isAsyncExpression(expressionAST.as<ParenthesizedExpression>()->expression);
+        }
+
+        if (kind != SyntaxKind::CallExpression)
+        {
+            return false;
+        }
+
+        auto calleeExpression = expressionAST.as<CallExpression>()->expression;
+        if (calleeExpression != SyntaxKind::Identifier)
+        {
+            // method or function reference, we do not know if it is async
+            return true;
+        }
+
+        auto funcOp = lookupFunctionMap(MLIRHelper::getName(calleeExpression.as<Identifier>()));
+        if (!funcOp)
+        {
+            return true;
+        }
+
+        return asyncFunctions.contains(funcOp.getName());
+    }
+#endif
+
     mlir::LogicalResult processReturnType(mlir::Value expressionValue, const GenContext &genContext)
     {
         // TODO: rewrite it using UnionType
@@ -6489,7 +6578,7 @@ class MLIRGenImpl
         return mlirGen(forStatNode, genContext);
     }
 
-    mlir::LogicalResult mlirGenES2015(ForOfStatement forOfStatementAST, mlir::Value exprValue,
+    mlir::LogicalResult mlirGenES2015(ForOfStatement forOfStatementAST, mlir::Value exprValue, mlir::Type nextType,
                                       const GenContext &genContext)
     {
         SymbolTableScopeT varScope(symbolTable);
@@ -6512,12 +6601,23 @@ class MLIRGenImpl
 
         NodeArray<Expression> nextArgs;
 
+        // as in IteratorRecord.[[NextMethod]] resolve "next" only once, so every iteration is direct call of bound
+        // method (generators, iterators of object literals) instead of property lookup and creating bound method
+        Expression nextMethod = nf.createPropertyAccessExpression(_b, _next);
+        if (nextType && nextType.isa<mlir_ts::BoundFunctionType>() && !forOfStatementAST->awaitModifier)
+        {
+            auto _n = nf.createIdentifier(S(".n"));
+            auto _nVar = nf.createVariableDeclaration(_n, undefined, undefined, nextMethod);
+            declarations.push_back(_nVar);
+            nextMethod = _n;
+        }
+
         auto _c = nf.createIdentifier(S(".c"));
         auto _done = nf.createIdentifier(S("done"));
         auto _value = nf.createIdentifier(S("value"));
         auto _cVar = nf.createVariableDeclaration(
             _c, undefined, undefined,
-            nf.createCallExpression(nf.createPropertyAccessExpression(_b, _next), undefined, nextArgs));
+            nf.createCallExpression(nextMethod, undefined, nextArgs));
         declarations.push_back(_cVar);
 
         // condition
@@ -6527,7 +6627,7 @@ class MLIRGenImpl
         // incr
         auto incr = nf.createBinaryExpression(
             _c, nf.createToken(SyntaxKind::EqualsToken),
-            nf.createCallExpression(nf.createPropertyAccessExpression(_b, _next), undefined, nextArgs));
+            nf.createCallExpression(nextMethod, undefined, nextArgs));
 
         // block
         NodeArray<ts::Statement> statements;
@@ -6585,7 +6685,7 @@ class MLIRGenImpl
         auto propertyType = evaluateProperty(exprValue, ITERATOR_NEXT, genContext);
         if (propertyType)
         {
-            if (mlir::succeeded(mlirGenES2015(forOfStatementAST, exprValue, genContext)))
+            if (mlir::succeeded(mlirGenES2015(forOfStatementAST, exprValue, propertyType, genContext)))
             {
                 return mlir::success();
             }
@@ -9390,6 +9490,20 @@ class MLIRGenImpl
     {
         auto location = loc(callExpression);
 
+        SmallVector<CallExpression> arrayMethodCalls;
+        Expression arrayExpression;
+        if (getArrayMethodChain(callExpression, arrayMethodCalls, arrayExpression, genContext))
+        {
+            return mlirGenArrayMethodChain(arrayMethodCalls, arrayExpression, genContext);
+        }
+
+        auto descending = false;
+        if (isNumericSortCall(callExpression, descending) &&
+            isArrayOfNumbers(evaluate(callExpression->expression.as<PropertyAccessExpression>()->expression, genContext)))
+        {
+            return mlirGenArrayNumericSort(callExpression, descending, genContext);
+        }
+
         auto callExpr = callExpression->expression.as<Expression>();
 
         auto result = mlirGen(callExpr, genContext);
@@ -9442,295 +9556,815 @@ class MLIRGenImpl
         return mlirGenCallExpression(location, funcResult, callExpression->typeArguments, operands, genContext);
     }
 
-    mlir::LogicalResult mlirGenArrayForEach(mlir::Location location, ArrayRef<mlir::Value> operands,
-                                            const GenContext &genContext)
+    struct ArrayMethodStage
+    {
+        StringRef name;
+        mlir::Value func;
+        mlir::Value init;
+    };
+
+    bool isArrayMethodChainCall(CallExpression callExpression, bool isLast)
+    {
+        if (callExpression->expression != SyntaxKind::PropertyAccessExpression || callExpression->typeArguments.size() > 0)
+        {
+            return false;
+        }
+
+        auto propertyAccessExpression = callExpression->expression.as<PropertyAccessExpression>();
+        if (propertyAccessExpression->questionDotToken)
+        {
+            return false;
+        }
+
+        auto name = MLIRHelper::getName(propertyAccessExpression->name);
+        auto isMapOrFilter = name == "map" || name == "filter";
+        auto isLastOnly = name == "forEach" || name == "every" || name == "some" || name == "reduce";
+        if (!isMapOrFilter && !(isLast && isLastOnly))
+        {
+            return false;
+        }
+
+        if (callExpression->arguments.size() != (name == "reduce" ? 2u : 1u))
+        {
+            return false;
+        }
+
+        // fused loop calls callbacks of all stages for every element, while JS runs every stage over the whole array
+        // first, so the order of side effects of callbacks is different: only callbacks without them are fused
+        if (!isArrayCallbackWithoutSideEffects(callExpression->arguments[0]))
+        {
+            return false;
+        }
+
+        if (name == "reduce")
+        {
+            auto kind = (SyntaxKind)callExpression->arguments[1];
+            if (kind != SyntaxKind::Identifier && kind != SyntaxKind::NumericLiteral && kind != SyntaxKind::StringLiteral)
+            {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    // arrow function or function expression without calls, throws and changes of captured variables or properties
+    bool isArrayCallbackWithoutSideEffects(Expression callback)
+    {
+        auto kind = (SyntaxKind)callback;
+        if (kind != SyntaxKind::ArrowFunction && kind != SyntaxKind::FunctionExpression)
+        {
+            return false;
+        }
+
+        llvm::StringSet<> locals;
+        VisitorAST declarationsVisitor([&](Node node) {
+            SyntaxKind nodeKind = node;
+            if (nodeKind == SyntaxKind::Parameter || nodeKind == SyntaxKind::VariableDeclaration)
+            {
+                auto declarationName = node.as<NamedDeclaration>()->name;
+                if (declarationName == SyntaxKind::Identifier)
+                {
+                    locals.insert(MLIRHelper::getName(declarationName));
+                }
+            }
+        });
+        declarationsVisitor.visit(callback);
+
+        auto isLocal = [&](Node target) {
+            return target == SyntaxKind::Identifier && locals.contains(MLIRHelper::getName(target));
+        };
+
+        auto hasSideEffects = false;
+        VisitorAST sideEffectsVisitor([&](Node node) {
+            SyntaxKind nodeKind = node;
+            switch (nodeKind)
+            {
+            case SyntaxKind::CallExpression:
+            case SyntaxKind::NewExpression:
+            case SyntaxKind::TaggedTemplateExpression:
+            case SyntaxKind::DeleteExpression:
+            case SyntaxKind::AwaitExpression:
+            case SyntaxKind::YieldExpression:
+            case SyntaxKind::ThrowStatement:
+                hasSideEffects = true;
+                break;
+            case SyntaxKind::BinaryExpression:
+            {
+                auto binaryExpression = node.as<BinaryExpression>();
+                if (isAssignmentOperator((SyntaxKind)binaryExpression->operatorToken) && !isLocal(binaryExpression->left))
+                {
+                    hasSideEffects = true;
+                }
+
+                break;
+            }
+            case SyntaxKind::PrefixUnaryExpression:
+            {
+                auto prefixUnaryExpression = node.as<PrefixUnaryExpression>();
+                auto unaryOperator = prefixUnaryExpression->_operator;
+                if ((unaryOperator == SyntaxKind::PlusPlusToken || unaryOperator == SyntaxKind::MinusMinusToken) &&
+                    !isLocal(prefixUnaryExpression->operand))
+                {
+                    hasSideEffects = true;
+                }
+
+                break;
+            }
+            case SyntaxKind::PostfixUnaryExpression:
+                if (!isLocal(node.as<PostfixUnaryExpression>()->operand))
+                {
+                    hasSideEffects = true;
+                }
+
+                break;
+            default:
+                break;
+            }
+        });
+        sideEffectsVisitor.visit(callback);
+
+        return !hasSideEffects;
+    }
+
+    // detects "a.map(f).filter(g).reduce(h, 0)", calls are returned from the last one to the first one
+    bool getArrayMethodChain(CallExpression callExpression, SmallVector<CallExpression> &calls,
+                             Expression &arrayExpression, const GenContext &genContext)
+    {
+        auto current = callExpression;
+        while (isArrayMethodChainCall(current, calls.empty()))
+        {
+            calls.push_back(current);
+            arrayExpression = current->expression.as<PropertyAccessExpression>()->expression;
+            if (arrayExpression != SyntaxKind::CallExpression)
+            {
+                break;
+            }
+
+            current = arrayExpression.as<CallExpression>();
+        }
+
+        if (calls.size() < 2)
+        {
+            return false;
+        }
+
+        auto arrayType = evaluate(arrayExpression, genContext);
+        return arrayType && (arrayType.isa<mlir_ts::ArrayType>() || arrayType.isa<mlir_ts::ConstArrayType>());
+    }
+
+    ValueOrLogicalResult mlirGenArrayMethodChain(ArrayRef<CallExpression> calls, Expression arrayExpression,
+                                                 const GenContext &genContext)
+    {
+        auto location = loc(calls.front());
+
+        auto result = mlirGen(arrayExpression, genContext);
+        EXIT_IF_FAILED_OR_NO_VALUE(result)
+        auto arraySrc = V(result);
+        if (arraySrc.getType().isa<mlir_ts::ConstArrayType>())
+        {
+            arraySrc = builder.create<mlir_ts::CastOp>(location, mth.convertConstArrayTypeToArrayType(arraySrc.getType()), arraySrc);
+        }
+
+        SmallVector<ArrayMethodStage> stages;
+        auto receiver = arraySrc;
+        for (auto callExpression : llvm::reverse(calls))
+        {
+            auto propertyAccessExpression = callExpression->expression.as<PropertyAccessExpression>();
+            auto name = MLIRHelper::getName(propertyAccessExpression->name, stringAllocator);
+
+            // method is used only to get types of callbacks
+            auto funcResult = mlirGenPropertyAccessExpression(location, receiver, name, genContext);
+            EXIT_IF_FAILED_OR_NO_VALUE(funcResult)
+            auto funcValue = V(funcResult);
+
+            SmallVector<mlir::Value, 4> operands;
+            if (mlir::failed(mlirGenOperands(callExpression->arguments, operands, funcValue.getType(), genContext)))
+            {
+                return mlir::failure();
+            }
+
+            if (funcValue.use_empty())
+            {
+                funcValue.getDefiningOp()->erase();
+            }
+
+            if (receiver != arraySrc && receiver.use_empty())
+            {
+                receiver.getDefiningOp()->erase();
+            }
+
+            stages.push_back({name, operands[0], operands.size() > 1 ? operands[1] : mlir::Value()});
+            if (stages.size() == calls.size())
+            {
+                break;
+            }
+
+            // placeholder of result of "map" or "filter"
+            auto elementType = receiver.getType().cast<mlir_ts::ArrayType>().getElementType();
+            if (name == "map")
+            {
+                elementType = mth.wideStorageType(mth.getReturnTypeFromFuncRef(operands[0].getType()));
+                if (!elementType)
+                {
+                    emitError(location) << "callback of 'map' must return value";
+                    return mlir::failure();
+                }
+            }
+
+            receiver = builder.create<mlir_ts::UndefOp>(location, getArrayType(elementType));
+        }
+
+        return mlirGenArrayMethods(location, arraySrc, stages, genContext);
+    }
+
+    // Array methods are generated as eager loop over source array. Every "map" and "filter" of a chain is a step of
+    // the loop body, so intermediate arrays are not created. "map" and "filter" at the end of the chain store values
+    // into array which is preallocated by length of source array.
+    ValueOrLogicalResult mlirGenArrayMethods(mlir::Location location, mlir::Value arraySrc,
+                                             ArrayRef<ArrayMethodStage> stages, const GenContext &genContext)
     {
         SymbolTableScopeT varScope(symbolTable);
 
-        auto arraySrc = operands[0];
-        auto funcSrc = operands[1];
+        auto arrayType = arraySrc.getType().dyn_cast<mlir_ts::ArrayType>();
+        if (!arrayType)
+        {
+            emitError(location) << "array is expected, but got: " << arraySrc.getType();
+            return mlir::failure();
+        }
+
+        // type of values at the end of the chain
+        auto elementType = arrayType.getElementType();
+        auto anyFilter = false;
+        for (auto &stage : stages)
+        {
+            if (stage.name == "map")
+            {
+                elementType = mth.wideStorageType(mth.getReturnTypeFromFuncRef(stage.func.getType()));
+                if (!elementType)
+                {
+                    emitError(location) << "callback of 'map' must return value";
+                    return mlir::failure();
+                }
+            }
+            else if (stage.name == "filter")
+            {
+                anyFilter = true;
+            }
+        }
 
         // register vals
         auto srcArrayVarDecl = std::make_shared<VariableDeclarationDOM>(".src_array", arraySrc.getType(), location);
         DECLARE(srcArrayVarDecl, arraySrc);
 
-        auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(".func", funcSrc.getType(), location);
-        DECLARE(funcVarDecl, funcSrc);
+        auto lastStage = stages.back().name;
+        auto materialize = lastStage == "map" || lastStage == "filter";
+        if (materialize)
+        {
+            auto lengthValue = builder.create<mlir_ts::LengthOfOp>(location, mth.getStructIndexType(), arraySrc);
+            auto newArrayValue = builder.create<mlir_ts::NewArrayOp>(location, getArrayType(elementType), lengthValue);
+            registerVariable(
+                location, ".res", false, VariableType::Let,
+                [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                    return {newArrayValue.getType(), newArrayValue, TypeProvided::Yes};
+                },
+                genContext);
+
+            auto zeroValue = builder.create<mlir_ts::ConstantOp>(location, mth.getStructIndexType(), mth.getStructIndexAttrValue(0));
+            registerVariable(
+                location, ".n", false, VariableType::Let,
+                [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                    return {zeroValue.getType(), zeroValue, TypeProvided::Yes};
+                },
+                genContext);
+        }
+        else if (lastStage == "every" || lastStage == "some")
+        {
+            auto initVal = builder.create<mlir_ts::ConstantOp>(location, getBooleanType(), builder.getBoolAttr(lastStage == "every"));
+            registerVariable(
+                location, lastStage == "every" ? ".ev" : ".sm", false, VariableType::Let,
+                [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                    return {getBooleanType(), initVal, TypeProvided::No};
+                },
+                genContext);
+        }
+        else if (lastStage == "reduce")
+        {
+            auto initValue = stages.back().init;
+            auto accType = mth.wideStorageType(initValue.getType());
+            if (accType != initValue.getType())
+            {
+                CAST(initValue, location, accType, initValue, genContext);
+            }
+
+            registerVariable(
+                location, ".acc", false, VariableType::Let,
+                [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                    return {accType, initValue, TypeProvided::Yes};
+                },
+                genContext);
+        }
 
         NodeFactory nf(NodeFactoryFlags::None);
 
         auto _src_array_ident = nf.createIdentifier(S(".src_array"));
-        auto _func_ident = nf.createIdentifier(S(".func"));
-
         auto _v_ident = nf.createIdentifier(S(".v"));
 
+        NodeArray<Statement> statements;
+        Expression _value_ident = _v_ident;
+        for (size_t index = 0; index < stages.size(); index++)
+        {
+            auto &stage = stages[index];
+
+            auto funcName = (Twine(".func") + Twine(index)).str();
+            auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(funcName, stage.func.getType(), location);
+            DECLARE(funcVarDecl, stage.func);
+
+            NodeArray<Expression> argumentsArray;
+            if (stage.name == "reduce")
+            {
+                argumentsArray.push_back(nf.createIdentifier(S(".acc")));
+            }
+
+            argumentsArray.push_back(_value_ident);
+            auto _call = nf.createCallExpression(nf.createIdentifier(stows(funcName)), undefined, argumentsArray);
+
+            if (stage.name == "map")
+            {
+                auto _next_value_ident = nf.createIdentifier(stows((Twine(".v") + Twine(index)).str()));
+
+                NodeArray<VariableDeclaration> declarations;
+                declarations.push_back(nf.createVariableDeclaration(_next_value_ident, undefined, undefined, _call));
+                statements.push_back(nf.createVariableStatement(
+                    undefined, nf.createVariableDeclarationList(declarations, NodeFlags::Const)));
+
+                _value_ident = _next_value_ident;
+            }
+            else if (stage.name == "filter")
+            {
+                statements.push_back(nf.createIfStatement(
+                    nf.createPrefixUnaryExpression(nf.createToken(SyntaxKind::ExclamationToken), _call),
+                    nf.createContinueStatement(), undefined));
+            }
+            else if (stage.name == "forEach")
+            {
+                statements.push_back(nf.createExpressionStatement(_call));
+            }
+            else if (stage.name == "every")
+            {
+                statements.push_back(nf.createIfStatement(
+                    nf.createPrefixUnaryExpression(
+                        nf.createToken(SyntaxKind::ExclamationToken),
+                        nf.createBinaryExpression(nf.createIdentifier(S(".ev")),
+                                                  nf.createToken(SyntaxKind::AmpersandAmpersandEqualsToken), _call)),
+                    nf.createBreakStatement(), undefined));
+            }
+            else if (stage.name == "some")
+            {
+                statements.push_back(nf.createIfStatement(
+                    nf.createBinaryExpression(nf.createIdentifier(S(".sm")), nf.createToken(SyntaxKind::BarBarEqualsToken),
+                                              _call),
+                    nf.createBreakStatement(), undefined));
+            }
+            else if (stage.name == "reduce")
+            {
+                statements.push_back(nf.createExpressionStatement(
+                    nf.createBinaryExpression(nf.createIdentifier(S(".acc")), nf.createToken(SyntaxKind::EqualsToken), _call)));
+            }
+        }
+
+        if (materialize)
+        {
+            // .res[.n++] = value
+            auto _res_element = nf.createElementAccessExpression(
+                nf.createIdentifier(S(".res")),
+                nf.createPostfixUnaryExpression(nf.createIdentifier(S(".n")), SyntaxKind::PlusPlusToken));
+            statements.push_back(nf.createExpressionStatement(
+                nf.createBinaryExpression(_res_element, nf.createToken(SyntaxKind::EqualsToken), _value_ident)));
+        }
+
         NodeArray<VariableDeclaration> declarations;
         declarations.push_back(nf.createVariableDeclaration(_v_ident));
         auto declList = nf.createVariableDeclarationList(declarations, NodeFlags::Const);
 
-        NodeArray<Expression> argumentsArray;
-        argumentsArray.push_back(_v_ident);
+        auto forOfStat = nf.createForOfStatement(undefined, declList, _src_array_ident, nf.createBlock(statements, false));
+        if (mlir::failed(mlirGen(forOfStat, genContext)))
+        {
+            return mlir::failure();
+        }
 
-        auto forOfStat = nf.createForOfStatement(
-            undefined, declList, _src_array_ident,
-            nf.createExpressionStatement(nf.createCallExpression(_func_ident, undefined, argumentsArray)));
+        if (lastStage == "forEach")
+        {
+            return mlir::success();
+        }
+
+        if (lastStage == "every")
+        {
+            return resolveIdentifier(location, ".ev", genContext);
+        }
+
+        if (lastStage == "some")
+        {
+            return resolveIdentifier(location, ".sm", genContext);
+        }
+
+        if (lastStage == "reduce")
+        {
+            return resolveIdentifier(location, ".acc", genContext);
+        }
+
+        if (anyFilter)
+        {
+            // array was allocated for all values of source array
+            MLIRCodeLogic mcl(builder);
+            auto resultRef = mcl.GetReferenceOfLoadOp(resolveIdentifier(location, ".res", genContext));
+            builder.create<mlir_ts::SetLengthOfOp>(location, resultRef, resolveIdentifier(location, ".n", genContext));
+        }
+
+        return resolveIdentifier(location, ".res", genContext);
+    }
 
-        mlirGen(forOfStat, genContext);
+    mlir::LogicalResult mlirGenArrayForEach(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                            const GenContext &genContext)
+    {
+        auto result = mlirGenArrayMethods(location, operands[0], {{"forEach", operands[1]}}, genContext);
+        EXIT_IF_FAILED(result)
+        return mlir::success();
+    }
+
+    ValueOrLogicalResult mlirGenArrayEvery(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                           const GenContext &genContext)
+    {
+        return mlirGenArrayMethods(location, operands[0], {{"every", operands[1]}}, genContext);
+    }
+
+    ValueOrLogicalResult mlirGenArraySome(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                          const GenContext &genContext)
+    {
+        return mlirGenArrayMethods(location, operands[0], {{"some", operands[1]}}, genContext);
+    }
+
+    ValueOrLogicalResult mlirGenArrayMap(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                         const GenContext &genContext)
+    {
+        return mlirGenArrayMethods(location, operands[0], {{"map", operands[1]}}, genContext);
+    }
+
+    ValueOrLogicalResult mlirGenArrayFilter(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                            const GenContext &genContext)
+    {
+        return mlirGenArrayMethods(location, operands[0], {{"filter", operands[1]}}, genContext);
+    }
+
+    ValueOrLogicalResult mlirGenArrayReduce(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                            const GenContext &genContext)
+    {
+        if (operands.size() < 3)
+        {
+            emitError(location) << "initial value of 'reduce' is required";
+            return mlir::failure();
+        }
 
-        return mlir::success();
+        return mlirGenArrayMethods(location, operands[0], {{"reduce", operands[1], operands[2]}}, genContext);
     }
 
-    ValueOrLogicalResult mlirGenArrayEvery(mlir::Location location, ArrayRef<mlir::Value> operands,
-                                           const GenContext &genContext)
+    // detects "a.sort((x, y) => x - y)" and "a.sort((x, y) => y - x)", such compare function can be replaced with
+    // numeric order of runtime as stability of sort can't be observed
+    bool isNumericSortCall(CallExpression callExpression, bool &descending)
     {
-        SymbolTableScopeT varScope(symbolTable);
+        if (callExpression->expression != SyntaxKind::PropertyAccessExpression || callExpression->arguments.size() != 1)
+        {
+            return false;
+        }
 
-        auto varName = ".ev";
-        auto initVal = builder.create<mlir_ts::ConstantOp>(location, getBooleanType(), builder.getBoolAttr(true));
-        registerVariable(
-            location, varName, false, VariableType::Let,
-            [&](mlir::Location, const GenContext &) -> TypeValueInitType {
-                return {getBooleanType(), initVal, TypeProvided::No};
-            },
-            genContext);
+        auto propertyAccessExpression = callExpression->expression.as<PropertyAccessExpression>();
+        if (propertyAccessExpression->questionDotToken || MLIRHelper::getName(propertyAccessExpression->name) != "sort")
+        {
+            return false;
+        }
 
-        auto arraySrc = operands[0];
-        auto funcSrc = operands[1];
+        auto argument = callExpression->arguments.front();
+        if (argument != SyntaxKind::ArrowFunction)
+        {
+            return false;
+        }
 
-        // register vals
-        auto srcArrayVarDecl = std::make_shared<VariableDeclarationDOM>(".src_array", arraySrc.getType(), location);
-        DECLARE(srcArrayVarDecl, arraySrc);
+        auto arrowFunction = argument.as<ArrowFunction>();
+        if (arrowFunction->parameters.size() != 2)
+        {
+            return false;
+        }
 
-        auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(".func", funcSrc.getType(), location);
-        DECLARE(funcVarDecl, funcSrc);
+        Node body = arrowFunction->body;
+        if (body == SyntaxKind::Block)
+        {
+            auto statements = body.as<Block>()->statements;
+            if (statements.size() != 1 || statements.front() != SyntaxKind::ReturnStatement)
+            {
+                return false;
+            }
 
-        NodeFactory nf(NodeFactoryFlags::None);
+            body = statements.front().as<ReturnStatement>()->expression;
+        }
 
-        auto _src_array_ident = nf.createIdentifier(S(".src_array"));
-        auto _func_ident = nf.createIdentifier(S(".func"));
+        if (body != SyntaxKind::BinaryExpression)
+        {
+            return false;
+        }
 
-        auto _v_ident = nf.createIdentifier(S(".v"));
-        auto _result_ident = nf.createIdentifier(stows(varName));
+        auto binaryExpression = body.as<BinaryExpression>();
+        if ((SyntaxKind)binaryExpression->operatorToken != SyntaxKind::MinusToken ||
+            binaryExpression->left != SyntaxKind::Identifier || binaryExpression->right != SyntaxKind::Identifier ||
+            arrowFunction->parameters[0]->name != SyntaxKind::Identifier ||
+            arrowFunction->parameters[1]->name != SyntaxKind::Identifier)
+        {
+            return false;
+        }
 
-        NodeArray<VariableDeclaration> declarations;
-        declarations.push_back(nf.createVariableDeclaration(_v_ident));
-        auto declList = nf.createVariableDeclarationList(declarations, NodeFlags::Const);
+        auto first = MLIRHelper::getName(arrowFunction->parameters[0]->name);
+        auto second = MLIRHelper::getName(arrowFunction->parameters[1]->name);
+        auto left = MLIRHelper::getName(binaryExpression->left.as<Identifier>());
+        auto right = MLIRHelper::getName(binaryExpression->right.as<Identifier>());
+        if (first == second)
+        {
+            return false;
+        }
 
-        NodeArray<Expression> argumentsArray;
-        argumentsArray.push_back(_v_ident);
+        if (left == first && right == second)
+        {
+            descending = false;
+            return true;
+        }
 
-        auto forOfStat = nf.createForOfStatement(
-            undefined, declList, _src_array_ident,
-            nf.createIfStatement(
-                nf.createPrefixUnaryExpression(
-                    nf.createToken(SyntaxKind::ExclamationToken),
-                    nf.createBinaryExpression(_result_ident, nf.createToken(SyntaxKind::AmpersandAmpersandEqualsToken),
-                                              nf.createCallExpression(_func_ident, undefined, argumentsArray))),
-                nf.createBreakStatement(), undefined));
+        if (left == second && right == first)
+        {
+            descending = true;
+            return true;
+        }
+
+        return false;
+    }
+
+    ValueOrLogicalResult mlirGenArrayNumericSort(CallExpression callExpression, bool descending,
+                                                 const GenContext &genContext)
+    {
+        auto location = loc(callExpression);
 
-        mlirGen(forOfStat, genContext);
+        auto result = mlirGen(callExpression->expression.as<PropertyAccessExpression>()->expression, genContext);
+        EXIT_IF_FAILED_OR_NO_VALUE(result)
+        auto arrayValue = V(result);
 
-        return resolveIdentifier(location, varName, genContext);
+        builder.create<mlir_ts::ArraySortOp>(location, arrayValue, mlir::Value(), builder.getUnitAttr(),
+                                             descending ? builder.getUnitAttr() : mlir::UnitAttr());
+        return arrayValue;
     }
 
-    ValueOrLogicalResult mlirGenArraySome(mlir::Location location, ArrayRef<mlir::Value> operands,
+    bool isArrayOfNumbers(mlir::Type type)
+    {
+        auto arrayType = type.dyn_cast_or_null<mlir_ts::ArrayType>();
+        if (!arrayType)
+        {
+            return false;
+        }
+
+        auto elementType = arrayType.getElementType();
+        return elementType.isa<mlir_ts::NumberType>() || elementType.isInteger(32);
+    }
+
+    ValueOrLogicalResult mlirGenArraySort(mlir::Location location, ArrayRef<mlir::Value> operands,
                                           const GenContext &genContext)
     {
-        SymbolTableScopeT varScope(symbolTable);
+        auto arrayValue = operands[0];
+        auto elementType = arrayValue.getType().cast<mlir_ts::ArrayType>().getElementType();
 
-        auto varName = ".sm";
-        auto initVal = builder.create<mlir_ts::ConstantOp>(location, getBooleanType(), builder.getBoolAttr(false));
-        registerVariable(
-            location, varName, false, VariableType::Let,
-            [&](mlir::Location, const GenContext &) -> TypeValueInitType {
-                return {getBooleanType(), initVal, TypeProvided::No};
-            },
-            genContext);
+        if (operands.size() < 2)
+        {
+            if (!elementType.isa<mlir_ts::NumberType>() && !elementType.isa<mlir_ts::StringType>())
+            {
+                emitError(location) << "sort of array of " << elementType << " requires compare function";
+                return mlir::failure();
+            }
 
-        auto arraySrc = operands[0];
-        auto funcSrc = operands[1];
+            builder.create<mlir_ts::ArraySortOp>(location, arrayValue, mlir::Value(), mlir::UnitAttr(), mlir::UnitAttr());
+            return arrayValue;
+        }
 
-        // register vals
-        auto srcArrayVarDecl = std::make_shared<VariableDeclarationDOM>(".src_array", arraySrc.getType(), location);
-        DECLARE(srcArrayVarDecl, arraySrc);
+        auto compareFuncType = mlir_ts::HybridFunctionType::get(
+            builder.getContext(),
+            mlir_ts::FunctionType::get(builder.getContext(), {elementType, elementType}, {getNumberType()}, false));
+        CAST_A(comparefn, location, compareFuncType, operands[1], genContext);
 
-        auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(".func", funcSrc.getType(), location);
-        DECLARE(funcVarDecl, funcSrc);
+        builder.create<mlir_ts::ArraySortOp>(location, arrayValue, comparefn, mlir::UnitAttr(), mlir::UnitAttr());
+        return arrayValue;
+    }
 
-        NodeFactory nf(NodeFactoryFlags::None);
+    bool isArrayIndexOfSupported(mlir::Type elementType)
+    {
+        return elementType.isa<mlir_ts::NumberType>() || elementType.isInteger(32) ||
+               elementType.isa<mlir_ts::StringType>() || elementType.isa<mlir_ts::ClassType>();
+    }
 
-        auto _src_array_ident = nf.createIdentifier(S(".src_array"));
-        auto _func_ident = nf.createIdentifier(S(".func"));
+    ValueOrLogicalResult mlirGenArrayIndexOf(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                             bool sameValueZero, const GenContext &genContext)
+    {
+        auto arrayValue = operands[0];
+        auto elementType = arrayValue.getType().cast<mlir_ts::ArrayType>().getElementType();
+        if (!isArrayIndexOfSupported(elementType))
+        {
+            emitError(location) << "search in array of " << elementType << " is not supported";
+            return mlir::failure();
+        }
 
-        auto _v_ident = nf.createIdentifier(S(".v"));
-        auto _result_ident = nf.createIdentifier(stows(varName));
+        if (operands.size() < 2)
+        {
+            emitError(location) << "value to search is required";
+            return mlir::failure();
+        }
 
-        NodeArray<VariableDeclaration> declarations;
-        declarations.push_back(nf.createVariableDeclaration(_v_ident));
-        auto declList = nf.createVariableDeclarationList(declarations, NodeFlags::Const);
+        auto value = operands[1];
+        if (value.getType() != elementType)
+        {
+            CAST(value, location, elementType, value, genContext);
+        }
 
-        NodeArray<Expression> argumentsArray;
-        argumentsArray.push_back(_v_ident);
+        mlir::Value fromIndex;
+        if (operands.size() > 2)
+        {
+            CAST(fromIndex, location, builder.getI32Type(), operands[2], genContext);
+        }
+        else
+        {
+            fromIndex = builder.create<mlir_ts::ConstantOp>(location, builder.getI32Type(), builder.getI32IntegerAttr(0));
+        }
 
-        auto forOfStat = nf.createForOfStatement(
-            undefined, declList, _src_array_ident,
-            nf.createIfStatement(
-                nf.createBinaryExpression(_result_ident, nf.createToken(SyntaxKind::BarBarEqualsToken),
-                                          nf.createCallExpression(_func_ident, undefined, argumentsArray)),
-                nf.createBreakStatement(), undefined));
+        return V(builder.create<mlir_ts::ArrayIndexOfOp>(location, builder.getI32Type(), arrayValue, value, fromIndex,
+                                                         sameValueZero ? builder.getUnitAttr() : mlir::UnitAttr()));
+    }
 
-        mlirGen(forOfStat, genContext);
+    ValueOrLogicalResult mlirGenArrayIndexOf(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                             const GenContext &genContext)
+    {
+        auto result = mlirGenArrayIndexOf(location, operands, false, genContext);
+        EXIT_IF_FAILED_OR_NO_VALUE(result)
+        auto index = V(result);
 
-        return resolveIdentifier(location, varName, genContext);
+        CAST_A(indexAsNumber, location, getNumberType(), index, genContext);
+        return indexAsNumber;
     }
 
-    ValueOrLogicalResult mlirGenArrayMap(mlir::Location location, ArrayRef<mlir::Value> operands,
-                                         const GenContext &genContext)
+    ValueOrLogicalResult mlirGenArrayIncludes(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                              const GenContext &genContext)
     {
-        SymbolTableScopeT varScope(symbolTable);
+        auto result = mlirGenArrayIndexOf(location, operands, true, genContext);
+        EXIT_IF_FAILED_OR_NO_VALUE(result)
+        auto index = V(result);
 
-        auto arraySrc = operands[0];
-        auto funcSrc = operands[1];
+        auto zero = builder.create<mlir_ts::ConstantOp>(location, builder.getI32Type(), builder.getI32IntegerAttr(0));
+        return V(builder.create<mlir_ts::LogicalBinaryOp>(
+            location, getBooleanType(), builder.getI32IntegerAttr((int)SyntaxKind::GreaterThanEqualsToken), index, zero));
+    }
 
-        auto [pos, _end] = getPos(location);
+    ValueOrLogicalResult mlirGenArraySlice(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                           const GenContext &genContext)
+    {
+        auto arrayValue = operands[0];
 
-        // register vals
-        auto srcArrayVarDecl = std::make_shared<VariableDeclarationDOM>(".src_array", arraySrc.getType(), location);
-        DECLARE(srcArrayVarDecl, arraySrc);
+        mlir::Value start;
+        if (operands.size() > 1)
+        {
+            CAST(start, location, builder.getI32Type(), operands[1], genContext);
+        }
+        else
+        {
+            start = builder.create<mlir_ts::ConstantOp>(location, builder.getI32Type(), builder.getI32IntegerAttr(0));
+        }
 
-        auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(".func", funcSrc.getType(), location);
-        DECLARE(funcVarDecl, funcSrc);
+        mlir::Value end;
+        if (operands.size() > 2)
+        {
+            CAST(end, location, builder.getI32Type(), operands[2], genContext);
+        }
+        else
+        {
+            end = builder.create<mlir_ts::LengthOfOp>(location, builder.getI32Type(), arrayValue);
+        }
 
-        NodeFactory nf(NodeFactoryFlags::None);
+        return V(builder.create<mlir_ts::ArraySliceOp>(location, arrayValue.getType(), arrayValue, start, end));
+    }
 
-        auto _src_array_ident = nf.createIdentifier(S(".src_array"));
-        auto _func_ident = nf.createIdentifier(S(".func"));
+    ValueOrLogicalResult mlirGenArrayConcat(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                            const GenContext &genContext)
+    {
+        auto arrayType = operands[0].getType().cast<mlir_ts::ArrayType>();
+        auto elementType = arrayType.getElementType();
 
-        auto _v_ident = nf.createIdentifier(S(".v"));
-        
-        NodeArray<VariableDeclaration> declarations;
-        declarations.push_back(nf.createVariableDeclaration(_v_ident));
-        auto declList = nf.createVariableDeclarationList(declarations, NodeFlags::Const);
+        SmallVector<mlir::Value> arrays{operands[0]};
+        for (auto operand : operands.drop_front())
+        {
+            auto operandType = operand.getType();
+            if (operandType.isa<mlir_ts::ArrayType>() || operandType.isa<mlir_ts::ConstArrayType>())
+            {
+                if (operandType != arrayType)
+                {
+                    CAST(operand, location, arrayType, operand, genContext);
+                }
 
-        NodeArray<Expression> argumentsArray;
-        argumentsArray.push_back(_v_ident);
+                arrays.push_back(operand);
+                continue;
+            }
 
-        auto _yield_expr = nf.createYieldExpression(undefined,
-            nf.createCallExpression(_func_ident, undefined, argumentsArray));
-        _yield_expr->pos.pos = pos;
-        _yield_expr->_end = _end;
+            // value is appended as array of one element
+            if (operandType != elementType)
+            {
+                CAST(operand, location, elementType, operand, genContext);
+            }
 
-        auto forOfStat =
-            nf.createForOfStatement(undefined, declList, _src_array_ident,
-                                    nf.createExpressionStatement(_yield_expr));
+            arrays.push_back(builder.create<mlir_ts::CreateArrayOp>(location, arrayType, mlir::ValueRange{operand}));
+        }
 
-        // iterator
-        auto iterName = MLIRHelper::getAnonymousName(location, ".iter");
+        return V(builder.create<mlir_ts::ArrayConcatOp>(location, arrayType, arrays));
+    }
 
-        NodeArray<Statement> statements;
-        statements.push_back(forOfStat);
-        auto block = nf.createBlock(statements, false);
-        auto funcIter =
-            nf.createFunctionExpression(undefined, nf.createToken(SyntaxKind::AsteriskToken),
-                                        nf.createIdentifier(ConvertUTF8toWide(iterName)), undefined, undefined, undefined, block);
+    ValueOrLogicalResult mlirGenArrayJoin(mlir::Location location, ArrayRef<mlir::Value> operands,
+                                          const GenContext &genContext)
+    {
+        auto arrayValue = operands[0];
+        auto elementType = arrayValue.getType().cast<mlir_ts::ArrayType>().getElementType();
 
-        funcIter->pos.pos = pos;
-        funcIter->_end = _end;
+        mlir::Value separator;
+        if (operands.size() > 1)
+        {
+            separator = operands[1];
+            if (separator.getType() != getStringType())
+            {
+                CAST(separator, location, getStringType(), separator, genContext);
+            }
+        }
+        else
+        {
+            separator = builder.create<mlir_ts::ConstantOp>(location, getStringType(), builder.getStringAttr(","));
+        }
 
-        // call
-        NodeArray<Expression> emptyArguments;
-        auto callOfIter = nf.createCallExpression(funcIter, undefined, emptyArguments);
+        if (!elementType.isa<mlir_ts::StringType>())
+        {
+            auto result = mlirGenArrayToStrings(location, arrayValue, genContext);
+            EXIT_IF_FAILED_OR_NO_VALUE(result)
+            arrayValue = V(result);
+        }
 
-        return mlirGen(callOfIter, genContext);
+        return V(builder.create<mlir_ts::ArrayJoinOp>(location, getStringType(), arrayValue, separator));
     }
 
-    ValueOrLogicalResult mlirGenArrayFilter(mlir::Location location, ArrayRef<mlir::Value> operands,
-                                            const GenContext &genContext)
+    // converts values of array into strings by loop "for (const .v of .src_array) .strs[.n++] = .v as string"
+    ValueOrLogicalResult mlirGenArrayToStrings(mlir::Location location, mlir::Value arraySrc,
+                                               const GenContext &genContext)
     {
         SymbolTableScopeT varScope(symbolTable);
 
-        auto arraySrc = operands[0];
-        auto funcSrc = operands[1];
-
-        // register vals
         auto srcArrayVarDecl = std::make_shared<VariableDeclarationDOM>(".src_array", arraySrc.getType(), location);
         DECLARE(srcArrayVarDecl, arraySrc);
 
-        auto funcVarDecl = std::make_shared<VariableDeclarationDOM>(".func", funcSrc.getType(), location);
-        DECLARE(funcVarDecl, funcSrc);
+        auto lengthValue = builder.create<mlir_ts::LengthOfOp>(location, mth.getStructIndexType(), arraySrc);
+        auto newArrayValue = builder.create<mlir_ts::NewArrayOp>(location, getArrayType(getStringType()), lengthValue);
+        registerVariable(
+            location, ".strs", false, VariableType::Let,
+            [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                return {newArrayValue.getType(), newArrayValue, TypeProvided::Yes};
+            },
+            genContext);
 
-        NodeFactory nf(NodeFactoryFlags::None);
+        auto zeroValue = builder.create<mlir_ts::ConstantOp>(location, mth.getStructIndexType(), mth.getStructIndexAttrValue(0));
+        registerVariable(
+            location, ".n", false, VariableType::Let,
+            [&](mlir::Location, const GenContext &) -> TypeValueInitType {
+                return {zeroValue.getType(), zeroValue, TypeProvided::Yes};
+            },
+            genContext);
 
-        auto _src_array_ident = nf.createIdentifier(S(".src_array"));
-        auto _func_ident = nf.createIdentifier(S(".func"));
+        NodeFactory nf(NodeFactoryFlags::None);
 
         auto _v_ident = nf.createIdentifier(S(".v"));
+        auto _strs_element = nf.createElementAccessExpression(
+            nf.createIdentifier(S(".strs")),
+            nf.createPostfixUnaryExpression(nf.createIdentifier(S(".n")), SyntaxKind::PlusPlusToken));
+        auto _as_string = nf.createAsExpression(_v_ident, nf.createToken(SyntaxKind::StringKeyword));
+
+        NodeArray<Statement> statements;
+        statements.push_back(nf.createExpressionStatement(
+            nf.createBinaryExpression(_strs_element, nf.createToken(SyntaxKind::EqualsToken), _as_string)));
 
         NodeArray<VariableDeclaration> declarations;
         declarations.push_back(nf.createVariableDeclaration(_v_ident));
         auto declList = nf.createVariableDeclarationList(declarations, NodeFlags::Const);
 
-        NodeArray<Expression> argumentsArray;
-        argumentsArray.push_back(_v_ident);
-
-        auto [pos, _end] = getPos(location);
-
-        auto _yield_expr = nf.createYieldExpression(undefined, _v_ident);
-        _yield_expr->pos.pos = pos;
-        _yield_expr->_end = _end;
-
-        auto forOfStat = nf.createForOfStatement(
-            undefined, declList, _src_array_ident,
-            nf.createIfStatement(nf.createCallExpression(_func_ident, undefined, argumentsArray),
-                                 nf.createExpressionStatement(_yield_expr),
-                                 undefined));
-
-        // iterator
-        auto iterName = MLIRHelper::getAnonymousName(location, ".iter");
-
-        NodeArray<Statement> statements;
-        statements.push_back(forOfStat);
-        auto block = nf.createBlock(statements, false);
-        auto funcIter =
-            nf.createFunctionExpression(undefined, nf.createToken(SyntaxKind::AsteriskToken),
-                                        nf.createIdentifier(ConvertUTF8toWide(iterName)), undefined, undefined, undefined, block);
-        funcIter->pos.pos = pos;
-        funcIter->_end = _end;
-
-        // call
-        NodeArray<Expression> emptyArguments;
-        auto callOfIter = nf.createCallExpression(funcIter, undefined, emptyArguments);
-
-        return mlirGen(callOfIter, genContext);
-    }
-
-    ValueOrLogicalResult mlirGenArrayReduce(mlir::Location location, SmallVector<mlir::Value, 4> &operands,
-                                            const GenContext &genContext)
-    {
-        // info, we add "_" extra as scanner append "_" in front of "__";
-        auto funcName = "___array_reduce";
-
-        if (!existGenericFunctionMap(funcName))
+        auto forOfStat = nf.createForOfStatement(undefined, declList, nf.createIdentifier(S(".src_array")),
+                                                 nf.createBlock(statements, false));
+        if (mlir::failed(mlirGen(forOfStat, genContext)))
         {
-            auto src = S("function __array_reduce<T, R>(arr: T[], f: (s: R, v: T) => R, init: R) \
-            {   \
-                let r = init;   \
-                for (const v of arr) r = f(r, v);   \
-                return r;   \
-            }");
-
-            if (mlir::failed(parsePartialStatements(src)))
-            {
-                assert(false);
-                return mlir::failure();
-            }
+            return mlir::failure();
         }
 
-        auto funcResult = resolveIdentifier(location, funcName, genContext);
-
-        assert(funcResult);
-
-        return mlirGenCallExpression(location, funcResult, {}, operands, genContext);
+        return resolveIdentifier(location, ".strs", genContext);
     }
 
     ValueOrLogicalResult mlirGenCallExpression(mlir::Location location, mlir::Value funcResult,
@@ -9789,6 +10423,36 @@ class MLIRGenImpl
                 return mlirGenArrayReduce(location, operands, genContext);
             }
 
+            if (functionName == "__array_sort")
+            {
+                return mlirGenArraySort(location, operands, genContext);
+            }
+
+            if (functionName == "__array_indexof")
+            {
+                return mlirGenArrayIndexOf(location, operands, genContext);
+            }
+
+            if (functionName == "__array_includes")
+            {
+                return mlirGenArrayIncludes(location, operands, genContext);
+            }
+
+            if (functionName == "__array_slice")
+            {
+                return mlirGenArraySlice(location, operands, genContext);
+            }
+
+            if (functionName == "__array_concat")
+            {
+                return mlirGenArrayConcat(location, operands, genContext);
+            }
+
+            if (functionName == "__array_join")
+            {
+                return mlirGenArrayJoin(location, operands, genContext);
+            }
+
             // resolve function
             MLIRCustomMethods cm(builder, location, compileOptions);
             return cm.callMethod(functionName, operands, genContext);
@@ -16175,6 +16839,8 @@ genContext);
             return;
         }
 
+        statistics.evaluateCalls++;
+
         // TODO: sometimes we need errors, sometimes, not,
         // we need to ignore errors;
         //mlir::ScopedDiagnosticHandler diagHandler(builder.getContext(), [&](mlir::Diagnostic &diag) {
@@ -20435,7 +21101,7 @@ genContext);
             return begin;
         }
 
-        auto endLineChar = parser.getLineAndCharacterOfPosition(sourceFile, start + length - 1);
+        auto endLineChar = parser.getLineAndCharacterOfPosition(sourceFile, start + length - 1, posLineChar.line);
         auto end =
             mlir::FileLineColLoc::get(builder.getContext(), fileId, endLineChar.line + 1, endLineChar.character + 1);
         return mlir::FusedLoc::get(builder.getContext(), {begin, end});
@@ -20452,7 +21118,7 @@ genContext);
             return begin;
         }
 
-        auto endLineChar = parser.getLineAndCharacterOfPosition(sourceFile, start + length - 1);
+        auto endLineChar = parser.getLineAndCharacterOfPosition(sourceFile, start + length - 1, posLineChar.line);
         auto end =
             mlir::FileLineColLoc::get(builder.getContext(), fileId, endLineChar.line + 1, endLineChar.character + 1);
         return mlir::FusedLoc::get(builder.getContext(), {begin}, end);
@@ -20590,6 +21256,8 @@ genContext);
 
     CompileOptions &compileOptions;
 
+    CompileStatistics statistics;
+
     /// A "module" matches a TypeScript source file: containing a list of functions.
     mlir::ModuleOp theModule;
 
@@ -20620,6 +21288,9 @@ genContext);
 
     llvm::ScopedHashTable<StringRef, VariableDeclarationDOM::TypePtr> fullNameGlobalsMap;
 
+    // full names of functions declared with "async" modifier
+    llvm::StringSet<> asyncFunctions;
+
     // helper to get line number
     Parser parser;
     ts::SourceFile sourceFile;
@@ -20696,13 +21367,34 @@ namespace typescript
 }
 
 mlir::OwningOpRef<mlir::ModuleOp> mlirGenFromSource(const mlir::MLIRContext &context, const llvm::StringRef &fileName,
-                                        const llvm::SourceMgr &sourceMgr, CompileOptions &compileOptions)
+                                        const llvm::SourceMgr &sourceMgr, CompileOptions &compileOptions,
+                                        mlir::TimingScope &timing, CompileStatistics &statistics)
 {
 
     auto path = llvm::sys::path::parent_path(fileName);
     MLIRGenImpl mlirGenImpl(context, fileName, path, sourceMgr, compileOptions);
+
+    auto parseTiming = timing.nest("parse");
     auto [sourceFile, includeFiles] = mlirGenImpl.loadMainSourceFile();
-    return mlirGenImpl.mlirGenSourceFile(sourceFile, includeFiles);
+    parseTiming.stop();
+
+    auto module = mlirGenImpl.mlirGenSourceFile(sourceFile, includeFiles, timing);
+    if (!module)
+    {
+        // failed compilation may leave include files in any state
+        parsedIncludeFiles.clear();
+    }
+
+    statistics = mlirGenImpl.getStatistics();
+    return module;
+}
+
+mlir::OwningOpRef<mlir::ModuleOp> mlirGenFromSource(const mlir::MLIRContext &context, const llvm::StringRef &fileName,
+                                        const llvm::SourceMgr &sourceMgr, CompileOptions &compileOptions)
+{
+    mlir::TimingScope timing;
+    CompileStatistics statistics;
+    return mlirGenFromSource(context, fileName, sourceMgr, compileOptions, timing, statistics);
 }
 
 } // namespace typescript
@@ -0,0 +1,96 @@
+#define DEBUG_TYPE "pass"
+
+#include "mlir/Pass/Pass.h"
+
+#include "TypeScript/Passes.h"
+#include "TypeScript/ModulePass.h"
+
+#include "mlir/Dialect/LLVMIR/LLVMDialect.h"
+
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Debug.h"
+
+namespace mlir_ts = mlir::typescript;
+
+// String literals are lowered into separate globals by many patterns (constants, print, assert, casts to
+// string etc.). The pass leaves one constant global per unique literal and redirects all addresses to it.
+
+namespace
+{
+
+class StringPoolPass : public mlir::PassWrapper<StringPoolPass, ModulePass>
+{
+  public:
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(StringPoolPass)
+
+    void runOnModule() override
+    {
+        auto m = getModule();
+
+        llvm::StringMap<LLVM::GlobalOp> pool;
+        llvm::StringMap<mlir::StringAttr> replacements;
+        mlir::SmallVector<LLVM::GlobalOp> duplicates;
+        for (auto globalOp : m.getOps<LLVM::GlobalOp>())
+        {
+            if (!isStringLiteral(globalOp))
+            {
+                continue;
+            }
+
+            // address of literal is not observable in TypeScript
+            globalOp.setUnnamedAddr(LLVM::UnnamedAddr::Global);
+
+            auto value = globalOp.getValueOrNull().cast<mlir::StringAttr>().getValue();
+            auto [it, inserted] = pool.try_emplace(value, globalOp);
+            if (inserted)
+            {
+                continue;
+            }
+
+            auto canonical = it->second;
+            if (canonical.getType() != globalOp.getType() || canonical.getAddrSpace() != globalOp.getAddrSpace() ||
+                canonical.getAlignment() != globalOp.getAlignment())
+            {
+                continue;
+            }
+
+            replacements[globalOp.getSymName()] = canonical.getSymNameAttr();
+            duplicates.push_back(globalOp);
+        }
+
+        if (duplicates.empty())
+        {
+            return;
+        }
+
+        m.walk([&](LLVM::AddressOfOp addressOfOp) {
+            auto it = replacements.find(addressOfOp.getGlobalName());
+            if (it != replacements.end())
+            {
+                addressOfOp.setGlobalNameAttr(mlir::FlatSymbolRefAttr::get(it->second));
+            }
+        });
+
+        for (auto globalOp : duplicates)
+        {
+            globalOp.erase();
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "\n!! STRING POOL: removed " << duplicates.size() << " duplicate(s)\n";);
+    }
+
+  private:
+    static bool isStringLiteral(LLVM::GlobalOp globalOp)
+    {
+        return globalOp.getConstant() && globalOp.getLinkage() == LLVM::Linkage::Internal &&
+               !globalOp.getThreadLocal_() && globalOp.getInitializerRegion().empty() &&
+               llvm::isa_and_nonnull<mlir::StringAttr>(globalOp.getValueOrNull());
+    }
+};
+} // end anonymous namespace
+
+/// Create pass.
+std::unique_ptr<mlir::Pass> mlir_ts::createStringPoolPass()
+{
+    return std::make_unique<StringPoolPass>();
+}
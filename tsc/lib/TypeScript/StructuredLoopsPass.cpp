@@ -0,0 +1,375 @@
+#define DEBUG_TYPE "pass"
+
+#include "mlir/Pass/Pass.h"
+
+#include "TypeScript/TypeScriptDialect.h"
+#include "TypeScript/TypeScriptOps.h"
+#include "TypeScript/TypeScriptFunctionPass.h"
+#include "TypeScript/Passes.h"
+
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+
+#include "scanner_enums.h"
+
+#include "llvm/ADT/SmallPtrSet.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace mlir_ts = mlir::typescript;
+
+// Lowers counted loops
+//
+//   for (let i = <lb>; i < <ub>; i++) <body>
+//
+// into scf.for when "i" is integer local variable, <ub> is loop invariant (constant, value of variable or
+// `length` of array stored in variable, which are not changed in loop) and body can't change "i", <ub> or
+// leave the loop (no calls, break, continue, return etc.).
+//
+// Body of loop is kept in scf.execute_region, ts ops in it are lowered as usual later.
+
+namespace
+{
+
+class StructuredLoopsPass : public mlir::PassWrapper<StructuredLoopsPass, TypeScriptFunctionPass>
+{
+  public:
+    MLIR_DEFINE_EXPLICIT_INTERNAL_INLINE_TYPE_ID(StructuredLoopsPass)
+
+    void getDependentDialects(mlir::DialectRegistry &registry) const override
+    {
+        registry.insert<mlir::arith::ArithDialect>();
+        registry.insert<mlir::scf::SCFDialect>();
+    }
+
+    void runOnFunction() override
+    {
+        auto f = getFunction();
+
+        // inner loops first
+        mlir::SmallVector<mlir_ts::ForOp> forOps;
+        f.walk([&](mlir_ts::ForOp forOp) { forOps.push_back(forOp); });
+
+        for (auto forOp : forOps)
+        {
+            CountedLoop countedLoop;
+            if (matchCountedLoop(forOp, countedLoop))
+            {
+                lowerToSCF(forOp, countedLoop);
+            }
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "\n!! AFTER STRUCTURED LOOPS FUNC DUMP: \n" << *getFunction() << "\n";);
+    }
+
+  private:
+    struct CountedLoop
+    {
+        mlir_ts::VariableOp counter;
+        mlir::Value lowerBound;
+        mlir::Value upperBound;
+        llvm::SmallPtrSet<mlir::Value, 4> invariantRefs;
+    };
+
+    bool matchCountedLoop(mlir_ts::ForOp forOp, CountedLoop &countedLoop)
+    {
+        if (forOp.getNumOperands() > 0 || forOp.getNumResults() > 0)
+        {
+            return false;
+        }
+
+        if (!forOp.getCond().hasOneBlock() || !forOp.getIncr().hasOneBlock())
+        {
+            return false;
+        }
+
+        return matchCondition(forOp, countedLoop) && matchIncrement(forOp, countedLoop) && isSimpleBody(forOp, countedLoop);
+    }
+
+    // i < <ub>
+    bool matchCondition(mlir_ts::ForOp forOp, CountedLoop &countedLoop)
+    {
+        auto &cond = forOp.getCond().front();
+        for (auto &op : cond)
+        {
+            if (!isa<mlir_ts::LoadOp, mlir_ts::CastOp, mlir_ts::LengthOfOp, mlir_ts::ConstantOp, mlir_ts::LogicalBinaryOp,
+                     mlir_ts::ConditionOp>(&op))
+            {
+                return false;
+            }
+        }
+
+        auto conditionOp = dyn_cast<mlir_ts::ConditionOp>(cond.getTerminator());
+        if (!conditionOp || !conditionOp.getArgs().empty())
+        {
+            return false;
+        }
+
+        auto compareOp = conditionOp.getCondition().getDefiningOp<mlir_ts::LogicalBinaryOp>();
+        if (!compareOp || (SyntaxKind)compareOp.getOpCode() != SyntaxKind::LessThanToken)
+        {
+            return false;
+        }
+
+        auto counterLoadOp = compareOp.getOperand1().getDefiningOp<mlir_ts::LoadOp>();
+        if (!counterLoadOp)
+        {
+            return false;
+        }
+
+        auto counter = getLocalVariable(counterLoadOp.getReference());
+        if (!counter)
+        {
+            return false;
+        }
+
+        auto counterType = counterLoadOp.getType().dyn_cast<mlir::IntegerType>();
+        if (!counterType || !counterType.isSignless() || (counterType.getWidth() != 32 && counterType.getWidth() != 64))
+        {
+            return false;
+        }
+
+        auto upperBound = compareOp.getOperand2();
+        if (upperBound.getType() != counterType)
+        {
+            return false;
+        }
+
+        countedLoop.counter = counter;
+        countedLoop.lowerBound = counterLoadOp;
+        countedLoop.upperBound = upperBound;
+
+        // all variables used to calculate upper bound, must not be changed in loop
+        mlir::SmallVector<mlir::Value> worklist{upperBound};
+        while (!worklist.empty())
+        {
+            auto *defOp = worklist.pop_back_val().getDefiningOp();
+            if (!defOp || defOp->getBlock() != &cond)
+            {
+                // defined outside of loop
+                continue;
+            }
+
+            if (auto loadOp = dyn_cast<mlir_ts::LoadOp>(defOp))
+            {
+                auto variableOp = getLocalVariable(loadOp.getReference());
+                if (!variableOp || variableOp == counter)
+                {
+                    return false;
+                }
+
+                countedLoop.invariantRefs.insert(loadOp.getReference());
+                continue;
+            }
+
+            if (isa<mlir_ts::LogicalBinaryOp>(defOp))
+            {
+                return false;
+            }
+
+            worklist.append(defOp->operand_begin(), defOp->operand_end());
+        }
+
+        return true;
+    }
+
+    // i++, ++i or i = i + 1
+    bool matchIncrement(mlir_ts::ForOp forOp, CountedLoop &countedLoop)
+    {
+        auto counterRef = countedLoop.counter.getResult();
+        auto increments = 0;
+        for (auto &op : forOp.getIncr().front())
+        {
+            if (isa<mlir_ts::LoadOp, mlir_ts::ConstantOp, mlir_ts::CastOp, mlir_ts::ArithmeticBinaryOp, mlir_ts::ResultOp>(&op))
+            {
+                continue;
+            }
+
+            auto opCode = SyntaxKind::Unknown;
+            if (auto operand = getIncrementDecrementOperand(&op, opCode))
+            {
+                auto loadOp = operand.getDefiningOp<mlir_ts::LoadOp>();
+                if (opCode != SyntaxKind::PlusPlusToken || !loadOp || loadOp.getReference() != counterRef)
+                {
+                    return false;
+                }
+
+                increments++;
+                continue;
+            }
+
+            if (auto storeOp = dyn_cast<mlir_ts::StoreOp>(&op))
+            {
+                auto addOp = storeOp.getValue().getDefiningOp<mlir_ts::ArithmeticBinaryOp>();
+                if (storeOp.getReference() != counterRef || !addOp || (SyntaxKind)addOp.getOpCode() != SyntaxKind::PlusToken)
+                {
+                    return false;
+                }
+
+                auto isCounter = [&](mlir::Value value) {
+                    auto loadOp = value.getDefiningOp<mlir_ts::LoadOp>();
+                    return loadOp && loadOp.getReference() == counterRef;
+                };
+
+                if (!(isCounter(addOp.getOperand1()) && isOne(addOp.getOperand2())) &&
+                    !(isOne(addOp.getOperand1()) && isCounter(addOp.getOperand2())))
+                {
+                    return false;
+                }
+
+                increments++;
+                continue;
+            }
+
+            return false;
+        }
+
+        return increments == 1;
+    }
+
+    // body does not leave the loop and does not change counter and upper bound
+    bool isSimpleBody(mlir_ts::ForOp forOp, CountedLoop &countedLoop)
+    {
+        auto isChanged = [&](mlir::Value ref) {
+            return ref == countedLoop.counter.getResult() || countedLoop.invariantRefs.contains(ref);
+        };
+
+        auto result = forOp.getBody().walk([&](mlir::Operation *op) {
+            if (isa_and_nonnull<mlir::arith::ArithDialect, mlir::scf::SCFDialect>(op->getDialect()))
+            {
+                return mlir::WalkResult::advance();
+            }
+
+            if (auto storeOp = dyn_cast<mlir_ts::StoreOp>(op))
+            {
+                return isChanged(storeOp.getReference()) ? mlir::WalkResult::interrupt() : mlir::WalkResult::advance();
+            }
+
+            auto opCode = SyntaxKind::Unknown;
+            if (auto operand = getIncrementDecrementOperand(op, opCode))
+            {
+                auto loadOp = operand.getDefiningOp<mlir_ts::LoadOp>();
+                return !loadOp || isChanged(loadOp.getReference()) ? mlir::WalkResult::interrupt()
+                                                                   : mlir::WalkResult::advance();
+            }
+
+            if (isa<mlir_ts::LoadOp, mlir_ts::ConstantOp, mlir_ts::CastOp, mlir_ts::VariableOp, mlir_ts::ElementRefOp,
+                    mlir_ts::LengthOfOp, mlir_ts::StringLengthOp, mlir_ts::ArithmeticBinaryOp, mlir_ts::ArithmeticUnaryOp,
+                    mlir_ts::LogicalBinaryOp, mlir_ts::IfOp, mlir_ts::ForOp, mlir_ts::WhileOp, mlir_ts::DoWhileOp,
+                    mlir_ts::ConditionOp, mlir_ts::NoConditionOp, mlir_ts::ResultOp, mlir_ts::PrintOp, mlir_ts::AssertOp>(op))
+            {
+                return mlir::WalkResult::advance();
+            }
+
+            LLVM_DEBUG(llvm::dbgs() << "\n!! loop is not counted, op: " << *op << "\n";);
+
+            return mlir::WalkResult::interrupt();
+        });
+
+        return !result.wasInterrupted();
+    }
+
+    void lowerToSCF(mlir_ts::ForOp forOp, CountedLoop &countedLoop)
+    {
+        auto location = forOp.getLoc();
+        mlir::OpBuilder builder(forOp);
+
+        // evaluate bounds once, before loop
+        mlir::IRMapping mapping;
+        for (auto &op : forOp.getCond().front().without_terminator())
+        {
+            if (!isa<mlir_ts::LogicalBinaryOp>(&op))
+            {
+                builder.clone(op, mapping);
+            }
+        }
+
+        auto lowerBound = mapping.lookupOrDefault(countedLoop.lowerBound);
+        auto upperBound = mapping.lookupOrDefault(countedLoop.upperBound);
+        auto counterType = lowerBound.getType();
+
+        auto indexType = builder.getIndexType();
+        auto lowerBoundIndex = builder.create<mlir::arith::IndexCastOp>(location, indexType, lowerBound);
+        auto upperBoundIndex = builder.create<mlir::arith::IndexCastOp>(location, indexType, upperBound);
+        auto step = builder.create<mlir::arith::ConstantIndexOp>(location, 1);
+        auto scfForOp = builder.create<mlir::scf::ForOp>(location, lowerBoundIndex, upperBoundIndex, step);
+
+        builder.setInsertionPointToStart(scfForOp.getBody());
+        auto counterValue =
+            builder.create<mlir::arith::IndexCastOp>(location, counterType, scfForOp.getInductionVar());
+        builder.create<mlir_ts::StoreOp>(location, counterValue, countedLoop.counter);
+
+        auto executeRegionOp = builder.create<mlir::scf::ExecuteRegionOp>(location, mlir::TypeRange{});
+        executeRegionOp.getRegion().takeBody(forOp.getBody());
+        for (auto &block : executeRegionOp.getRegion())
+        {
+            if (auto resultOp = dyn_cast<mlir_ts::ResultOp>(block.getTerminator()))
+            {
+                builder.setInsertionPoint(resultOp);
+                builder.create<mlir::scf::YieldOp>(resultOp.getLoc());
+                resultOp.erase();
+            }
+        }
+
+        // value of counter after loop
+        builder.setInsertionPointAfter(scfForOp);
+        auto finalValue = builder.create<mlir::arith::MaxSIOp>(location, lowerBound, upperBound);
+        builder.create<mlir_ts::StoreOp>(location, finalValue, countedLoop.counter);
+
+        forOp.erase();
+    }
+
+    mlir_ts::VariableOp getLocalVariable(mlir::Value ref)
+    {
+        auto variableOp = ref.getDefiningOp<mlir_ts::VariableOp>();
+        if (!variableOp || variableOp.getCaptured().value_or(false))
+        {
+            return mlir_ts::VariableOp();
+        }
+
+        return variableOp;
+    }
+
+    // operand of ++ or --, which store result back
+    static mlir::Value getIncrementDecrementOperand(mlir::Operation *op, SyntaxKind &opCode)
+    {
+        if (auto prefixUnaryOp = dyn_cast<mlir_ts::PrefixUnaryOp>(op))
+        {
+            opCode = (SyntaxKind)prefixUnaryOp.getOpCode();
+            return prefixUnaryOp.getOperand1();
+        }
+
+        if (auto postfixUnaryOp = dyn_cast<mlir_ts::PostfixUnaryOp>(op))
+        {
+            opCode = (SyntaxKind)postfixUnaryOp.getOpCode();
+            return postfixUnaryOp.getOperand1();
+        }
+
+        return mlir::Value();
+    }
+
+    static bool isOne(mlir::Value value)
+    {
+        if (auto castOp = value.getDefiningOp<mlir_ts::CastOp>())
+        {
+            value = castOp.getIn();
+        }
+
+        auto constantOp = value.getDefiningOp<mlir_ts::ConstantOp>();
+        if (!constantOp)
+        {
+            return false;
+        }
+
+        auto intAttr = constantOp.getValue().dyn_cast_or_null<mlir::IntegerAttr>();
+        return intAttr && intAttr.getValue().isOne();
+    }
+};
+} // end anonymous namespace
+
+/// Create pass.
+std::unique_ptr<mlir::Pass> mlir_ts::createStructuredLoopsPass()
+{
+    return std::make_unique<StructuredLoopsPass>();
+}
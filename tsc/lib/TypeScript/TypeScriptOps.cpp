@@ -21,6 +21,10 @@
 #include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Debug.h"
 
+#include "scanner_enums.h"
+
+#include <optional>
+
 using namespace mlir;
 namespace mlir_ts = mlir::typescript;
 
@@ -728,6 +732,692 @@ bool mlir_ts::CastOp::areCastCompatible(TypeRange inputs, TypeRange outputs)
     return true;
 }
 
+namespace
+{
+// literal types keep type of value as element type
+mlir::Type getValueType(mlir::Type type)
+{
+    if (auto literalType = type.dyn_cast<mlir_ts::LiteralType>())
+    {
+        return literalType.getElementType();
+    }
+
+    return type;
+}
+
+bool isUnsignedInteger(mlir::Type type)
+{
+    auto intType = type.dyn_cast<mlir::IntegerType>();
+    return intType && intType.isUnsigned();
+}
+
+// true if value survives round trip "from -> to -> from"
+bool isLosslessCast(mlir::Type from, mlir::Type to)
+{
+    auto fromIntType = from.dyn_cast<mlir::IntegerType>();
+    if (!fromIntType)
+    {
+        return false;
+    }
+
+    if (auto toIntType = to.dyn_cast<mlir::IntegerType>())
+    {
+        return toIntType.getWidth() > fromIntType.getWidth();
+    }
+
+    if (to.isa<mlir_ts::NumberType>())
+    {
+#ifdef NUMBER_F64
+        return fromIntType.getWidth() <= 32;
+#else
+        return fromIntType.getWidth() <= 16;
+#endif
+    }
+
+    return false;
+}
+
+mlir::Attribute getNumberAttr(mlir::MLIRContext *context, double value)
+{
+    mlir::OpBuilder builder(context);
+#ifdef NUMBER_F64
+    return builder.getF64FloatAttr(value);
+#else
+    return builder.getF32FloatAttr(static_cast<float>(value));
+#endif
+}
+} // end anonymous namespace.
+
+OpFoldResult mlir_ts::CastOp::fold(FoldAdaptor adaptor)
+{
+    auto in = getIn();
+    auto resType = getType();
+    if (in.getType() == resType)
+    {
+        return in;
+    }
+
+    if (auto attr = adaptor.getIn())
+    {
+        // literal constant to type of literal
+        auto inValueType = getValueType(in.getType());
+        if (inValueType == resType && (attr.isa<mlir::IntegerAttr>() || attr.isa<mlir::FloatAttr>() ||
+                                       attr.isa<mlir::StringAttr>() || attr.isa<mlir::BoolAttr>()))
+        {
+            return attr;
+        }
+
+        if (resType.isa<mlir_ts::NumberType>() && inValueType.isa<mlir::IntegerType>())
+        {
+            if (auto intAttr = attr.dyn_cast<mlir::IntegerAttr>())
+            {
+                auto value = isUnsignedInteger(inValueType) ? intAttr.getValue().roundToDouble(false)
+                                                            : intAttr.getValue().signedRoundToDouble();
+                return getNumberAttr(getContext(), value);
+            }
+        }
+    }
+
+    // remove chain of casts: i32 -> number -> i32
+    if (auto inCastOp = in.getDefiningOp<mlir_ts::CastOp>())
+    {
+        auto src = inCastOp.getIn();
+        if (src.getType() == resType && isLosslessCast(resType, in.getType()))
+        {
+            return src;
+        }
+    }
+
+    return {};
+}
+
+//===----------------------------------------------------------------------===//
+// ArithmeticUnaryOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult mlir_ts::ArithmeticUnaryOp::fold(FoldAdaptor adaptor)
+{
+    auto opCode = (SyntaxKind)getOpCode();
+    if (opCode == SyntaxKind::PlusToken && getOperand1().getType() == getType())
+    {
+        return getOperand1();
+    }
+
+    auto attr = adaptor.getOperand1();
+    if (!attr || getValueType(getOperand1().getType()) != getType())
+    {
+        return {};
+    }
+
+    if (auto boolAttr = attr.dyn_cast<mlir::BoolAttr>())
+    {
+        if (opCode == SyntaxKind::ExclamationToken)
+        {
+            return mlir::BoolAttr::get(getContext(), !boolAttr.getValue());
+        }
+
+        return {};
+    }
+
+    if (auto intAttr = attr.dyn_cast<mlir::IntegerAttr>())
+    {
+        switch (opCode)
+        {
+        case SyntaxKind::MinusToken:
+            return mlir::IntegerAttr::get(intAttr.getType(), -intAttr.getValue());
+        case SyntaxKind::TildeToken:
+            return mlir::IntegerAttr::get(intAttr.getType(), ~intAttr.getValue());
+        default:
+            return {};
+        }
+    }
+
+    if (auto floatAttr = attr.dyn_cast<mlir::FloatAttr>())
+    {
+        if (opCode == SyntaxKind::MinusToken)
+        {
+            return mlir::FloatAttr::get(floatAttr.getType(), llvm::neg(floatAttr.getValue()));
+        }
+    }
+
+    return {};
+}
+
+//===----------------------------------------------------------------------===//
+// ArithmeticBinaryOp
+//===----------------------------------------------------------------------===//
+
+Speculation::Speculatability mlir_ts::ArithmeticBinaryOp::getSpeculatability()
+{
+    switch ((SyntaxKind)getOpCode())
+    {
+    case SyntaxKind::SlashToken:
+    case SyntaxKind::PercentToken:
+        return getType().isa<mlir::IntegerType>() ? Speculation::NotSpeculatable : Speculation::Speculatable;
+    default:
+        return Speculation::Speculatable;
+    }
+}
+
+OpFoldResult mlir_ts::ArithmeticBinaryOp::fold(FoldAdaptor adaptor)
+{
+    auto opCode = (SyntaxKind)getOpCode();
+    auto resultType = getValueType(getType());
+    auto lhs = adaptor.getOperand1();
+    auto rhs = adaptor.getOperand2();
+
+    // x + 0, x * 1 etc.
+    if (!lhs && rhs && getOperand1().getType() == getType())
+    {
+        if (auto rhsInt = rhs.dyn_cast<mlir::IntegerAttr>())
+        {
+            auto value = rhsInt.getValue();
+            switch (opCode)
+            {
+            case SyntaxKind::PlusToken:
+            case SyntaxKind::MinusToken:
+            case SyntaxKind::BarToken:
+            case SyntaxKind::CaretToken:
+            case SyntaxKind::LessThanLessThanToken:
+            case SyntaxKind::GreaterThanGreaterThanToken:
+            case SyntaxKind::GreaterThanGreaterThanGreaterThanToken:
+                if (value.isZero())
+                {
+                    return getOperand1();
+                }
+
+                break;
+            case SyntaxKind::AsteriskToken:
+            case SyntaxKind::SlashToken:
+                if (value.isOne())
+                {
+                    return getOperand1();
+                }
+
+                break;
+            default:
+                break;
+            }
+        }
+        else if (auto rhsFloat = rhs.dyn_cast<mlir::FloatAttr>())
+        {
+            // x + 0.0 is not x for x = -0.0
+            auto value = rhsFloat.getValue();
+            switch (opCode)
+            {
+            case SyntaxKind::MinusToken:
+                if (value.isPosZero())
+                {
+                    return getOperand1();
+                }
+
+                break;
+            case SyntaxKind::AsteriskToken:
+            case SyntaxKind::SlashToken:
+                if (value.isExactlyValue(1.0))
+                {
+                    return getOperand1();
+                }
+
+                break;
+            default:
+                break;
+            }
+        }
+
+        return {};
+    }
+
+    if (!lhs || !rhs)
+    {
+        return {};
+    }
+
+    // string concat of constants
+    auto lhsStr = lhs.dyn_cast<mlir::StringAttr>();
+    auto rhsStr = rhs.dyn_cast<mlir::StringAttr>();
+    if (lhsStr && rhsStr)
+    {
+        if (opCode == SyntaxKind::PlusToken && resultType.isa<mlir_ts::StringType>())
+        {
+            return mlir::StringAttr::get(getContext(), llvm::Twine(lhsStr.getValue()) + rhsStr.getValue());
+        }
+
+        return {};
+    }
+
+    auto lhsInt = lhs.dyn_cast<mlir::IntegerAttr>();
+    auto rhsInt = rhs.dyn_cast<mlir::IntegerAttr>();
+    if (lhsInt && rhsInt && lhsInt.getType() == resultType && rhsInt.getType() == resultType)
+    {
+        auto isUnsigned = isUnsignedInteger(resultType);
+        auto left = lhsInt.getValue();
+        auto right = rhsInt.getValue();
+        auto width = left.getBitWidth();
+        std::optional<APInt> result;
+        switch (opCode)
+        {
+        case SyntaxKind::PlusToken:
+            result = left + right;
+            break;
+        case SyntaxKind::MinusToken:
+            result = left - right;
+            break;
+        case SyntaxKind::AsteriskToken:
+            result = left * right;
+            break;
+        case SyntaxKind::SlashToken:
+            // keep division by zero for runtime
+            if (!right.isZero())
+            {
+                result = isUnsigned ? left.udiv(right) : left.sdiv(right);
+            }
+
+            break;
+        case SyntaxKind::PercentToken:
+            if (!right.isZero())
+            {
+                result = isUnsigned ? left.urem(right) : left.srem(right);
+            }
+
+            break;
+        case SyntaxKind::AmpersandToken:
+            result = left & right;
+            break;
+        case SyntaxKind::BarToken:
+            result = left | right;
+            break;
+        case SyntaxKind::CaretToken:
+            result = left ^ right;
+            break;
+        case SyntaxKind::LessThanLessThanToken:
+            if (right.ult(width))
+            {
+                result = left.shl(right);
+            }
+
+            break;
+        case SyntaxKind::GreaterThanGreaterThanToken:
+            if (right.ult(width))
+            {
+                result = isUnsigned ? left.lshr(right) : left.ashr(right);
+            }
+
+            break;
+        case SyntaxKind::GreaterThanGreaterThanGreaterThanToken:
+            if (right.ult(width))
+            {
+                result = left.lshr(right);
+            }
+
+            break;
+        default:
+            break;
+        }
+
+        if (result)
+        {
+            return mlir::IntegerAttr::get(lhsInt.getType(), *result);
+        }
+
+        return {};
+    }
+
+    auto lhsFloat = lhs.dyn_cast<mlir::FloatAttr>();
+    auto rhsFloat = rhs.dyn_cast<mlir::FloatAttr>();
+    if (lhsFloat && rhsFloat && lhsFloat.getType() == rhsFloat.getType() &&
+        (resultType.isa<mlir_ts::NumberType>() || resultType == lhsFloat.getType()))
+    {
+        auto result = lhsFloat.getValue();
+        auto right = rhsFloat.getValue();
+        switch (opCode)
+        {
+        case SyntaxKind::PlusToken:
+            result.add(right, APFloat::rmNearestTiesToEven);
+            break;
+        case SyntaxKind::MinusToken:
+            result.subtract(right, APFloat::rmNearestTiesToEven);
+            break;
+        case SyntaxKind::AsteriskToken:
+            result.multiply(right, APFloat::rmNearestTiesToEven);
+            break;
+        case SyntaxKind::SlashToken:
+            result.divide(right, APFloat::rmNearestTiesToEven);
+            break;
+        case SyntaxKind::PercentToken:
+            // same as fmod
+            result.mod(right);
+            break;
+        default:
+            return {};
+        }
+
+        return mlir::FloatAttr::get(lhsFloat.getType(), result);
+    }
+
+    return {};
+}
+
+//===----------------------------------------------------------------------===//
+// LogicalBinaryOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult mlir_ts::LogicalBinaryOp::fold(FoldAdaptor adaptor)
+{
+    auto lhs = adaptor.getOperand1();
+    auto rhs = adaptor.getOperand2();
+    if (!lhs || !rhs)
+    {
+        return {};
+    }
+
+    auto opCode = (SyntaxKind)getOpCode();
+    auto isEquality = opCode == SyntaxKind::EqualsEqualsToken || opCode == SyntaxKind::EqualsEqualsEqualsToken;
+    auto isInequality =
+        opCode == SyntaxKind::ExclamationEqualsToken || opCode == SyntaxKind::ExclamationEqualsEqualsToken;
+
+    std::optional<bool> result;
+    if (getValueType(getOperand1().getType()) != getValueType(getOperand2().getType()))
+    {
+        // comparing values of different types needs cast logic
+    }
+    else if (auto lhsStr = lhs.dyn_cast<mlir::StringAttr>())
+    {
+        auto rhsStr = rhs.dyn_cast<mlir::StringAttr>();
+        if (rhsStr && (isEquality || isInequality))
+        {
+            result = (lhsStr.getValue() == rhsStr.getValue()) == isEquality;
+        }
+    }
+    else if (auto lhsBool = lhs.dyn_cast<mlir::BoolAttr>())
+    {
+        auto rhsBool = rhs.dyn_cast<mlir::BoolAttr>();
+        if (rhsBool && (isEquality || isInequality))
+        {
+            result = (lhsBool.getValue() == rhsBool.getValue()) == isEquality;
+        }
+    }
+    else if (auto lhsInt = lhs.dyn_cast<mlir::IntegerAttr>())
+    {
+        auto rhsInt = rhs.dyn_cast<mlir::IntegerAttr>();
+        if (!rhsInt || rhsInt.getType() != lhsInt.getType())
+        {
+            return {};
+        }
+
+        auto left = lhsInt.getValue();
+        auto right = rhsInt.getValue();
+        // signed predicates are used for all integers in lowering
+        switch (opCode)
+        {
+        case SyntaxKind::EqualsEqualsToken:
+        case SyntaxKind::EqualsEqualsEqualsToken:
+            result = left == right;
+            break;
+        case SyntaxKind::ExclamationEqualsToken:
+        case SyntaxKind::ExclamationEqualsEqualsToken:
+            result = left != right;
+            break;
+        case SyntaxKind::GreaterThanToken:
+            result = left.sgt(right);
+            break;
+        case SyntaxKind::GreaterThanEqualsToken:
+            result = left.sge(right);
+            break;
+        case SyntaxKind::LessThanToken:
+            result = left.slt(right);
+            break;
+        case SyntaxKind::LessThanEqualsToken:
+            result = left.sle(right);
+            break;
+        default:
+            break;
+        }
+    }
+    else if (auto lhsFloat = lhs.dyn_cast<mlir::FloatAttr>())
+    {
+        auto rhsFloat = rhs.dyn_cast<mlir::FloatAttr>();
+        if (!rhsFloat || rhsFloat.getType() != lhsFloat.getType())
+        {
+            return {};
+        }
+
+        // ordered predicates, any comparison with NaN is false
+        auto cmp = lhsFloat.getValue().compare(rhsFloat.getValue());
+        switch (opCode)
+        {
+        case SyntaxKind::EqualsEqualsToken:
+        case SyntaxKind::EqualsEqualsEqualsToken:
+            result = cmp == APFloat::cmpEqual;
+            break;
+        case SyntaxKind::ExclamationEqualsToken:
+        case SyntaxKind::ExclamationEqualsEqualsToken:
+            result = cmp == APFloat::cmpLessThan || cmp == APFloat::cmpGreaterThan;
+            break;
+        case SyntaxKind::GreaterThanToken:
+            result = cmp == APFloat::cmpGreaterThan;
+            break;
+        case SyntaxKind::GreaterThanEqualsToken:
+            result = cmp == APFloat::cmpGreaterThan || cmp == APFloat::cmpEqual;
+            break;
+        case SyntaxKind::LessThanToken:
+            result = cmp == APFloat::cmpLessThan;
+            break;
+        case SyntaxKind::LessThanEqualsToken:
+            result = cmp == APFloat::cmpLessThan || cmp == APFloat::cmpEqual;
+            break;
+        default:
+            break;
+        }
+    }
+
+    if (result)
+    {
+        return mlir::BoolAttr::get(getContext(), *result);
+    }
+
+    return {};
+}
+
+//===----------------------------------------------------------------------===//
+// StringConcatOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult mlir_ts::StringConcatOp::fold(FoldAdaptor adaptor)
+{
+    std::string result;
+    for (auto attr : adaptor.getOps())
+    {
+        auto strAttr = attr.dyn_cast_or_null<mlir::StringAttr>();
+        if (!strAttr)
+        {
+            return {};
+        }
+
+        result += strAttr.getValue();
+    }
+
+    return mlir::StringAttr::get(getContext(), result);
+}
+
+namespace
+{
+// joins neighbouring literals of concat at compile time, e.g. "a" + "b" + x + "c" + "" => "ab" + x + "c"
+struct MergeConstantConcatOperands : public OpRewritePattern<mlir_ts::StringConcatOp>
+{
+    using OpRewritePattern<mlir_ts::StringConcatOp>::OpRewritePattern;
+
+    LogicalResult matchAndRewrite(mlir_ts::StringConcatOp concatOp, PatternRewriter &rewriter) const override
+    {
+        SmallVector<mlir::Value> operands;
+        std::string literal;
+        auto hasLiteral = false;
+        auto changed = false;
+
+        auto flushLiteral = [&](mlir::Value literalOperand) {
+            if (!hasLiteral)
+            {
+                return;
+            }
+
+            if (literalOperand)
+            {
+                operands.push_back(literalOperand);
+            }
+            else if (!literal.empty())
+            {
+                operands.push_back(rewriter.create<mlir_ts::ConstantOp>(
+                    concatOp.getLoc(), concatOp.getType(), rewriter.getStringAttr(literal)));
+            }
+
+            literal.clear();
+            hasLiteral = false;
+        };
+
+        mlir::Value lastLiteralOperand;
+        for (auto operand : concatOp.getOps())
+        {
+            mlir::StringAttr strAttr;
+            if (!matchPattern(operand, m_Constant(&strAttr)))
+            {
+                flushLiteral(lastLiteralOperand);
+                operands.push_back(operand);
+                continue;
+            }
+
+            if (strAttr.getValue().empty())
+            {
+                changed = true;
+                continue;
+            }
+
+            // keep the original operand when the literal is not joined with others
+            changed |= hasLiteral;
+            lastLiteralOperand = hasLiteral ? mlir::Value() : operand;
+            literal += strAttr.getValue();
+            hasLiteral = true;
+        }
+
+        flushLiteral(lastLiteralOperand);
+
+        if (!changed)
+        {
+            return failure();
+        }
+
+        if (operands.empty())
+        {
+            rewriter.replaceOpWithNewOp<mlir_ts::ConstantOp>(concatOp, concatOp.getType(), rewriter.getStringAttr(""));
+            return success();
+        }
+
+        rewriter.replaceOpWithNewOp<mlir_ts::StringConcatOp>(concatOp, concatOp.getType(), operands,
+                                                             concatOp.getAllocInStackAttr());
+        return success();
+    }
+};
+} // end anonymous namespace.
+
+void mlir_ts::StringConcatOp::getCanonicalizationPatterns(RewritePatternSet &results, MLIRContext *context)
+{
+    results.insert<MergeConstantConcatOperands>(context);
+}
+
+//===----------------------------------------------------------------------===//
+// StringLengthOp
+//===----------------------------------------------------------------------===//
+
+OpFoldResult mlir_ts::StringLengthOp::fold(FoldAdaptor adaptor)
+{
+    // length of literal is size of its UTF-8 storage, the same as strlen returns at runtime
+    if (auto strAttr = adaptor.getOp().dyn_cast_or_null<mlir::StringAttr>())
+    {
+        return IntegerAttr::get(getType(), strAttr.getValue().take_until([](char c) { return c == '\0'; }).size());
+    }
+
+    return {};
+}
+
+//===----------------------------------------------------------------------===//
+// TypeOfOp
+//===----------------------------------------------------------------------===//
+
+namespace
+{
+// the same names as TypeOfOpHelper::typeOfLogic returns for types which do not need runtime check
+std::string getStaticTypeOf(mlir::Type type)
+{
+    if (auto literalType = type.dyn_cast<mlir_ts::LiteralType>())
+    {
+        return getStaticTypeOf(literalType.getElementType());
+    }
+
+    if (type.isIntOrIndex() && !type.isIndex())
+    {
+        return "i" + std::to_string(type.getIntOrFloatBitWidth());
+    }
+
+    if (type.isIntOrFloat() && !type.isIntOrIndex())
+    {
+        return "f" + std::to_string(type.getIntOrFloatBitWidth());
+    }
+
+    if (type.isa<mlir_ts::BooleanType>())
+    {
+        return "boolean";
+    }
+
+    if (type.isa<mlir_ts::NumberType>())
+    {
+        return "number";
+    }
+
+    if (type.isa<mlir_ts::StringType>())
+    {
+        return "string";
+    }
+
+    if (type.isa<mlir_ts::ArrayType>() || type.isa<mlir_ts::ConstArrayType>())
+    {
+        return "array";
+    }
+
+    if (type.isa<mlir_ts::FunctionType>() || type.isa<mlir_ts::HybridFunctionType>() ||
+        type.isa<mlir_ts::BoundFunctionType>())
+    {
+        return "function";
+    }
+
+    if (type.isa<mlir_ts::SymbolType>())
+    {
+        return "symbol";
+    }
+
+    if (type.isa<mlir_ts::UndefinedType>())
+    {
+        return UNDEFINED_NAME;
+    }
+
+    if (type.isa<mlir_ts::NullType>())
+    {
+        return "null";
+    }
+
+    return std::string();
+}
+} // end anonymous namespace.
+
+OpFoldResult mlir_ts::TypeOfOp::fold(FoldAdaptor adaptor)
+{
+    auto typeOf = getStaticTypeOf(getValue().getType());
+    if (typeOf.empty())
+    {
+        return {};
+    }
+
+    return mlir::StringAttr::get(getContext(), typeOf);
+}
+
 //===----------------------------------------------------------------------===//
 // DialectCastOp
 //===----------------------------------------------------------------------===//
@@ -0,0 +1,3 @@
+// Array kernels of executables, the same code as in shared runtime without export of symbols for JIT
+#define ARRAYRUNTIME_NO_EXPORT
+#include "../TypeScriptRuntime/ArrayRuntime.cpp"
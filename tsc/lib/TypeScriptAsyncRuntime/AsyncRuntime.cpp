@@ -28,8 +28,7 @@
 #include <thread>
 #include <vector>
 
-#include "llvm/ADT/StringMap.h"
-#include "llvm/Support/ThreadPool.h"
+#include "TypeScript/WorkStealingThreadPool.h"
 
 using namespace mlir::runtime;
 
@@ -70,7 +69,7 @@ namespace
             return numRefCountedObjects.load(std::memory_order_relaxed);
         }
 
-        llvm::ThreadPool &getThreadPool()
+        WorkStealingThreadPool &getThreadPool()
         {
             return threadPool;
         }
@@ -90,7 +89,7 @@ namespace
         }
 
         std::atomic<int64_t> numRefCountedObjects;
-        llvm::ThreadPool threadPool;
+        WorkStealingThreadPool threadPool;
     };
 
     // -------------------------------------------------------------------------- //
@@ -232,10 +231,8 @@ struct AsyncToken : public RefCounted
 
     std::atomic<State::StateEnum> state;
 
-    // Pending awaiters are guarded by a mutex.
-    std::mutex mu;
-    std::condition_variable cv;
-    std::vector<std::function<void()>> awaiters;
+    // Pending awaiters, run by the thread which emplaces the token.
+    AwaiterList awaiters;
 };
 
 // Async value provides a mechanism to access the result of asynchronous
@@ -254,10 +251,8 @@ struct AsyncValue : public RefCounted
     // Use vector of bytes to store async value payload.
     std::vector<std::byte> storage;
 
-    // Pending awaiters are guarded by a mutex.
-    std::mutex mu;
-    std::condition_variable cv;
-    std::vector<std::function<void()>> awaiters;
+    // Pending awaiters, run by the thread which emplaces the value.
+    AwaiterList awaiters;
 };
 
 // Async group provides a mechanism to group together multiple async tokens or
@@ -314,11 +309,22 @@ extern "C" AsyncGroup *mlirAsyncRuntimeCreateGroup(int64_t size)
     return group;
 }
 
-extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token, AsyncGroup *group)
+// Switches `async.group` to completed state and runs all awaiters outside of the lock.
+static void runGroupAwaiters(AsyncGroup *group)
 {
-    std::unique_lock<std::mutex> lockToken(token->mu);
-    std::unique_lock<std::mutex> lockGroup(group->mu);
+    std::vector<std::function<void()>> awaiters;
+    {
+        std::unique_lock<std::mutex> lockGroup(group->mu);
+        group->cv.notify_all();
+        awaiters.swap(group->awaiters);
+    }
 
+    for (auto &awaiter : awaiters)
+        awaiter();
+}
+
+extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token, AsyncGroup *group)
+{
     // Get the rank of the token inside the group before we drop the reference.
     int rank = group->rank.fetch_add(1);
 
@@ -328,7 +334,7 @@ extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token, AsyncGroup
     auto onTokenReady = [group, token]()
     {
         // Increment the number of errors in the group.
-        if (State(token->state).isError())
+        if (State(token->state.load(std::memory_order_acquire)).isError())
             group->numErrors.fetch_add(1);
 
         // If pending tokens go below zero it means that more tokens than the group
@@ -337,14 +343,10 @@ extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token, AsyncGroup
 
         // Run all group awaiters if it was the last token in the group.
         if (group->pendingTokens.fetch_sub(1) == 1)
-        {
-            group->cv.notify_all();
-            for (auto &awaiter : group->awaiters)
-                awaiter();
-        }
+            runGroupAwaiters(group);
     };
 
-    if (State(token->state).isAvailableOrError())
+    if (State(token->state.load(std::memory_order_acquire)).isAvailableOrError())
     {
         // Update group pending tokens immediately and maybe run awaiters.
         onTokenReady();
@@ -353,16 +355,12 @@ extern "C" int64_t mlirAsyncRuntimeAddTokenToGroup(AsyncToken *token, AsyncGroup
     {
         // Update group pending tokens when token will become ready. Because this
         // will happen asynchronously we must ensure that `group` is alive until
-        // then, and re-ackquire the lock.
+        // then. If token became ready in between, awaiter is run inline.
         group->addRef();
 
-        token->awaiters.emplace_back([group, onTokenReady]()
-                                        {
-    // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-    {
-        std::unique_lock<std::mutex> lockGroup(group->mu);
-        onTokenReady();
-    }
+        token->awaiters.addOrRun([group, onTokenReady]()
+                                 {
+    onTokenReady();
     group->dropRef(); });
     }
 
@@ -376,14 +374,9 @@ static void setTokenState(AsyncToken *token, State state)
     assert(state.isAvailableOrError() && "must be terminal state");
     assert(State(token->state).isUnavailable() && "token must be unavailable");
 
-    // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-    {
-        std::unique_lock<std::mutex> lock(token->mu);
-        token->state = state;
-        token->cv.notify_all();
-        for (auto &awaiter : token->awaiters)
-            awaiter();
-    }
+    // Continuations are run inline on the completing thread.
+    token->state.store(state, std::memory_order_release);
+    token->awaiters.closeAndRun();
 
     // Async tokens created with a ref count `2` to keep token alive until the
     // async task completes. Drop this reference explicitly when token emplaced.
@@ -395,20 +388,51 @@ static void setValueState(AsyncValue *value, State state)
     assert(state.isAvailableOrError() && "must be terminal state");
     assert(State(value->state).isUnavailable() && "value must be unavailable");
 
-    // Make sure that `dropRef` does not destroy the mutex owned by the lock.
-    {
-        std::unique_lock<std::mutex> lock(value->mu);
-        value->state = state;
-        value->cv.notify_all();
-        for (auto &awaiter : value->awaiters)
-            awaiter();
-    }
+    // Continuations are run inline on the completing thread.
+    value->state.store(state, std::memory_order_release);
+    value->awaiters.closeAndRun();
 
     // Async values created with a ref count `2` to keep value alive until the
     // async task completes. Drop this reference explicitly when value emplaced.
     value->dropRef();
 }
 
+// Blocks the current thread until `isReady` is true. Worker threads of the runtime
+// execute other pending tasks while waiting, so the awaited task can't be starved
+// by the thread waiting for it.
+template <typename IsReady, typename AddAwaiter>
+static void blockingAwait(IsReady isReady, AddAwaiter addAwaiter)
+{
+    if (isReady())
+        return;
+
+    auto &threadPool = getDefaultAsyncRuntime()->getThreadPool();
+    if (threadPool.isWorkerThread())
+    {
+        while (!isReady() && threadPool.runPendingTask())
+        {
+        }
+
+        if (isReady())
+            return;
+    }
+
+    std::mutex mu;
+    std::condition_variable cv;
+    bool ready = false;
+
+    addAwaiter([&]()
+               {
+    // notify under the lock, waiter can destroy `cv` as soon as it sees `ready`
+    std::unique_lock<std::mutex> lock(mu);
+    ready = true;
+    cv.notify_all(); });
+
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [&]
+            { return ready; });
+}
+
 extern "C" void mlirAsyncRuntimeEmplaceToken(AsyncToken *token)
 {
     setTokenState(token, State::kAvailable);
@@ -431,12 +455,12 @@ extern "C" void mlirAsyncRuntimeSetValueError(AsyncValue *value)
 
 extern "C" bool mlirAsyncRuntimeIsTokenError(AsyncToken *token)
 {
-    return State(token->state).isError();
+    return State(token->state.load(std::memory_order_acquire)).isError();
 }
 
 extern "C" bool mlirAsyncRuntimeIsValueError(AsyncValue *value)
 {
-    return State(value->state).isError();
+    return State(value->state.load(std::memory_order_acquire)).isError();
 }
 
 extern "C" bool mlirAsyncRuntimeIsGroupError(AsyncGroup *group)
@@ -446,26 +470,36 @@ extern "C" bool mlirAsyncRuntimeIsGroupError(AsyncGroup *group)
 
 extern "C" void mlirAsyncRuntimeAwaitToken(AsyncToken *token)
 {
-    std::unique_lock<std::mutex> lock(token->mu);
-    if (!State(token->state).isAvailableOrError())
-        token->cv.wait(lock, [token]
-                        { return State(token->state).isAvailableOrError(); });
+    blockingAwait([token]
+                  { return State(token->state.load(std::memory_order_acquire)).isAvailableOrError(); },
+                  [token](std::function<void()> awaiter)
+                  { token->awaiters.addOrRun(std::move(awaiter)); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValue(AsyncValue *value)
 {
-    std::unique_lock<std::mutex> lock(value->mu);
-    if (!State(value->state).isAvailableOrError())
-        value->cv.wait(lock, [value]
-                        { return State(value->state).isAvailableOrError(); });
+    blockingAwait([value]
+                  { return State(value->state.load(std::memory_order_acquire)).isAvailableOrError(); },
+                  [value](std::function<void()> awaiter)
+                  { value->awaiters.addOrRun(std::move(awaiter)); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroup(AsyncGroup *group)
 {
-    std::unique_lock<std::mutex> lock(group->mu);
-    if (group->pendingTokens != 0)
-        group->cv.wait(lock, [group]
-                        { return group->pendingTokens == 0; });
+    blockingAwait([group]
+                  { return group->pendingTokens.load() == 0; },
+                  [group](std::function<void()> awaiter)
+                  {
+        std::unique_lock<std::mutex> lock(group->mu);
+        if (group->pendingTokens == 0)
+        {
+            lock.unlock();
+            awaiter();
+        }
+        else
+        {
+            group->awaiters.emplace_back(std::move(awaiter));
+        } });
 }
 
 // Returns a pointer to the storage owned by the async value.
@@ -484,36 +518,16 @@ extern "C" void mlirAsyncRuntimeExecute(CoroHandle handle, CoroResume resume)
 
 extern "C" void mlirAsyncRuntimeAwaitTokenAndExecute(AsyncToken *token, CoroHandle handle, CoroResume resume)
 {
-    auto execute = [handle, resume]()
-    { (*resume)(handle); };
-    std::unique_lock<std::mutex> lock(token->mu);
-    if (State(token->state).isAvailableOrError())
-    {
-        lock.unlock();
-        execute();
-    }
-    else
-    {
-        token->awaiters.emplace_back([execute]()
-                                        { execute(); });
-    }
+    // Resumes the coroutine inline if the token is already available, otherwise on the thread which emplaces it.
+    token->awaiters.addOrRun([handle, resume]()
+                             { (*resume)(handle); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitValueAndExecute(AsyncValue *value, CoroHandle handle, CoroResume resume)
 {
-    auto execute = [handle, resume]()
-    { (*resume)(handle); };
-    std::unique_lock<std::mutex> lock(value->mu);
-    if (State(value->state).isAvailableOrError())
-    {
-        lock.unlock();
-        execute();
-    }
-    else
-    {
-        value->awaiters.emplace_back([execute]()
-                                        { execute(); });
-    }
+    // Resumes the coroutine inline if the value is already available, otherwise on the thread which emplaces it.
+    value->awaiters.addOrRun([handle, resume]()
+                             { (*resume)(handle); });
 }
 
 extern "C" void mlirAsyncRuntimeAwaitAllInGroupAndExecute(AsyncGroup *group, CoroHandle handle, CoroResume resume)
@@ -0,0 +1,107 @@
+//===----------------------------------------------------------------------===//
+// Dynamic library API used by executables (see LLVMLoadLibraryPermanently and
+// LLVMSearchForAddressOfSymbol from llvm-c/Support.h). It replaces LLVMSupport
+// in slim runtime, libraries are opened by dlopen/LoadLibrary and stay loaded
+// till the end of the process.
+//===----------------------------------------------------------------------===//
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include <mutex>
+#include <vector>
+
+namespace
+{
+
+#ifdef _WIN32
+using LibraryHandle = HMODULE;
+#else
+using LibraryHandle = void *;
+#endif
+
+class LoadedLibraries
+{
+  public:
+    bool load(const char *fileName)
+    {
+#ifdef _WIN32
+        auto handle = fileName ? LoadLibraryA(fileName) : GetModuleHandleA(nullptr);
+#else
+        auto handle = dlopen(fileName, RTLD_LAZY | RTLD_GLOBAL);
+#endif
+        if (!handle)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto loaded : handles)
+        {
+            if (loaded == handle)
+            {
+                return true;
+            }
+        }
+
+        handles.push_back(handle);
+        return true;
+    }
+
+    void *search(const char *symbolName)
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (auto handle : handles)
+            {
+                if (auto *address = getSymbol(handle, symbolName))
+                {
+                    return address;
+                }
+            }
+        }
+
+        // symbols of the executable and of libraries loaded with it
+#ifdef _WIN32
+        return getSymbol(GetModuleHandleA(nullptr), symbolName);
+#else
+        return getSymbol(RTLD_DEFAULT, symbolName);
+#endif
+    }
+
+  private:
+    static void *getSymbol(LibraryHandle handle, const char *symbolName)
+    {
+#ifdef _WIN32
+        return reinterpret_cast<void *>(GetProcAddress(handle, symbolName));
+#else
+        return dlsym(handle, symbolName);
+#endif
+    }
+
+    std::mutex mutex;
+    std::vector<LibraryHandle> handles;
+};
+
+LoadedLibraries &getLoadedLibraries()
+{
+    static LoadedLibraries libraries;
+    return libraries;
+}
+
+} // namespace
+
+// returns 1 (true) on error as LLVM C API does
+extern "C" int LLVMLoadLibraryPermanently(const char *fileName)
+{
+    return getLoadedLibraries().load(fileName) ? 0 : 1;
+}
+
+extern "C" void *LLVMSearchForAddressOfSymbol(const char *symbolName)
+{
+    return getLoadedLibraries().search(symbolName);
+}
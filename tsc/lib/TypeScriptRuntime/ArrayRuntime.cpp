@@ -0,0 +1,784 @@
+//===----------------------------------------------------------------------===//
+// Array runtime kernels used by lowering of Array methods (sort, indexOf,
+// includes, join). Arrays are passed as pointer to data and count of elements,
+// memory of results is allocated by the caller.
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#ifndef ARRAYRUNTIME_NO_EXPORT
+#include "llvm/ADT/StringMap.h"
+#endif
+
+namespace
+{
+
+//===----------------------------------------------------------------------===//
+// Pattern-defeating quicksort (O. Peters), used where stability of the order
+// is not observable: numbers and strings compared by value.
+//===----------------------------------------------------------------------===//
+
+namespace pdq
+{
+
+constexpr ptrdiff_t insertionSortThreshold = 24;
+constexpr ptrdiff_t nintherThreshold = 128;
+constexpr ptrdiff_t partialInsertionSortLimit = 8;
+
+template <typename T, typename Less> void insertionSort(T *begin, T *end, Less less)
+{
+    if (begin == end)
+    {
+        return;
+    }
+
+    for (auto *cur = begin + 1; cur != end; ++cur)
+    {
+        auto *sift = cur;
+        auto *siftPrev = cur - 1;
+        if (less(*sift, *siftPrev))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*siftPrev);
+            } while (sift != begin && less(tmp, *--siftPrev));
+
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// element before begin is not greater than any element of the range
+template <typename T, typename Less> void unguardedInsertionSort(T *begin, T *end, Less less)
+{
+    if (begin == end)
+    {
+        return;
+    }
+
+    for (auto *cur = begin + 1; cur != end; ++cur)
+    {
+        auto *sift = cur;
+        auto *siftPrev = cur - 1;
+        if (less(*sift, *siftPrev))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*siftPrev);
+            } while (less(tmp, *--siftPrev));
+
+            *sift = std::move(tmp);
+        }
+    }
+}
+
+// gives up when too many elements are moved, returns true if range is sorted
+template <typename T, typename Less> bool partialInsertionSort(T *begin, T *end, Less less)
+{
+    if (begin == end)
+    {
+        return true;
+    }
+
+    ptrdiff_t moved = 0;
+    for (auto *cur = begin + 1; cur != end; ++cur)
+    {
+        auto *sift = cur;
+        auto *siftPrev = cur - 1;
+        if (less(*sift, *siftPrev))
+        {
+            T tmp = std::move(*sift);
+            do
+            {
+                *sift-- = std::move(*siftPrev);
+            } while (sift != begin && less(tmp, *--siftPrev));
+
+            *sift = std::move(tmp);
+            moved += cur - sift;
+        }
+
+        if (moved > partialInsertionSortLimit)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+template <typename T, typename Less> void sort2(T *a, T *b, Less less)
+{
+    if (less(*b, *a))
+    {
+        std::iter_swap(a, b);
+    }
+}
+
+template <typename T, typename Less> void sort3(T *a, T *b, T *c, Less less)
+{
+    sort2(a, b, less);
+    sort2(b, c, less);
+    sort2(a, b, less);
+}
+
+// pivot is *begin, returns position of pivot and if the range was already partitioned
+template <typename T, typename Less> std::pair<T *, bool> partitionRight(T *begin, T *end, Less less)
+{
+    T pivot(std::move(*begin));
+    auto *first = begin;
+    auto *last = end;
+
+    // median of 3 guarantees element not less than pivot
+    while (less(*++first, pivot))
+        ;
+
+    if (first - 1 == begin)
+    {
+        while (first < last && !less(*--last, pivot))
+            ;
+    }
+    else
+    {
+        while (!less(*--last, pivot))
+            ;
+    }
+
+    auto alreadyPartitioned = first >= last;
+    while (first < last)
+    {
+        std::iter_swap(first, last);
+        while (less(*++first, pivot))
+            ;
+        while (!less(*--last, pivot))
+            ;
+    }
+
+    auto *pivotPos = first - 1;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return {pivotPos, alreadyPartitioned};
+}
+
+// elements equal to pivot go to the left part, used for ranges with many equal elements
+template <typename T, typename Less> T *partitionLeft(T *begin, T *end, Less less)
+{
+    T pivot(std::move(*begin));
+    auto *first = begin;
+    auto *last = end;
+
+    while (less(pivot, *--last))
+        ;
+
+    if (last + 1 == end)
+    {
+        while (first < last && !less(pivot, *++first))
+            ;
+    }
+    else
+    {
+        while (!less(pivot, *++first))
+            ;
+    }
+
+    while (first < last)
+    {
+        std::iter_swap(first, last);
+        while (less(pivot, *--last))
+            ;
+        while (!less(pivot, *++first))
+            ;
+    }
+
+    auto *pivotPos = last;
+    *begin = std::move(*pivotPos);
+    *pivotPos = std::move(pivot);
+    return pivotPos;
+}
+
+template <typename T> void breakPatterns(T *begin, T *end)
+{
+    auto size = end - begin;
+    if (size < insertionSortThreshold)
+    {
+        return;
+    }
+
+    auto quarter = size / 4;
+    std::iter_swap(begin, begin + quarter);
+    std::iter_swap(end - 1, end - quarter);
+    if (size > nintherThreshold)
+    {
+        std::iter_swap(begin + 1, begin + (quarter + 1));
+        std::iter_swap(begin + 2, begin + (quarter + 2));
+        std::iter_swap(end - 2, end - (quarter + 1));
+        std::iter_swap(end - 3, end - (quarter + 2));
+    }
+}
+
+template <typename T, typename Less> void sortLoop(T *begin, T *end, Less less, int badAllowed, bool leftmost)
+{
+    while (true)
+    {
+        auto size = end - begin;
+        if (size < insertionSortThreshold)
+        {
+            if (leftmost)
+            {
+                insertionSort(begin, end, less);
+            }
+            else
+            {
+                unguardedInsertionSort(begin, end, less);
+            }
+
+            return;
+        }
+
+        // pivot is moved to *begin
+        auto half = size / 2;
+        if (size > nintherThreshold)
+        {
+            sort3(begin, begin + half, end - 1, less);
+            sort3(begin + 1, begin + (half - 1), end - 2, less);
+            sort3(begin + 2, begin + (half + 1), end - 3, less);
+            sort3(begin + (half - 1), begin + half, begin + (half + 1), less);
+            std::iter_swap(begin, begin + half);
+        }
+        else
+        {
+            sort3(begin + half, begin, end - 1, less);
+        }
+
+        // pivot is equal to the pivot of the left neighbour, nothing to sort among equal elements
+        if (!leftmost && !less(*(begin - 1), *begin))
+        {
+            begin = partitionLeft(begin, end, less) + 1;
+            continue;
+        }
+
+        auto [pivotPos, alreadyPartitioned] = partitionRight(begin, end, less);
+
+        auto leftSize = pivotPos - begin;
+        auto rightSize = end - (pivotPos + 1);
+        if (leftSize < size / 8 || rightSize < size / 8)
+        {
+            if (--badAllowed == 0)
+            {
+                std::make_heap(begin, end, less);
+                std::sort_heap(begin, end, less);
+                return;
+            }
+
+            breakPatterns(begin, pivotPos);
+            breakPatterns(pivotPos + 1, end);
+        }
+        else if (alreadyPartitioned && partialInsertionSort(begin, pivotPos, less) &&
+                 partialInsertionSort(pivotPos + 1, end, less))
+        {
+            return;
+        }
+
+        sortLoop(begin, pivotPos, less, badAllowed, leftmost);
+        begin = pivotPos + 1;
+        leftmost = false;
+    }
+}
+
+template <typename T, typename Less> void sort(T *begin, T *end, Less less)
+{
+    if (end - begin < 2)
+    {
+        return;
+    }
+
+    auto badAllowed = 0;
+    for (auto size = end - begin; size > 1; size >>= 1)
+    {
+        badAllowed++;
+    }
+
+    sortLoop(begin, end, less, badAllowed, true);
+}
+
+} // namespace pdq
+
+// number as JS Number::toString does: the shortest digits which are read back as the same value, in fixed notation
+// for 1e-6 <= |value| < 1e21 and as "d.ddde+n" otherwise
+void formatNumber(double value, char (&buffer)[32])
+{
+    if (std::isnan(value))
+    {
+        std::strcpy(buffer, "NaN");
+        return;
+    }
+
+    if (std::isinf(value))
+    {
+        std::strcpy(buffer, value < 0 ? "-Infinity" : "Infinity");
+        return;
+    }
+
+    if (value == 0)
+    {
+        // -0 as well
+        std::strcpy(buffer, "0");
+        return;
+    }
+
+    // "d.ddde+xxx" with the least count of digits
+    char scientific[32];
+    for (auto precision = 0; precision <= 16; precision++)
+    {
+        std::snprintf(scientific, sizeof(scientific), "%.*e", precision, std::fabs(value));
+        if (std::strtod(scientific, nullptr) == std::fabs(value))
+        {
+            break;
+        }
+    }
+
+    // digits without point, value is 0.digits * 10^exponent
+    char digits[20];
+    auto count = 0;
+    auto *text = scientific;
+    for (; *text != 'e'; text++)
+    {
+        if (*text != '.')
+        {
+            digits[count++] = *text;
+        }
+    }
+
+    auto exponent = std::atoi(text + 1) + 1;
+
+    auto *out = buffer;
+    if (value < 0)
+    {
+        *out++ = '-';
+    }
+
+    if (count <= exponent && exponent <= 21)
+    {
+        // 123000
+        out = std::copy(digits, digits + count, out);
+        out = std::fill_n(out, exponent - count, '0');
+    }
+    else if (0 < exponent && exponent <= 21)
+    {
+        // 123.45
+        out = std::copy(digits, digits + exponent, out);
+        *out++ = '.';
+        out = std::copy(digits + exponent, digits + count, out);
+    }
+    else if (-6 < exponent && exponent <= 0)
+    {
+        // 0.00012
+        *out++ = '0';
+        *out++ = '.';
+        out = std::fill_n(out, -exponent, '0');
+        out = std::copy(digits, digits + count, out);
+    }
+    else
+    {
+        // 1.2e+21, 1e-7
+        *out++ = digits[0];
+        if (count > 1)
+        {
+            *out++ = '.';
+            out = std::copy(digits + 1, digits + count, out);
+        }
+
+        out += std::snprintf(out, buffer + sizeof(buffer) - out, "e%+d", exponent - 1);
+    }
+
+    *out = '\0';
+}
+
+// stable merge sort of pointers to elements for compare functions of TypeScript. Comparator can be inconsistent
+// (f.e. "() => Math.random() - 0.5"), and std::stable_sort reads out of range then, so here every index is bounded
+// by the loops and never by results of comparisons.
+template <typename P, typename Less> void mergeSort(P *items, int32_t count, Less less)
+{
+    constexpr int64_t runSize = 8;
+
+    // short runs by insertion sort
+    for (int64_t runStart = 0; runStart < count; runStart += runSize)
+    {
+        auto runEnd = std::min<int64_t>(runStart + runSize, count);
+        for (auto index = runStart + 1; index < runEnd; index++)
+        {
+            auto item = items[index];
+            auto position = index;
+            while (position > runStart && less(item, items[position - 1]))
+            {
+                items[position] = items[position - 1];
+                position--;
+            }
+
+            items[position] = item;
+        }
+    }
+
+    if (count <= runSize)
+    {
+        return;
+    }
+
+    std::unique_ptr<P[]> buffer(new P[count]);
+    auto *from = items;
+    auto *to = buffer.get();
+    for (int64_t width = runSize; width < count; width *= 2)
+    {
+        for (int64_t left = 0; left < count; left += 2 * width)
+        {
+            auto middle = std::min<int64_t>(left + width, count);
+            auto right = std::min<int64_t>(left + 2 * width, count);
+            auto leftIndex = left;
+            auto rightIndex = middle;
+            auto index = left;
+
+            // right item goes first only when it is less, so equal items keep their order
+            while (leftIndex < middle && rightIndex < right)
+            {
+                to[index++] = less(from[rightIndex], from[leftIndex]) ? from[rightIndex++] : from[leftIndex++];
+            }
+
+            while (leftIndex < middle)
+            {
+                to[index++] = from[leftIndex++];
+            }
+
+            while (rightIndex < right)
+            {
+                to[index++] = from[rightIndex++];
+            }
+        }
+
+        std::swap(from, to);
+    }
+
+    if (from != items)
+    {
+        std::copy(from, from + count, items);
+    }
+}
+
+struct NumberKey
+{
+    char text[32];
+    double value;
+};
+
+// values of 4 and 8 bytes (numbers, references) are moved as integers. Comparator can allocate and start
+// collection, and GC does not scan buffers of operator new, so elements stay in the array while they are compared:
+// pointers to them are sorted and elements are moved once after the last comparison.
+template <typename T> void sortByCompare(T *data, int32_t count, double (*compare)(void *, void *, void *),
+                                         void *context)
+{
+    std::unique_ptr<T *[]> items(new T *[count]);
+    for (auto index = 0; index < count; index++)
+    {
+        items[index] = data + index;
+    }
+
+    mergeSort(items.get(), count, [&](T *left, T *right) {
+        // NaN is "equal"
+        return compare(context, left, right) < 0;
+    });
+
+    std::unique_ptr<T[]> sorted(new T[count]);
+    for (auto index = 0; index < count; index++)
+    {
+        sorted[index] = *items[index];
+    }
+
+    std::copy(sorted.get(), sorted.get() + count, data);
+}
+
+// blocks of elements are tested without branches, so compiler can vectorize the test
+template <typename T, typename Match> int32_t findIndex(const T *data, int32_t count, int32_t fromIndex, Match match)
+{
+    constexpr int32_t blockSize = 16;
+
+    if (fromIndex < 0)
+    {
+        fromIndex = std::max(count + fromIndex, 0);
+    }
+
+    auto index = fromIndex;
+    for (; index + blockSize <= count; index += blockSize)
+    {
+        auto found = false;
+        for (auto offset = 0; offset < blockSize; offset++)
+        {
+            found |= match(data[index + offset]);
+        }
+
+        if (found)
+        {
+            break;
+        }
+    }
+
+    for (; index < count; index++)
+    {
+        if (match(data[index]))
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+bool equalStrings(const char *left, const char *right)
+{
+    if (left == right)
+    {
+        return true;
+    }
+
+    return left && right && std::strcmp(left, right) == 0;
+}
+
+} // namespace
+
+//===----------------------------------------------------------------------===//
+// Sort.
+//===----------------------------------------------------------------------===//
+
+// default order of Array.prototype.sort: numbers are compared as strings
+extern "C" void __ts_array_sort_number(double *data, int32_t count)
+{
+    if (count < 2)
+    {
+        return;
+    }
+
+    std::unique_ptr<NumberKey[]> keys(new NumberKey[count]);
+    for (auto index = 0; index < count; index++)
+    {
+        keys[index].value = data[index];
+        formatNumber(data[index], keys[index].text);
+    }
+
+    pdq::sort(keys.get(), keys.get() + count,
+              [](const NumberKey &left, const NumberKey &right) { return std::strcmp(left.text, right.text) < 0; });
+
+    for (auto index = 0; index < count; index++)
+    {
+        data[index] = keys[index].value;
+    }
+}
+
+// default order of Array.prototype.sort, UTF-8 bytes are compared instead of UTF-16 code units, order is the same
+// except characters above U+FFFF, undefined (null) strings are moved to the end
+extern "C" void __ts_array_sort_string(const char **data, int32_t count)
+{
+    pdq::sort(data, data + count, [](const char *left, const char *right) {
+        if (!left || !right)
+        {
+            return left && !right;
+        }
+
+        return std::strcmp(left, right) < 0;
+    });
+}
+
+// sort((a, b) => a - b) and sort((a, b) => b - a), NaN values are moved to the end
+extern "C" void __ts_array_sort_f64(double *data, int32_t count, int32_t descending)
+{
+    if (descending)
+    {
+        pdq::sort(data, data + count,
+                  [](double left, double right) { return left > right || (!std::isnan(left) && std::isnan(right)); });
+        return;
+    }
+
+    pdq::sort(data, data + count,
+              [](double left, double right) { return left < right || (!std::isnan(left) && std::isnan(right)); });
+}
+
+extern "C" void __ts_array_sort_i32(int32_t *data, int32_t count, int32_t descending)
+{
+    if (descending)
+    {
+        pdq::sort(data, data + count, [](int32_t left, int32_t right) { return left > right; });
+        return;
+    }
+
+    pdq::sort(data, data + count, [](int32_t left, int32_t right) { return left < right; });
+}
+
+// sort with compare function, compare(context, &a, &b) calls the TypeScript function. The sort must be stable
+// (ES2019) and comparator can see the difference, so merge sort is used here.
+extern "C" void __ts_array_sort_cmp(void *data, int32_t count, int32_t elementSize,
+                                    double (*compare)(void *, void *, void *), void *context)
+{
+    if (count < 2)
+    {
+        return;
+    }
+
+    switch (elementSize)
+    {
+    case 4:
+        sortByCompare(static_cast<uint32_t *>(data), count, compare, context);
+        return;
+    case 8:
+        sortByCompare(static_cast<uint64_t *>(data), count, compare, context);
+        return;
+    }
+
+    // values of other sizes (tuples) are sorted by pointers and moved once as well
+    auto *bytes = static_cast<char *>(data);
+    std::unique_ptr<char *[]> items(new char *[count]);
+    for (auto index = 0; index < count; index++)
+    {
+        items[index] = bytes + (size_t)index * elementSize;
+    }
+
+    mergeSort(items.get(), count, [&](char *left, char *right) { return compare(context, left, right) < 0; });
+
+    std::unique_ptr<char[]> sorted(new char[(size_t)count * elementSize]);
+    for (auto index = 0; index < count; index++)
+    {
+        std::memcpy(sorted.get() + (size_t)index * elementSize, items[index], elementSize);
+    }
+
+    std::memcpy(data, sorted.get(), (size_t)count * elementSize);
+}
+
+//===----------------------------------------------------------------------===//
+// indexOf / includes.
+//===----------------------------------------------------------------------===//
+
+// indexOf uses strict equality (NaN is not found), includes uses SameValueZero (NaN is found)
+extern "C" int32_t __ts_array_index_of_f64(const double *data, int32_t count, double value, int32_t fromIndex,
+                                           int32_t sameValueZero)
+{
+    if (std::isnan(value))
+    {
+        return sameValueZero ? findIndex(data, count, fromIndex, [](double item) { return item != item; }) : -1;
+    }
+
+    return findIndex(data, count, fromIndex, [=](double item) { return item == value; });
+}
+
+extern "C" int32_t __ts_array_index_of_i32(const int32_t *data, int32_t count, int32_t value, int32_t fromIndex)
+{
+    return findIndex(data, count, fromIndex, [=](int32_t item) { return item == value; });
+}
+
+// objects are compared by reference
+extern "C" int32_t __ts_array_index_of_ptr(const void *const *data, int32_t count, const void *value,
+                                           int32_t fromIndex)
+{
+    auto address = reinterpret_cast<uintptr_t>(value);
+    return findIndex(reinterpret_cast<const uintptr_t *>(data), count, fromIndex,
+                     [=](uintptr_t item) { return item == address; });
+}
+
+extern "C" int32_t __ts_array_index_of_string(const char *const *data, int32_t count, const char *value,
+                                              int32_t fromIndex)
+{
+    if (fromIndex < 0)
+    {
+        fromIndex = std::max(count + fromIndex, 0);
+    }
+
+    for (auto index = fromIndex; index < count; index++)
+    {
+        if (equalStrings(data[index], value))
+        {
+            return index;
+        }
+    }
+
+    return -1;
+}
+
+//===----------------------------------------------------------------------===//
+// join: caller allocates buffer of __ts_array_join_length bytes once and fills it by __ts_array_join_copy.
+//===----------------------------------------------------------------------===//
+
+// size in bytes including terminating zero, undefined (null) strings are empty
+extern "C" size_t __ts_array_join_length(const char *const *data, int32_t count, const char *separator)
+{
+    size_t length = 1;
+    if (count > 1 && separator)
+    {
+        length += std::strlen(separator) * (count - 1);
+    }
+
+    for (auto index = 0; index < count; index++)
+    {
+        if (data[index])
+        {
+            length += std::strlen(data[index]);
+        }
+    }
+
+    return length;
+}
+
+extern "C" void __ts_array_join_copy(char *dest, const char *const *data, int32_t count, const char *separator)
+{
+    auto separatorLength = separator ? std::strlen(separator) : 0;
+    for (auto index = 0; index < count; index++)
+    {
+        if (index > 0 && separatorLength > 0)
+        {
+            std::memcpy(dest, separator, separatorLength);
+            dest += separatorLength;
+        }
+
+        if (auto *item = data[index])
+        {
+            auto itemLength = std::strlen(item);
+            std::memcpy(dest, item, itemLength);
+            dest += itemLength;
+        }
+    }
+
+    *dest = '\0';
+}
+
+#ifndef ARRAYRUNTIME_NO_EXPORT
+
+//===----------------------------------------------------------------------===//
+// MLIR Runner (JitRunner) dynamic library integration.
+//===----------------------------------------------------------------------===//
+
+void init_arrayruntime(llvm::StringMap<void *> &exportSymbols)
+{
+    auto exportSymbol = [&](llvm::StringRef name, auto ptr) {
+        assert(exportSymbols.count(name) == 0 && "symbol already exists");
+        exportSymbols[name] = reinterpret_cast<void *>(ptr);
+    };
+
+    exportSymbol("__ts_array_sort_number", &__ts_array_sort_number);
+    exportSymbol("__ts_array_sort_string", &__ts_array_sort_string);
+    exportSymbol("__ts_array_sort_f64", &__ts_array_sort_f64);
+    exportSymbol("__ts_array_sort_i32", &__ts_array_sort_i32);
+    exportSymbol("__ts_array_sort_cmp", &__ts_array_sort_cmp);
+    exportSymbol("__ts_array_index_of_f64", &__ts_array_index_of_f64);
+    exportSymbol("__ts_array_index_of_i32", &__ts_array_index_of_i32);
+    exportSymbol("__ts_array_index_of_ptr", &__ts_array_index_of_ptr);
+    exportSymbol("__ts_array_index_of_string", &__ts_array_index_of_string);
+    exportSymbol("__ts_array_join_length", &__ts_array_join_length);
+    exportSymbol("__ts_array_join_copy", &__ts_array_join_copy);
+}
+
+#endif
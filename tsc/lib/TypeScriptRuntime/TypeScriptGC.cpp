@@ -20,6 +20,10 @@ void init_gcruntime(llvm::StringMap<void *> &exportSymbols)
     exportSymbol("GC_get_heap_size", &_mlir__GC_get_heap_size);
     exportSymbol("GC_malloc_explicitly_typed", &_mlir__GC_malloc_explicitly_typed);
     exportSymbol("GC_make_descriptor", &_mlir__GC_make_descriptor);
+    exportSymbol("GC_malloc_profiled", &_mlir__GC_malloc_profiled);
+    exportSymbol("GC_malloc_atomic_profiled", &_mlir__GC_malloc_atomic_profiled);
+    exportSymbol("GC_malloc_explicitly_typed_profiled", &_mlir__GC_malloc_explicitly_typed_profiled);
+    exportSymbol("GC_realloc_profiled", &_mlir__GC_realloc_profiled);
 }
 
 void destroy_gcruntime()
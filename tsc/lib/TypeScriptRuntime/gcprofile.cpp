@@ -0,0 +1,246 @@
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "TypeScript/gcwrapper.h"
+
+#ifndef NDEBUG
+#define GC_DEBUG
+#endif
+
+#define GC_INSIDE_DLL
+#define GC_NAMESPACE
+
+#if defined _WIN32 || defined _WIN64 || defined PLATFORM_ANDROID || defined __ANDROID__
+#define GC_NOT_DLL
+#endif
+
+#include "gc.h"
+
+// Allocation profile (tsc --alloc-profile):
+//  - GCPass calls *_profiled entry points with call site string ("<function> (<file>:<line>:<col>)") as last argument
+//  - realloc (growing arrays) is counted as allocation of the new size at its own site
+//  - every thread counts allocations in own buffer, keyed by address of the site string
+//  - summary of top sites, GC count, pause time and heap size is printed to stderr at exit
+
+namespace
+{
+
+enum class AllocKind
+{
+    Normal,
+    Atomic,
+    Typed,
+    Realloc
+};
+
+struct AllocSite
+{
+    const char *site;
+    AllocKind kind;
+    int64_t descr;
+    uint64_t count;
+    uint64_t bytes;
+};
+
+struct ThreadBuffer
+{
+    // locked only by owner thread and by printing at exit
+    std::mutex mutex;
+    std::unordered_map<const char *, AllocSite> sites;
+};
+
+class AllocProfile
+{
+  public:
+    static AllocProfile &get()
+    {
+        static AllocProfile allocProfile;
+        return allocProfile;
+    }
+
+    void record(const char *site, AllocKind kind, int64_t descr, size_t size)
+    {
+        auto &buffer = getThreadBuffer();
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        auto &allocSite = buffer.sites.try_emplace(site, AllocSite{site, kind, descr, 0, 0}).first->second;
+        allocSite.count++;
+        allocSite.bytes += size;
+    }
+
+    ~AllocProfile()
+    {
+        print();
+    }
+
+  private:
+    static const size_t topSites = 20;
+
+    AllocProfile()
+    {
+        GC_set_on_collection_event(onCollectionEvent);
+    }
+
+    ThreadBuffer &getThreadBuffer()
+    {
+        // buffers are owned by profile, so counters of finished threads are kept
+        thread_local ThreadBuffer *threadBuffer = nullptr;
+        if (!threadBuffer)
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffers.push_back(std::make_unique<ThreadBuffer>());
+            threadBuffer = buffers.back().get();
+        }
+
+        return *threadBuffer;
+    }
+
+    static void onCollectionEvent(GC_EventType eventType)
+    {
+        // collector stops the world from start to end of collection
+        static std::chrono::steady_clock::time_point start;
+        if (eventType == GC_EVENT_START)
+        {
+            start = std::chrono::steady_clock::now();
+        }
+        else if (eventType == GC_EVENT_END)
+        {
+            pauseTime += std::chrono::steady_clock::now() - start;
+        }
+    }
+
+    void print()
+    {
+        // sites of all threads are merged, the same site can be hit by many threads
+        std::unordered_map<const char *, AllocSite> merged;
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            for (auto &buffer : buffers)
+            {
+                std::lock_guard<std::mutex> bufferLock(buffer->mutex);
+                for (auto &item : buffer->sites)
+                {
+                    auto inserted = merged.try_emplace(item.first, item.second);
+                    if (!inserted.second)
+                    {
+                        inserted.first->second.count += item.second.count;
+                        inserted.first->second.bytes += item.second.bytes;
+                    }
+                }
+            }
+        }
+
+        std::vector<AllocSite> sites;
+        uint64_t totalCount = 0;
+        uint64_t totalBytes = 0;
+        for (auto &item : merged)
+        {
+            sites.push_back(item.second);
+            totalCount += item.second.count;
+            totalBytes += item.second.bytes;
+        }
+
+        std::sort(sites.begin(), sites.end(), [](const AllocSite &left, const AllocSite &right) {
+            return left.bytes != right.bytes ? left.bytes > right.bytes : left.count > right.count;
+        });
+
+        auto pauseMs = std::chrono::duration<double, std::milli>(pauseTime).count();
+
+        fprintf(stderr, "===-------------------------------------------------------------------------===\n");
+        fprintf(stderr, "                         Allocation profile\n");
+        fprintf(stderr, "===-------------------------------------------------------------------------===\n");
+        fprintf(stderr, "  %" PRIu64 " allocations, %" PRIu64 " bytes, %zu sites\n", totalCount, totalBytes, sites.size());
+        fprintf(stderr, "  %zu collections, %.3f ms pause, %zu bytes heap size\n\n", (size_t)GC_get_gc_no(), pauseMs,
+                (size_t)GC_get_heap_size());
+        fprintf(stderr, "  %12s %14s  %-24s %s\n", "count", "bytes", "type", "site");
+
+        for (size_t index = 0; index < sites.size() && index < topSites; index++)
+        {
+            auto &allocSite = sites[index];
+
+            char type[32];
+            switch (allocSite.kind)
+            {
+            case AllocKind::Atomic:
+                snprintf(type, sizeof(type), "atomic");
+                break;
+            case AllocKind::Typed:
+                snprintf(type, sizeof(type), "typed 0x%" PRIx64, (uint64_t)allocSite.descr);
+                break;
+            case AllocKind::Realloc:
+                snprintf(type, sizeof(type), "realloc");
+                break;
+            default:
+                snprintf(type, sizeof(type), "normal");
+                break;
+            }
+
+            fprintf(stderr, "  %12" PRIu64 " %14" PRIu64 "  %-24s %s\n", allocSite.count, allocSite.bytes, type, allocSite.site);
+        }
+
+        fflush(stderr);
+    }
+
+    std::mutex buffersMutex;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+
+    static std::chrono::steady_clock::duration pauseTime;
+};
+
+std::chrono::steady_clock::duration AllocProfile::pauseTime{};
+
+} // namespace
+
+void *_mlir__GC_malloc_profiled(size_t size, const char *site)
+{
+    AllocProfile::get().record(site, AllocKind::Normal, 0, size);
+    return GC_MALLOC(size);
+}
+
+void *_mlir__GC_malloc_atomic_profiled(size_t size, const char *site)
+{
+    AllocProfile::get().record(site, AllocKind::Atomic, 0, size);
+    return GC_MALLOC_ATOMIC(size);
+}
+
+void *_mlir__GC_malloc_explicitly_typed_profiled(size_t size, int64_t descr, const char *site)
+{
+    AllocProfile::get().record(site, AllocKind::Typed, descr, size);
+    return _mlir__GC_malloc_explicitly_typed(size, descr);
+}
+
+void *_mlir__GC_realloc_profiled(void *ptr, size_t size, const char *site)
+{
+    AllocProfile::get().record(site, AllocKind::Realloc, 0, size);
+    return GC_REALLOC(ptr, size);
+}
+
+#ifdef TSC_GC_PROFILE_C_API
+// executables (--emit=exe) call collector directly, so profiled entry points are exported by their names
+extern "C" void *GC_malloc_profiled(size_t size, const char *site)
+{
+    return _mlir__GC_malloc_profiled(size, site);
+}
+
+extern "C" void *GC_malloc_atomic_profiled(size_t size, const char *site)
+{
+    return _mlir__GC_malloc_atomic_profiled(size, site);
+}
+
+extern "C" void *GC_malloc_explicitly_typed_profiled(size_t size, int64_t descr, const char *site)
+{
+    return _mlir__GC_malloc_explicitly_typed_profiled(size, descr, site);
+}
+
+extern "C" void *GC_realloc_profiled(void *ptr, size_t size, const char *site)
+{
+    return _mlir__GC_realloc_profiled(ptr, size, site);
+}
+#endif
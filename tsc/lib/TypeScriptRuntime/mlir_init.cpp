@@ -18,6 +18,8 @@ void destroy_asyncruntime();
 void init_dynamicruntime(llvm::StringMap<void *> &exportSymbols);
 void destroy_dynamicruntime();
 
+void init_arrayruntime(llvm::StringMap<void *> &exportSymbols);
+
 // Export symbols for the MLIR runner integration. All other symbols are hidden.
 #ifdef _WIN32
 #define API __declspec(dllexport)
@@ -34,6 +36,7 @@ void __mlir_runner_init(llvm::StringMap<void *> &exportSymbols)
     init_memruntime(exportSymbols);
     init_asyncruntime(exportSymbols);
     init_dynamicruntime(exportSymbols);
+    init_arrayruntime(exportSymbols);
 }
 
 extern "C" API void __mlir_runner_destroy()
@@ -0,0 +1,428 @@
+#include "helper.h"
+
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
+#include <limits>
+#include <map>
+
+#ifndef BENCH_TSC_EXEPATH
+#error BENCH_TSC_EXEPATH must be provided
+#endif
+
+#ifndef BENCH_TSC_LIBPATH
+#error BENCH_TSC_LIBPATH must be provided
+#endif
+
+#ifndef BENCH_LLVM_LIBPATH
+#error BENCH_LLVM_LIBPATH must be provided
+#endif
+
+#ifndef BENCH_GCPATH
+#error BENCH_GCPATH must be provided
+#endif
+
+#ifndef BENCH_RUNTIME_DIR
+#error BENCH_RUNTIME_DIR must be provided
+#endif
+
+#ifndef BENCH_SHARED_RUNTIME
+#error BENCH_SHARED_RUNTIME must be provided
+#endif
+
+#if WIN32
+#define TSC_EXE_NAME "tsc.exe"
+#define SHARED_RUNTIME_PATH "bin/TypeScriptRuntime.dll"
+#define TSC_EXE BENCH_TSC_EXEPATH "\\tsc.exe"
+#define EXE_EXT ".exe"
+#define RUN_PREFIX ""
+#define PIC_OPT ""
+#else
+#define TSC_EXE_NAME "tsc"
+#define SHARED_RUNTIME_PATH "lib/libTypeScriptRuntime.so"
+#define TSC_EXE BENCH_TSC_EXEPATH "/tsc"
+#define EXE_EXT ""
+#define RUN_PREFIX "./"
+#define PIC_OPT " --relocation-model=pic"
+#endif
+
+// Benchmarks of compiler and generated code:
+//  - synthetic/*.ts are generated (thousands of classes, deep generic instantiation, long function, huge object
+//    literal) to measure compile time, --scale=N makes them N times bigger
+//  - runtime/*.ts are microbenchmarks of generated code
+// Every file is compiled to object file (AOT), to executable which is run (runtime only) and run by JIT.
+// Results are written as "<benchmark>\t<mode>\t<seconds>" lines sorted by name, so results of two revisions
+// can be compared by --baseline=<old results> or any diff tool, --time-report=json of every compilation
+// is kept in <benchmark>.<mode>.time.json.
+// --tsc-build=<build dir> runs tsc of another build (f.e. of the revision before a change of code generation)
+// without --time-report, which old revisions do not have, so generated code of both revisions can be compared.
+
+struct BenchOptions
+{
+    std::string out = "bench-results.tsv";
+    std::string baseline;
+    std::string filter;
+    std::string tscBuild;
+    int scale = 1;
+    int runs = 3;
+};
+
+using Results = std::map<std::pair<std::string, std::string>, double>;
+
+static BenchOptions options;
+static auto failed = false;
+
+void setEnv(const char *name, const char *value)
+{
+#if WIN32
+    _putenv_s(name, value);
+#else
+    setenv(name, value, 1);
+#endif
+}
+
+void writeFile(std::string fileName, std::string content)
+{
+    std::ofstream file(fileName);
+    file << content;
+    file.close();
+}
+
+// returns the best of --runs runs, or -1 if command fails
+double measure(std::string cmd, std::string logFile)
+{
+    auto best = std::numeric_limits<double>::max();
+    for (auto run = 0; run < options.runs; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        auto code = std::system((cmd + " 1> " + logFile + " 2>&1").c_str());
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (code != 0)
+        {
+            std::cerr << "Error: return code is not 0, code: " << code << " cmd: " << cmd << " output: " << readOutput(logFile) << std::endl;
+            failed = true;
+            return -1;
+        }
+
+        best = std::min(best, elapsed.count());
+    }
+
+    return best;
+}
+
+//
+// synthetic sources
+//
+
+std::string generateClasses(int count)
+{
+    std::stringstream ss;
+    ss << "interface IValue { value(): number; }" << std::endl;
+    ss << "class Base0 implements IValue { protected v = 0; value() { return this.v; } }" << std::endl;
+    for (auto i = 1; i < count; i++)
+    {
+        // hierarchies of 10 classes
+        auto base = i % 10 == 0 ? 0 : i - 1;
+        ss << "class Base" << i << " extends Base" << base << " {" << std::endl;
+        ss << "    field" << i << " = " << i << ";" << std::endl;
+        ss << "    name" << i << " = \"class" << i << "\";" << std::endl;
+        ss << "    method" << i << "(a: number) { return a + this.field" << i << "; }" << std::endl;
+        ss << "    value() { return this.method" << i << "(super.value()); }" << std::endl;
+        ss << "}" << std::endl;
+    }
+
+    ss << "function main() {" << std::endl;
+    ss << "    let total = 0;" << std::endl;
+    for (auto i = 0; i < count; i += std::max(1, count / 100))
+    {
+        ss << "    total += new Base" << i << "().value();" << std::endl;
+    }
+
+    ss << "    print(total);" << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+}
+
+std::string generateGenerics(int depth)
+{
+    std::stringstream ss;
+    ss << "class Box<T> { constructor(public value: T) {} get() { return this.value; } }" << std::endl;
+    ss << "function generic0<T>(x: T) { return new Box<T>(x); }" << std::endl;
+    for (auto i = 1; i < depth; i++)
+    {
+        ss << "function generic" << i << "<T>(x: T) { return generic" << i - 1 << "<T>(x); }" << std::endl;
+    }
+
+    ss << "function main() {" << std::endl;
+    ss << "    print(generic" << depth - 1 << "<number>(1).get());" << std::endl;
+    ss << "    print(generic" << depth - 1 << "<string>(\"s\").get());" << std::endl;
+    ss << "    print(generic" << depth - 1 << "<boolean>(true).get());" << std::endl;
+    ss << "    print(generic" << depth - 1 << "<Box<number>>(new Box<number>(2)).get().get());" << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+}
+
+std::string generateLongFunction(int statements)
+{
+    std::stringstream ss;
+    ss << "function long(a: number, b: number) {" << std::endl;
+    for (auto i = 0; i < statements; i++)
+    {
+        switch (i % 4)
+        {
+        case 0:
+            ss << "    a = a + " << i << " * b;" << std::endl;
+            break;
+        case 1:
+            ss << "    if (a > " << i << ") { b = b - 1; } else { b = b + 2; }" << std::endl;
+            break;
+        case 2:
+            ss << "    const v" << i << " = a % " << (i % 13 + 1) << ";" << std::endl;
+            break;
+        case 3:
+            ss << "    b = b + v" << i - 1 << ";" << std::endl;
+            break;
+        }
+    }
+
+    ss << "    return a + b;" << std::endl;
+    ss << "}" << std::endl;
+    ss << "function main() { print(long(1, 2)); }" << std::endl;
+    return ss.str();
+}
+
+std::string generateObjectLiteral(int fields)
+{
+    std::stringstream ss;
+    ss << "function main() {" << std::endl;
+    ss << "    const o = {" << std::endl;
+    for (auto i = 0; i < fields; i++)
+    {
+        switch (i % 3)
+        {
+        case 0:
+            ss << "        f" << i << ": " << i << "," << std::endl;
+            break;
+        case 1:
+            ss << "        f" << i << ": \"value" << i << "\"," << std::endl;
+            break;
+        case 2:
+            ss << "        f" << i << ": { n: " << i << ", s: \"nested\" }," << std::endl;
+            break;
+        }
+    }
+
+    ss << "    };" << std::endl;
+    ss << "    print(o.f0, o.f" << fields - 1 << ");" << std::endl;
+    ss << "}" << std::endl;
+    return ss.str();
+}
+
+//
+// running
+//
+
+std::string tscCmd(std::string mode, std::string benchName, std::string opts)
+{
+    if (!options.tscBuild.empty())
+    {
+        return (fs::path(options.tscBuild) / "bin" / TSC_EXE_NAME).string() + " --opt " + opts;
+    }
+
+    return std::string(TSC_EXE) + " --opt --time-report=json --time-report-file=" + benchName + "." + mode + ".time.json " + opts;
+}
+
+std::string sharedRuntime()
+{
+    if (!options.tscBuild.empty())
+    {
+        return (fs::path(options.tscBuild) / SHARED_RUNTIME_PATH).string();
+    }
+
+    return BENCH_SHARED_RUNTIME;
+}
+
+void benchCompile(Results &results, std::string benchName, std::string file)
+{
+    results[{benchName, "aot-compile"}] =
+        measure(tscCmd("aot", benchName, "--emit=obj" PIC_OPT " " + file + " -o=" + benchName + ".o"), benchName + ".aot.log");
+    results[{benchName, "jit"}] =
+        measure(tscCmd("jit", benchName, "--emit=jit --shared-libs=" + sharedRuntime() + " " + file), benchName + ".jit.log");
+}
+
+void benchRuntime(Results &results, std::string benchName, std::string file)
+{
+    auto exe = benchName + EXE_EXT;
+    results[{benchName, "aot-compile"}] =
+        measure(tscCmd("aot", benchName, "--emit=exe" PIC_OPT " " + file + " -o=" + exe), benchName + ".aot.log");
+    if (results[{benchName, "aot-compile"}] >= 0)
+    {
+        results[{benchName, "aot-run"}] = measure(RUN_PREFIX + exe, benchName + ".run.log");
+    }
+
+    results[{benchName, "jit"}] =
+        measure(tscCmd("jit", benchName, "--emit=jit --shared-libs=" + sharedRuntime() + " " + file), benchName + ".jit.log");
+}
+
+bool selected(std::string benchName)
+{
+    return options.filter.empty() || benchName.find(options.filter) != std::string::npos;
+}
+
+void runBenchmarks(Results &results)
+{
+    std::vector<std::pair<std::string, std::function<std::string()>>> synthetic = {
+        {"synthetic_classes", [] { return generateClasses(2000 * options.scale); }},
+        {"synthetic_generics", [] { return generateGenerics(200 * options.scale); }},
+        {"synthetic_long_function", [] { return generateLongFunction(10000 * options.scale); }},
+        {"synthetic_object_literal", [] { return generateObjectLiteral(3000 * options.scale); }},
+    };
+
+    for (auto &bench : synthetic)
+    {
+        if (!selected(bench.first))
+        {
+            continue;
+        }
+
+        std::cout << "Benchmark: " << bench.first << std::endl;
+        auto file = bench.first + ".ts";
+        writeFile(file, bench.second());
+        benchCompile(results, bench.first, file);
+    }
+
+    std::vector<fs::path> runtimeFiles;
+    for (const auto &entry : fs::directory_iterator(BENCH_RUNTIME_DIR))
+    {
+        if (entry.path().extension() == ".ts")
+        {
+            runtimeFiles.push_back(entry.path());
+        }
+    }
+
+    std::sort(runtimeFiles.begin(), runtimeFiles.end());
+    for (auto &file : runtimeFiles)
+    {
+        auto benchName = "runtime_" + file.stem().string();
+        if (!selected(benchName))
+        {
+            continue;
+        }
+
+        std::cout << "Benchmark: " << benchName << std::endl;
+        benchRuntime(results, benchName, file.string());
+    }
+}
+
+void writeResults(Results &results)
+{
+    std::ofstream out(options.out);
+    for (auto &result : results)
+    {
+        out << result.first.first << "\t" << result.first.second << "\t" << std::fixed << std::setprecision(4) << result.second << std::endl;
+    }
+
+    out.close();
+    std::cout << "Results: " << options.out << std::endl;
+}
+
+Results readResults(std::string fileName)
+{
+    Results results;
+    std::ifstream in(fileName);
+    std::string benchName, mode;
+    double value;
+    while (in >> benchName >> mode >> value)
+    {
+        results[{benchName, mode}] = value;
+    }
+
+    return results;
+}
+
+void compareWithBaseline(Results &results)
+{
+    auto baseline = readResults(options.baseline);
+    std::cout << std::left << std::setw(40) << "benchmark" << std::setw(14) << "mode" << std::right << std::setw(12) << "baseline"
+              << std::setw(12) << "current" << std::setw(10) << "change" << std::endl;
+    for (auto &result : results)
+    {
+        auto it = baseline.find(result.first);
+        if (it == baseline.end() || it->second <= 0 || result.second < 0)
+        {
+            continue;
+        }
+
+        auto change = (result.second - it->second) * 100 / it->second;
+        std::cout << std::left << std::setw(40) << result.first.first << std::setw(14) << result.first.second << std::right << std::fixed
+                  << std::setprecision(4) << std::setw(12) << it->second << std::setw(12) << result.second << std::setprecision(1)
+                  << std::setw(9) << std::showpos << change << "%" << std::noshowpos << std::endl;
+    }
+}
+
+void readParams(int argc, char **argv)
+{
+    for (auto index = 1; index < argc; index++)
+    {
+        std::string param = argv[index];
+        auto value = param.substr(param.find('=') + 1);
+        if (param.rfind("--out=", 0) == 0)
+        {
+            options.out = value;
+        }
+        else if (param.rfind("--baseline=", 0) == 0)
+        {
+            options.baseline = value;
+        }
+        else if (param.rfind("--filter=", 0) == 0)
+        {
+            options.filter = value;
+        }
+        else if (param.rfind("--tsc-build=", 0) == 0)
+        {
+            options.tscBuild = value;
+        }
+        else if (param.rfind("--scale=", 0) == 0)
+        {
+            options.scale = std::max(1, std::stoi(value));
+        }
+        else if (param.rfind("--runs=", 0) == 0)
+        {
+            options.runs = std::max(1, std::stoi(value));
+        }
+        else
+        {
+            throw std::runtime_error("unknown param " + param);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    try
+    {
+        readParams(argc, argv);
+
+        // used by tsc to link executables
+        setEnv("GC_LIB_PATH", BENCH_GCPATH);
+        setEnv("LLVM_LIB_PATH", BENCH_LLVM_LIBPATH);
+        setEnv("TSC_LIB_PATH", options.tscBuild.empty() ? BENCH_TSC_LIBPATH : (fs::path(options.tscBuild) / "lib").string().c_str());
+
+        Results results;
+        runBenchmarks(results);
+        writeResults(results);
+
+        if (!options.baseline.empty())
+        {
+            compareWithBaseline(results);
+        }
+    }
+    catch (const std::exception &e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,20 @@
+function main() {
+    let total = 0;
+    for (let i = 0; i < 1000000; i++) {
+        const boxed = <any>i;
+        total += <number>boxed;
+    }
+
+    let strings = 0;
+    for (let i = 0; i < 100000; i++) {
+        const boxed = <any>"value";
+        if (typeof boxed == "string") {
+            strings++;
+        }
+    }
+
+    assert(total == 499999500000);
+    assert(strings == 100000);
+
+    print("done.");
+}
@@ -0,0 +1,18 @@
+function main() {
+    const a: number[] = [];
+    const b: number[] = [];
+    for (let i = 0; i < 50000; i++) {
+        a.push(i);
+        b.push(-i);
+    }
+
+    let total = 0;
+    for (let run = 0; run < 500; run++) {
+        const all = a.concat(b, run);
+        total += all.length;
+    }
+
+    assert(total == 50000500);
+
+    print("done.");
+}
@@ -0,0 +1,21 @@
+function main() {
+    const a: number[] = [];
+    for (let i = 0; i < 100000; i++) {
+        a.push(i * 0.5);
+    }
+
+    let found = 0;
+    for (let run = 0; run < 1000; run++) {
+        if (a.includes(49999.5 - run)) {
+            found++;
+        }
+
+        if (!a.includes(-1)) {
+            found++;
+        }
+    }
+
+    assert(found == 2000);
+
+    print("done.");
+}
@@ -0,0 +1,32 @@
+function main() {
+    const a: number[] = [];
+    for (let i = 0; i < 100000; i++) {
+        a.push(i);
+    }
+
+    const words: string[] = [];
+    for (let i = 0; i < 10000; i++) {
+        words.push(`w${i}`);
+    }
+
+    let found = 0;
+    for (let run = 0; run < 1000; run++) {
+        if (a.indexOf(99999 - run) >= 0) {
+            found++;
+        }
+
+        if (a.indexOf(-1) == -1) {
+            found++;
+        }
+    }
+
+    for (let run = 0; run < 100; run++) {
+        if (words.indexOf(`w${9999 - run}`) >= 0) {
+            found++;
+        }
+    }
+
+    assert(found == 2100);
+
+    print("done.");
+}
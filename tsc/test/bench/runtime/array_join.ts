@@ -0,0 +1,21 @@
+function main() {
+    const words: string[] = [];
+    for (let i = 0; i < 20000; i++) {
+        words.push(`w${i}`);
+    }
+
+    const nums: number[] = [];
+    for (let i = 0; i < 20000; i++) {
+        nums.push(i);
+    }
+
+    let total = 0;
+    for (let run = 0; run < 20; run++) {
+        total += words.join(", ").length;
+        total += nums.join("").length;
+    }
+
+    assert(total > 0);
+
+    print("done.");
+}
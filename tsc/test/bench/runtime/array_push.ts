@@ -0,0 +1,16 @@
+function main() {
+    const a: number[] = [];
+    for (let i = 0; i < 1000000; i++) {
+        a.push(i);
+    }
+
+    let sum = 0;
+    for (const v of a) {
+        sum += v;
+    }
+
+    assert(a.length == 1000000);
+    assert(sum == 499999500000);
+
+    print("done.");
+}
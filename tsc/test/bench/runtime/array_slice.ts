@@ -0,0 +1,16 @@
+function main() {
+    const a: number[] = [];
+    for (let i = 0; i < 100000; i++) {
+        a.push(i);
+    }
+
+    let total = 0;
+    for (let run = 0; run < 1000; run++) {
+        const part = a.slice(run, run + 50000);
+        total += part.length;
+    }
+
+    assert(total == 50000000);
+
+    print("done.");
+}
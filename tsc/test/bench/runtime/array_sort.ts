@@ -0,0 +1,20 @@
+function main() {
+    let seed = 42;
+    const source: number[] = [];
+    for (let i = 0; i < 200000; i++) {
+        seed = (seed * 16807) % 2147483647;
+        source.push(seed);
+    }
+
+    for (let run = 0; run < 5; run++) {
+        const a = source.slice(0);
+        a.sort((x, y) => x - y);
+        assert(a[0] <= a[1] && a[199998] <= a[199999]);
+
+        const b = source.slice(0);
+        b.sort();
+        assert(b.length == 200000);
+    }
+
+    print("done.");
+}
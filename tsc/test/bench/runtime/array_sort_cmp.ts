@@ -0,0 +1,22 @@
+class Item {
+    constructor(public key: number, public order: number) {}
+}
+
+function main() {
+    let seed = 42;
+    const source: Item[] = [];
+    for (let i = 0; i < 100000; i++) {
+        seed = (seed * 16807) % 2147483647;
+        source.push(new Item(seed % 1000, i));
+    }
+
+    for (let run = 0; run < 5; run++) {
+        const a = source.slice(0);
+        a.sort((x, y) => x.key == y.key ? 0 : (x.key < y.key ? -1 : 1));
+        assert(a[0].key <= a[99999].key);
+        // stable
+        assert(a[0].key != a[1].key || a[0].order < a[1].order);
+    }
+
+    print("done.");
+}
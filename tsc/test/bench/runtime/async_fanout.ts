@@ -0,0 +1,23 @@
+async function work(n: number) {
+    let s = 0;
+    for (let i = 0; i < n; i++) {
+        s += i % 7;
+    }
+
+    return s;
+}
+
+function main() {
+    const items: number[] = [];
+    for (let i = 0; i < 1000; i++) {
+        items.push(10000);
+    }
+
+    // body of "for await" runs for all items concurrently
+    for await (const n of items) {
+        const s = await work(n);
+        assert(s > 0);
+    }
+
+    print("done.");
+}
@@ -0,0 +1,22 @@
+function makeAdder(n: number) {
+    return (x: number) => x + n;
+}
+
+function main() {
+    let total = 0;
+    for (let i = 0; i < 1000000; i++) {
+        const add = makeAdder(i % 10);
+        total = add(total) - (i % 10) + 1;
+    }
+
+    let counter = 0;
+    const inc = () => { counter++; };
+    for (let i = 0; i < 1000000; i++) {
+        inc();
+    }
+
+    assert(total == 1000000);
+    assert(counter == 1000000);
+
+    print("done.");
+}
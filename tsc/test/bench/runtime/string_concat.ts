@@ -0,0 +1,16 @@
+function main() {
+    let s = "";
+    for (let i = 0; i < 20000; i++) {
+        s = s + "x";
+    }
+
+    let parts = "";
+    for (let i = 0; i < 20000; i++) {
+        parts += `${i};`;
+    }
+
+    assert(s.length == 20000);
+    assert(parts.length > 20000);
+
+    print("done.");
+}
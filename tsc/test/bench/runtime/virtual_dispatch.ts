@@ -0,0 +1,44 @@
+interface IShape {
+    area(): number;
+}
+
+class Shape implements IShape {
+    area() {
+        return 0;
+    }
+}
+
+class Square extends Shape {
+    constructor(private side: number) {
+        super();
+    }
+
+    area() {
+        return this.side * this.side;
+    }
+}
+
+class Circle extends Shape {
+    constructor(private radius: number) {
+        super();
+    }
+
+    area() {
+        return 3 * this.radius * this.radius;
+    }
+}
+
+function main() {
+    const shapes: Shape[] = [new Square(1), new Circle(1), new Square(2), new Circle(2)];
+    const ishapes: IShape[] = [new Square(1), new Circle(1), new Square(2), new Circle(2)];
+
+    let total = 0;
+    for (let i = 0; i < 2000000; i++) {
+        total += shapes[i % 4].area();
+        total += ishapes[i % 4].area();
+    }
+
+    assert(total == 2 * 500000 * (1 + 3 + 4 + 12));
+
+    print("done.");
+}
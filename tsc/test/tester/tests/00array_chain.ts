@@ -0,0 +1,32 @@
+function main() {
+    const arr = [1, 2, 3, 4, 5, 6];
+
+    const doubled = arr.map(x => x * 2);
+    assert(doubled.length == 6);
+    assert(doubled[5] == 12);
+
+    const odd = arr.filter(x => x % 2 == 1);
+    assert(odd.length == 3);
+    assert(odd[2] == 5);
+
+    const sum = arr.map(x => x * 10).filter(x => x > 20).reduce((s, v) => s + v, 0);
+    assert(sum == 180);
+
+    const strs = arr.filter(x => x > 3).map(x => "v" + x);
+    assert(strs.length == 3);
+    assert(strs[0] == "v4");
+
+    assert(arr.map(x => x - 1).every(x => x < 6));
+    assert(!arr.filter(x => x > 2).some(x => x == 1));
+
+    let count = 0;
+    arr.filter(x => x % 3 == 0).map(x => x / 3).forEach(x => { count += x; });
+    assert(count == 3);
+
+    const pushed = arr.filter(x => x < 3);
+    pushed.push(10);
+    assert(pushed.length == 3);
+    assert(pushed[2] == 10);
+
+    print("done.");
+}
@@ -0,0 +1,19 @@
+function main() {
+    const arr = [1, 2, 3];
+
+    // callbacks with side effects are not fused, every stage runs over the whole array first
+    let log = "";
+    const result = arr.map(x => { log += "m" + x; print("map", x); return x * 2; }).filter(x => { log += "f" + x; print("filter", x); return x > 2; });
+    assert(result.length == 2);
+    assert(log == "m1m2m3f2f4f6");
+
+    log = "";
+    arr.filter(x => { log += "f" + x; return x != 2; }).forEach(x => { log += "e" + x; });
+    assert(log == "f1f2f3e1e3");
+
+    // callbacks without side effects are fused
+    const sum = arr.map(x => x * 10).filter(x => x > 10).reduce((s, v) => s + v, 0);
+    assert(sum == 50);
+
+    print("done.");
+}
@@ -0,0 +1,64 @@
+function main() {
+    const nums = [10, 9, 1, 25, 100, 0.5];
+
+    nums.sort();
+    assert(nums[0] == 0.5);
+    assert(nums[1] == 1);
+    assert(nums[2] == 10);
+    assert(nums[5] == 9);
+
+    // texts of small and large numbers are "0.00001", "1e-7" and "1e+21"
+    const magnitudes = [2, 1e-7, 0.00001, 1.5e21, 1e21, 0.000123, 1e-6];
+    magnitudes.sort();
+    assert(magnitudes[0] == 1e-6);
+    assert(magnitudes[1] == 0.00001);
+    assert(magnitudes[2] == 0.000123);
+    assert(magnitudes[3] == 1.5e21);
+    assert(magnitudes[4] == 1e21);
+    assert(magnitudes[5] == 1e-7);
+    assert(magnitudes[6] == 2);
+
+    nums.sort((a, b) => a - b);
+    assert(nums[0] == 0.5);
+    assert(nums[5] == 100);
+
+    nums.sort((a, b) => b - a);
+    assert(nums[0] == 100);
+    assert(nums[5] == 0.5);
+
+    const pairs = [3, 1, 2, 1];
+    let calls = 0;
+    pairs.sort((a, b) => { calls++; return a - b; });
+    assert(calls > 0);
+    assert(pairs[0] == 1 && pairs[3] == 3);
+
+    const words = ["pear", "apple", "fig"];
+    words.sort();
+    assert(words[0] == "apple");
+    assert(words[2] == "pear");
+
+    assert(nums.indexOf(25) == 3);
+    assert(nums.indexOf(7) == -1);
+    assert(nums.indexOf(100, 1) == -1);
+    assert(nums.includes(9));
+    assert(!nums.includes(7));
+    assert(words.indexOf("fig") == 1);
+    assert(words.includes("pear"));
+
+    const part = nums.slice(1, 3);
+    assert(part.length == 2);
+    assert(part[0] == 25);
+    assert(nums.slice(-2).length == 2);
+    assert(nums.slice(4, 2).length == 0);
+
+    const all = part.concat(nums, 7);
+    assert(all.length == 9);
+    assert(all[2] == 100);
+    assert(all[8] == 7);
+
+    assert(words.join() == "apple,fig,pear");
+    assert(words.join(" - ") == "apple - fig - pear");
+    assert([1, 2, 3].join("") == "123");
+
+    print("done.");
+}
@@ -0,0 +1,33 @@
+function main() {
+    // comparator which is not consistent, like "() => Math.random() - 0.5"
+    let seed = 12345;
+    const random = () => {
+        seed = (seed * 16807) % 2147483647;
+        return seed % 3 - 1;
+    };
+
+    const numbers: number[] = [];
+    for (let i = 0; i < 1000; i++) numbers.push(i);
+
+    numbers.sort((a, b) => random());
+    assert(numbers.length == 1000);
+
+    // every item is kept, none is lost or duplicated
+    let sum = 0;
+    for (const n of numbers) sum += n;
+    assert(sum == 499500);
+
+    const strings = ["a", "b", "c", "d", "e", "f", "g", "h", "i", "j", "k", "l"];
+    strings.sort((a, b) => random());
+    assert(strings.length == 12);
+    assert(strings.join("").length == 12);
+
+    // equal items keep their order
+    const pairs = [[1, 0], [0, 1], [1, 2], [0, 3], [1, 4], [0, 5], [1, 6], [0, 7], [1, 8], [0, 9]];
+    pairs.sort((a, b) => a[0] - b[0]);
+    let order = "";
+    for (const p of pairs) order += p[1];
+    assert(order == "1357902468");
+
+    print("done.");
+}
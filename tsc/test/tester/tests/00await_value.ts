@@ -0,0 +1,31 @@
+async function asyncInc(a: number) {
+    return a + 1;
+}
+
+function inc(a: number) {
+    return a + 1;
+}
+
+function main() {
+    const v = await 10;
+    assert(v == 10);
+
+    const s = await "str";
+    assert(s == "str");
+
+    let sum = 0;
+    for (let i = 0; i < 100; i++) {
+        sum = await inc(sum);
+    }
+
+    assert(sum == 100);
+
+    let asum = 0;
+    for (let i = 0; i < 10; i++) {
+        asum = await asyncInc(asum);
+    }
+
+    assert(asum == 10);
+
+    print("done.");
+}
@@ -0,0 +1,51 @@
+function scale(a: number[], k: number) {
+    for (let i = 0; i < a.length; i++) {
+        a[i] = a[i] * k;
+    }
+}
+
+function dot(a: number[], b: number[]) {
+    let s = 0.0;
+    for (let i = 0; i < a.length; i++) {
+        if (a[i] > 0) {
+            s += a[i] * b[i];
+        }
+    }
+
+    return s;
+}
+
+function main() {
+    const a = [1.0, 2.0, -3.0];
+    const b = [4.0, 5.0, 6.0];
+
+    scale(a, 2);
+    assert(a[0] == 2 && a[1] == 4 && a[2] == -6);
+    assert(dot(a, b) == 28);
+
+    // counter keeps its value after loop
+    let i = 0;
+    const n = 5;
+    for (i = 0; i < n; i++) {
+    }
+
+    assert(i == 5);
+
+    let j = 10;
+    for (; j < n; j++) {
+    }
+
+    assert(j == 10);
+
+    // nested
+    let c = 0;
+    for (let x = 0; x < 3; x++) {
+        for (let y = 0; y < 4; y++) {
+            c++;
+        }
+    }
+
+    assert(c == 12);
+
+    print("done.");
+}
@@ -0,0 +1,38 @@
+function add(a: number, b: number) {
+    return a + b;
+}
+
+function idiv(a: i32, b: i32) {
+    return a / b;
+}
+
+function concat(a: string, b: string) {
+    return a + b;
+}
+
+function main() {
+    assert(add(1.5, 2.5) == 4.0);
+    assert(add(0.1, 0.2) != 0.3);
+
+    const i: i32 = 7;
+    assert(idiv(i, 2) == 3);
+    assert((i % 4) == 3);
+    assert((i << 2) == 28);
+    assert((-i >> 1) == -4);
+    assert((i * 1) == i);
+
+    assert(concat("a", "b") == "ab");
+    assert("x" + "y" + "z" == "xyz");
+
+    assert(typeof "s" == "string");
+    assert(typeof true == "boolean");
+
+    const f: number = i;
+    const back = <i32>f;
+    assert(back == 7);
+
+    assert(!(1.0 > 2.0));
+    assert(-(1.5) < 0);
+
+    print("done.");
+}
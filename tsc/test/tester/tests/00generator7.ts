@@ -0,0 +1,36 @@
+function* g() {
+    yield 1;
+    yield 2;
+    yield 3;
+    yield 4;
+    yield 5;
+    yield 6;
+    yield 7;
+    yield 8;
+    yield 9;
+    yield 10;
+    yield 11;
+    yield 12;
+    yield 13;
+    yield 14;
+    yield 15;
+    yield 16;
+    yield 17;
+    yield 18;
+    yield 19;
+    yield 20;
+}
+
+function main() {
+    let expected = 1;
+    let sum = 0;
+    for (const x of g()) {
+        assert(x == expected++);
+        sum += x;
+    }
+
+    assert(expected == 21);
+    assert(sum == 210);
+
+    print("done.");
+}
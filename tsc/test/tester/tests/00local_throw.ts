@@ -0,0 +1,62 @@
+function find(a: number[], v: number) {
+    let index = -1;
+    try {
+        for (let i = 0; i < a.length; i++) {
+            if (a[i] == v) {
+                index = i;
+                throw 1;
+            }
+        }
+    } catch (e: number) {
+        assert(e == 1);
+    }
+
+    return index;
+}
+
+function nested(n: number) {
+    let r = 0;
+    for (let i = 0; i < n; i++) {
+        try {
+            if (i % 2 == 0) {
+                throw i;
+            }
+
+            r += 10;
+        } catch (e: number) {
+            r += e;
+            continue;
+        }
+    }
+
+    return r;
+}
+
+function thrower() {
+    throw 2;
+}
+
+function mixed(local: boolean) {
+    let r = 0;
+    try {
+        if (local) {
+            throw 1;
+        }
+
+        thrower();
+    } catch (e: number) {
+        r = e;
+    }
+
+    return r;
+}
+
+function main() {
+    assert(find([1, 2, 3], 2) == 1);
+    assert(find([1, 2, 3], 4) == -1);
+    assert(nested(4) == 22);
+    assert(mixed(true) == 1);
+    assert(mixed(false) == 2);
+
+    print("done.");
+}
@@ -0,0 +1,37 @@
+function sum(a: number[]) {
+    let s = 0.0;
+    for (let i: number = 0; i < a.length; i++) {
+        s += a[i];
+    }
+
+    return s;
+}
+
+function countDown(n: number) {
+    let c: number = 0;
+    let j: number = 10;
+    while (j > 0) {
+        j = j - 1;
+        c++;
+    }
+
+    return c + n;
+}
+
+function main() {
+    assert(sum([1.5, 2.5, 3]) == 7);
+
+    // not an integer counter
+    let h: number = 0;
+    h = h + 0.5;
+    h++;
+    assert(h == 1.5);
+
+    let k: number = 3;
+    assert((k & 1) == 1);
+    assert(k / 2 == 1.5);
+
+    assert(countDown(2) == 12);
+
+    print("done.");
+}
@@ -0,0 +1,22 @@
+function concat(s: string) {
+    return "a" + "b" + s + "" + "c" + "d";
+}
+
+function main() {
+    const s = "hello" + " " + "world";
+    assert(s == "hello world");
+    assert(s.length == 11);
+    assert(("abc" + "").length == 3);
+
+    assert(concat("x") == "abxcd");
+    assert(concat("") == "abcd");
+    assert(concat("x").length == 5);
+
+    const name = "world";
+    const t = `hello ${name}!`;
+    assert(t == "hello world!");
+    assert(t.length == 12);
+
+    print("literal", 1, "literal", s, "literal");
+    print("done.");
+}
@@ -3,7 +3,6 @@
 
 #include <cctype>
 #include <functional>
-#include <regex>
 #include <sstream>
 #include <string>
 
@@ -18,11 +17,7 @@ using number = int;
 using string = std::wstring;
 using char_t = wchar_t;
 using sstream = std::wstringstream;
-using regex = std::wregex;
-using sregex_iterator = std::wsregex_iterator;
 using stringstream = std::wstringstream;
-using smatch = std::wsmatch;
-#define regex_replace std::regex_replace
 
 #define to_number_base(x, y) std::stoi(x, nullptr, y)
 #define _S(x) (L##x)
@@ -9227,6 +9227,11 @@ auto Parser::getLineAndCharacterOfPosition(SourceFileLike sourceFile, number pos
     return impl->scanner.getLineAndCharacterOfPosition(sourceFile, position);
 }
 
+auto Parser::getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position, number fromLine) -> LineAndCharacter
+{
+    return impl->scanner.getLineAndCharacterOfPosition(sourceFile, position, fromLine);
+}
+
 Parser::~Parser()
 {
     delete impl;
@@ -59,6 +59,8 @@ class Parser
 
     auto getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position) -> LineAndCharacter;
 
+    auto getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position, number fromLine) -> LineAndCharacter;
+
     ~Parser();
 };
 
@@ -2293,6 +2293,8 @@ struct SourceFileLike : Declaration
     // Stores a line map for the file.
     // This field should never be used directly to obtain line map, use getLineMap function instead.
     std::vector<number> lineMap;
+    // Line of the last position lookup, see getLineAndCharacterOfPosition
+    number lastLineHit = 0;
     /* @internal */
     std::function<number(number, number, boolean allowEdits)> getPositionOfLineAndCharacter;
 };
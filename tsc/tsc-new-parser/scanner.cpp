@@ -946,18 +946,6 @@ std::vector<number> Scanner::unicodeESNextIdentifierPart = {
     126572, 126578, 126580, 126583, 126585, 126588, 126590, 126590, 126592, 126601, 126603, 126619, 126625, 126627, 126629, 126633, 126635,
     126651, 131072, 173782, 173824, 177972, 177984, 178205, 178208, 183969, 183984, 191456, 194560, 195101, 917760, 917999};
 
-/**
- * Test for whether a single line comment's text contains a directive.
- */
-regex Scanner::commentDirectiveRegExSingleLine = regex(S("^\\/\\/\\/?\\s*@(ts-expect-error|ts-ignore)"));
-
-/**
- * Test for whether a multi-line comment's last line contains a directive.
- */
-regex Scanner::commentDirectiveRegExMultiLine = regex(S("^(?:\\/|\\*)*\\s*@(ts-expect-error|ts-ignore)"));
-
-regex Scanner::jsDocSeeOrLink = regex(S("@(?:see|link)"));
-
 // Creates a scanner over a (possibly unspecified) range of a piece of text.
 Scanner::Scanner(ScriptTarget languageVersion, boolean skipTrivia, LanguageVariant languageVariant, string textInitial,
                  ErrorCallback onError, number start, number length)
@@ -1126,19 +1114,20 @@ auto Scanner::stringToToken(string s) -> SyntaxKind
 }
 
 /* @internal */
-auto Scanner::computeLineStarts(safe_string text) -> std::vector<number>
+auto Scanner::computeLineStarts(const string &text) -> std::vector<number>
 {
     std::vector<number> result;
-    auto pos = 0;
-    auto lineStart = 0;
-    while (pos < text.length())
+    number length = text.length();
+    number pos = 0;
+    number lineStart = 0;
+    while (pos < length)
     {
-        auto ch = text[pos];
+        auto ch = (CharacterCodes)text[pos];
         pos++;
         switch (ch)
         {
         case CharacterCodes::carriageReturn:
-            if (text[pos] == CharacterCodes::lineFeed)
+            if (pos < length && (CharacterCodes)text[pos] == CharacterCodes::lineFeed)
             {
                 pos++;
             }
@@ -1168,7 +1157,7 @@ auto Scanner::getPositionOfLineAndCharacter(SourceFileLike sourceFile, number li
 }
 
 /* @internal */
-auto Scanner::computePositionOfLineAndCharacter(std::vector<number> lineStarts, number line, number character, string debugText,
+auto Scanner::computePositionOfLineAndCharacter(const std::vector<number> &lineStarts, number line, number character, const string &debugText,
                                                 bool allowEdits) -> number
 {
     if (line < 0 || line >= lineStarts.size())
@@ -1209,23 +1198,19 @@ auto Scanner::computePositionOfLineAndCharacter(std::vector<number> lineStarts,
 }
 
 /* @internal */
-auto Scanner::getLineStarts(SourceFileLike sourceFile) -> std::vector<number>
+auto Scanner::getLineStarts(SourceFileLike sourceFile) -> const std::vector<number> &
 {
-    if (!sourceFile->lineMap.empty())
+    if (sourceFile->lineMap.empty())
     {
-        return sourceFile->lineMap;
+        sourceFile->lineMap = computeLineStarts(sourceFile->text);
+        sourceFile->lastLineHit = 0;
     }
 
-    auto lineMap = computeLineStarts(sourceFile->text);
-    for (auto &item : lineMap)
-    {
-        sourceFile->lineMap.push_back(item);
-    }
     return sourceFile->lineMap;
 }
 
 /* @internal */
-auto Scanner::computeLineAndCharacterOfPosition(std::vector<number> lineStarts, number position) -> LineAndCharacter
+auto Scanner::computeLineAndCharacterOfPosition(const std::vector<number> &lineStarts, number position) -> LineAndCharacter
 {
     auto lineNumber = computeLineOfPosition(lineStarts, position);
     return LineAndCharacter({lineNumber, position - lineStarts[lineNumber]});
@@ -1235,7 +1220,7 @@ auto Scanner::computeLineAndCharacterOfPosition(std::vector<number> lineStarts,
  * @internal
  * We assume the first line starts at position 0 and 'position' is non-negative.
  */
-auto Scanner::computeLineOfPosition(std::vector<number> lineStarts, number position, number lowerBound) -> number
+auto Scanner::computeLineOfPosition(const std::vector<number> &lineStarts, number position, number lowerBound) -> number
 {
     auto lineNumber = binarySearch<number, number>(lineStarts, position, &identity<number>, &compareValues<number>, lowerBound);
     if (lineNumber < 0)
@@ -1258,7 +1243,7 @@ auto Scanner::getLinesBetweenPositions(SourceFileLike sourceFile, number pos1, n
 {
     if (pos1 == pos2)
         return 0;
-    auto lineStarts = getLineStarts(sourceFile);
+    auto &lineStarts = getLineStarts(sourceFile);
     auto lower = std::min(pos1, pos2);
     auto isNegative = lower == pos2;
     auto upper = isNegative ? pos1 : pos2;
@@ -1269,7 +1254,37 @@ auto Scanner::getLinesBetweenPositions(SourceFileLike sourceFile, number pos1, n
 
 auto Scanner::getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position) -> LineAndCharacter
 {
-    return computeLineAndCharacterOfPosition(getLineStarts(sourceFile), position);
+    auto &lineStarts = getLineStarts(sourceFile);
+
+    // most of queries (diagnostics, locations of MLIR ops) come in increasing order of positions,
+    // so check the line of the last hit and the line after it before falling back to binary search
+    number lineCount = lineStarts.size();
+    auto lineNumber = sourceFile->lastLineHit;
+    if (lineNumber < lineCount && lineStarts[lineNumber] <= position)
+    {
+        if (lineNumber + 1 < lineCount && lineStarts[lineNumber + 1] <= position)
+        {
+            lineNumber++;
+            if (lineNumber + 1 < lineCount && lineStarts[lineNumber + 1] <= position)
+            {
+                lineNumber = computeLineOfPosition(lineStarts, position, lineNumber + 1);
+            }
+        }
+    }
+    else
+    {
+        lineNumber = computeLineOfPosition(lineStarts, position);
+    }
+
+    sourceFile->lastLineHit = lineNumber;
+    return LineAndCharacter({lineNumber, position - lineStarts[lineNumber]});
+}
+
+auto Scanner::getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position, number fromLine) -> LineAndCharacter
+{
+    auto &lineStarts = getLineStarts(sourceFile);
+    auto lineNumber = computeLineOfPosition(lineStarts, position, fromLine);
+    return LineAndCharacter({lineNumber, position - lineStarts[lineNumber]});
 }
 
 auto Scanner::isWhiteSpaceLike(CharacterCodes ch) -> boolean
@@ -1539,30 +1554,37 @@ auto Scanner::scanConflictMarkerTrivia(safe_string &text, number pos, std::funct
     return pos;
 }
 
-regex Scanner::shebangTriviaRegex = regex(S("^#!.*"));
-
 /*@internal*/
 auto Scanner::isShebangTrivia(string &text, number pos) -> boolean
 {
     // Shebangs check must only be done at the start of the file
     debug(pos == 0);
-    return regex_search(text, shebangTriviaRegex);
+    return text.length() >= 2 && text[0] == S('#') && text[1] == S('!');
 }
 
 /*@internal*/
 auto Scanner::scanShebangTrivia(string &text, number pos) -> number
 {
-    auto words_begin = sregex_iterator(text.begin(), text.end(), shebangTriviaRegex);
-    auto words_end = sregex_iterator();
-    for (auto i = words_begin; i != words_end; ++i)
+    return pos + getShebangLength(text);
+}
+
+/*@internal*/
+auto Scanner::getShebangLength(string &text) -> number
+{
+    // ^#!.*
+    if (!(text.length() >= 2 && text[0] == S('#') && text[1] == S('!')))
     {
-        auto match = *i;
-        auto match_str = match.str();
-        pos = pos + match_str.size();
-        return pos;
+        return 0;
     }
 
-    return pos;
+    number length = text.length();
+    number p = 2;
+    while (p < length && !isLineBreak((CharacterCodes)text[p]))
+    {
+        p++;
+    }
+
+    return p;
 }
 
 auto Scanner::appendCommentRange(number pos, number end, SyntaxKind kind, boolean hasTrailingNewLine, number state,
@@ -1593,15 +1615,7 @@ auto Scanner::getTrailingCommentRanges(string &text, number pos) -> std::vector<
 /** Optionally, get the shebang */
 auto Scanner::getShebang(string &text) -> string
 {
-    auto words_begin = sregex_iterator(text.begin(), text.end(), shebangTriviaRegex);
-    auto words_end = sregex_iterator();
-    for (auto i = words_begin; i != words_end; ++i)
-    {
-        auto match = *i;
-        return match.str();
-    }
-
-    return string();
+    return text.substr(0, getShebangLength(text));
 }
 
 auto Scanner::isIdentifierStart(CharacterCodes ch, ScriptTarget languageVersion) -> boolean
@@ -2650,8 +2664,7 @@ auto Scanner::scan() -> SyntaxKind
                     pos++;
                 }
 
-                commentDirectives =
-                    appendIfCommentDirective(commentDirectives, text.substring(tokenStart, pos), commentDirectiveRegExSingleLine, tokenStart);
+                appendIfCommentDirective(commentDirectives, tokenStart, false);
 
                 if (_skipTrivia)
                 {
@@ -2694,8 +2707,7 @@ auto Scanner::scan() -> SyntaxKind
                     tokenFlags |= TokenFlags::PrecedingJSDocComment;
                 }                
 
-                commentDirectives = appendIfCommentDirective(commentDirectives, text.substring(lastLineStart, pos),
-                                                             commentDirectiveRegExMultiLine, lastLineStart);
+                appendIfCommentDirective(commentDirectives, lastLineStart, true);
 
                 if (!commentClosed)
                 {
@@ -3044,9 +3056,27 @@ auto Scanner::shouldParseJSDoc() -> bool {
         return false;
     }
 
-    auto words_begin = sregex_iterator(((string&)text).begin() + fullStartPos, ((string&)text).begin() + pos, jsDocSeeOrLink);
-    auto words_end = sregex_iterator();
-    return (words_begin != words_end);
+    return hasJSDocSeeOrLink(fullStartPos, pos);
+}
+
+// @(?:see|link)
+auto Scanner::hasJSDocSeeOrLink(number start, number end) -> boolean
+{
+    auto &value = (string &)text;
+    for (auto p = start; p + 4 <= end; p++)
+    {
+        if (value[p] != S('@'))
+        {
+            continue;
+        }
+
+        if (value.compare(p + 1, 3, S("see")) == 0 || (p + 5 <= end && value.compare(p + 1, 4, S("link")) == 0))
+        {
+            return true;
+        }
+    }
+
+    return false;
 }
 
 auto Scanner::reScanInvalidIdentifier() -> SyntaxKind
@@ -3186,35 +3216,68 @@ auto Scanner::reScanSlashToken() -> SyntaxKind
     return token;
 }
 
-auto Scanner::appendIfCommentDirective(std::vector<CommentDirective> commentDirectives, string text, regex commentDirectiveRegEx,
-                                       number lineStart) -> std::vector<CommentDirective>
+auto Scanner::appendIfCommentDirective(std::vector<CommentDirective> &commentDirectives, number commentStart, boolean multiLine) -> void
 {
-    auto type = getDirectiveFromComment(text, commentDirectiveRegEx);
+    auto type = getDirectiveFromComment(text, commentStart, pos, multiLine);
     if (type == CommentDirectiveType::Undefined)
     {
-        return commentDirectives;
+        return;
     }
 
-    commentDirectives.push_back(data::CommentDirective{lineStart, pos, type});
-    return commentDirectives;
+    commentDirectives.push_back(data::CommentDirective{commentStart, pos, type});
 }
 
-auto Scanner::getDirectiveFromComment(string &text, regex commentDirectiveRegEx) -> CommentDirectiveType
+auto Scanner::getDirectiveFromComment(string &text, number start, number end, boolean multiLine) -> CommentDirectiveType
 {
-    auto words_begin = sregex_iterator(text.begin(), text.end(), commentDirectiveRegEx);
-    auto words_end = sregex_iterator();
-    if (words_begin == words_end)
+    auto p = start;
+    if (multiLine)
+    {
+        // (?:\/|\*)*
+        while (p < end && (text[p] == S('/') || text[p] == S('*')))
+        {
+            p++;
+        }
+    }
+    else
+    {
+        // \/\/\/?
+        if (p + 2 > end || text[p] != S('/') || text[p + 1] != S('/'))
+        {
+            return CommentDirectiveType::Undefined;
+        }
+
+        p += 2;
+        if (p < end && text[p] == S('/'))
+        {
+            p++;
+        }
+    }
+
+    // \s*@
+    while (p < end && isWhiteSpaceLike((CharacterCodes)text[p]))
+    {
+        p++;
+    }
+
+    if (p >= end || text[p] != S('@'))
     {
         return CommentDirectiveType::Undefined;
     }
 
-    for (auto i = words_begin; i != words_end; ++i)
+    p++;
+
+    // (ts-expect-error|ts-ignore)
+    auto startsWith = [&](const char_t *directive, number length) {
+        return p + length <= end && text.compare(p, length, directive) == 0;
+    };
+
+    if (startsWith(S("ts-expect-error"), 15))
     {
-        auto match = *i;
-        auto match_str = match.str();
-        if (match_str == S("ts-expect-error"))
-            return CommentDirectiveType::ExpectError;
+        return CommentDirectiveType::ExpectError;
+    }
 
+    if (startsWith(S("ts-ignore"), 9))
+    {
         return CommentDirectiveType::Ignore;
     }
 
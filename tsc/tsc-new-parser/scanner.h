@@ -7,7 +7,6 @@
 #include <functional>
 #include <iostream>
 #include <map>
-#include <regex>
 #include <sstream>
 #include <string>
 #include <cstring>
@@ -209,16 +208,8 @@ class Scanner
 
     static std::vector<number> unicodeESNextIdentifierPart;
 
-    static regex commentDirectiveRegExSingleLine;
-
-    static regex commentDirectiveRegExMultiLine;
-
-    static regex jsDocSeeOrLink;
-
     static number mergeConflictMarkerLength;
 
-    static regex shebangTriviaRegex;
-
   protected:
     ScriptKind scriptKind;
 
@@ -311,31 +302,34 @@ class Scanner
     auto stringToToken(string s) -> SyntaxKind;
 
     /* @internal */
-    auto computeLineStarts(safe_string text) -> std::vector<number>;
+    auto computeLineStarts(const string &text) -> std::vector<number>;
 
     auto getPositionOfLineAndCharacter(SourceFileLike sourceFile, number line, number character, bool allowEdits = true) -> number;
 
     /* @internal */
-    auto computePositionOfLineAndCharacter(std::vector<number> lineStarts, number line, number character, string debugText,
+    auto computePositionOfLineAndCharacter(const std::vector<number> &lineStarts, number line, number character, const string &debugText,
                                            bool allowEdits = true) -> number;
 
     /* @internal */
-    auto getLineStarts(SourceFileLike sourceFile) -> std::vector<number>;
+    auto getLineStarts(SourceFileLike sourceFile) -> const std::vector<number> &;
 
     /* @internal */
-    auto computeLineAndCharacterOfPosition(std::vector<number> lineStarts, number position) -> LineAndCharacter;
+    auto computeLineAndCharacterOfPosition(const std::vector<number> &lineStarts, number position) -> LineAndCharacter;
 
     /**
      * @internal
      * We assume the first line starts at position 0 and 'position' is non-negative.
      */
-    auto computeLineOfPosition(std::vector<number> lineStarts, number position, number lowerBound = 0) -> number;
+    auto computeLineOfPosition(const std::vector<number> &lineStarts, number position, number lowerBound = 0) -> number;
 
     /** @internal */
     auto getLinesBetweenPositions(SourceFileLike sourceFile, number pos1, number pos2);
 
     auto getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position) -> LineAndCharacter;
 
+    // 'position' must not precede the beginning of 'fromLine' (e.g. the end of a node which starts at that line)
+    auto getLineAndCharacterOfPosition(SourceFileLike sourceFile, number position, number fromLine) -> LineAndCharacter;
+
     auto isWhiteSpaceLike(CharacterCodes ch) -> boolean;
 
     /** Does not include line breaks. For that, see isWhiteSpaceLike. */
@@ -368,6 +362,16 @@ class Scanner
     /*@internal*/
     auto scanShebangTrivia(string &text, number pos) -> number;
 
+    /*@internal*/
+    auto getShebangLength(string &text) -> number;
+
+    /**
+     * Test for whether a comment's text in [start, end) contains a directive.
+     * Single line comments: ^///?\s*@(ts-expect-error|ts-ignore)
+     * Last line of multi-line comments: ^(?:/|*)*\s*@(ts-expect-error|ts-ignore)
+     */
+    auto getDirectiveFromComment(string &text, number start, number end, boolean multiLine) -> CommentDirectiveType;
+
     /**
      * Invokes a callback for each comment range following the provided position.
      *
@@ -628,10 +632,9 @@ class Scanner
 
     auto reScanSlashToken() -> SyntaxKind;
 
-    auto appendIfCommentDirective(std::vector<CommentDirective> commentDirectives, string text, regex commentDirectiveRegEx,
-                                  number lineStart) -> std::vector<CommentDirective>;
+    auto appendIfCommentDirective(std::vector<CommentDirective> &commentDirectives, number commentStart, boolean multiLine) -> void;
 
-    auto getDirectiveFromComment(string &text, regex commentDirectiveRegEx) -> CommentDirectiveType;
+    auto hasJSDocSeeOrLink(number start, number end) -> boolean;
 
     auto reScanTemplateToken(boolean isTaggedTemplate) -> SyntaxKind;
 
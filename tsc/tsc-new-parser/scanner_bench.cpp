@@ -0,0 +1,158 @@
+#include <array>
+#include <chrono>
+#include <codecvt>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <locale>
+#include <memory>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+#if __cplusplus >= 201703L
+#include <filesystem>
+namespace fs = std::filesystem;
+#else
+#define _SILENCE_EXPERIMENTAL_FILESYSTEM_DEPRECATION_WARNING
+#include <experimental/filesystem>
+namespace fs = std::experimental::filesystem;
+#endif
+
+#include "file_helper.h"
+#include "scanner.h"
+
+// usage: tsc-new-scanner-bench <file.ts> [iterations]
+// e.g.   tsc-new-scanner-bench jslib/lib.d.ts 20
+//
+// Scans the file and measures the time spent in comment-directive matching
+// (hand-written matcher vs. the std::wregex based one used before)
+
+using namespace ts;
+using clock_type = std::chrono::steady_clock;
+
+struct CommentInfo
+{
+    number start;
+    number end;
+    boolean multiLine;
+};
+
+static auto elapsedMs(clock_type::time_point start) -> double
+{
+    return std::chrono::duration<double, std::milli>(clock_type::now() - start).count();
+}
+
+static auto regexDirective(string &text, CommentInfo &comment, std::wregex &regEx) -> CommentDirectiveType
+{
+    std::wsmatch match;
+    auto begin = text.cbegin() + comment.start;
+    auto end = text.cbegin() + comment.end;
+    if (!std::regex_search(begin, end, match, regEx))
+    {
+        return CommentDirectiveType::Undefined;
+    }
+
+    return match[1].str() == S("ts-expect-error") ? CommentDirectiveType::ExpectError : CommentDirectiveType::Ignore;
+}
+
+int main(int argc, char **args)
+{
+    if (argc < 2 || !fs::exists(args[1]))
+    {
+        std::cout << "usage: " << args[0] << " <file.ts> [iterations]" << std::endl;
+        return 1;
+    }
+
+    auto iterations = argc > 2 ? std::atoi(args[2]) : 10;
+    auto text = readFile(std::string(args[1]));
+
+    // collect comments, for multi-line comments only the last line is checked for directives
+    std::vector<CommentInfo> comments;
+    Scanner scanner(ScriptTarget::Latest, false, LanguageVariant::Standard, text);
+
+    auto scanStart = clock_type::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        comments.clear();
+        scanner.setText(text);
+        auto token = SyntaxKind::Unknown;
+        while (token != SyntaxKind::EndOfFileToken)
+        {
+            token = scanner.scan();
+            if (token == SyntaxKind::SingleLineCommentTrivia)
+            {
+                comments.push_back({scanner.getTokenStart(), scanner.getTokenEnd(), false});
+            }
+            else if (token == SyntaxKind::MultiLineCommentTrivia)
+            {
+                auto lastLineStart = scanner.getTokenStart();
+                for (auto p = lastLineStart; p < scanner.getTokenEnd(); p++)
+                {
+                    if (scanner.isLineBreak((CharacterCodes)text[p]))
+                    {
+                        lastLineStart = p + 1;
+                    }
+                }
+
+                comments.push_back({lastLineStart, scanner.getTokenEnd(), true});
+            }
+        }
+    }
+
+    auto scanMs = elapsedMs(scanStart);
+
+    auto directives = 0;
+    auto matcherStart = clock_type::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        directives = 0;
+        for (auto &comment : comments)
+        {
+            if (scanner.getDirectiveFromComment(text, comment.start, comment.end, comment.multiLine) != CommentDirectiveType::Undefined)
+            {
+                directives++;
+            }
+        }
+    }
+
+    auto matcherMs = elapsedMs(matcherStart);
+
+    std::wregex singleLine(S("^\\/\\/\\/?\\s*@(ts-expect-error|ts-ignore)"));
+    std::wregex multiLine(S("^(?:\\/|\\*)*\\s*@(ts-expect-error|ts-ignore)"));
+
+    std::vector<CommentDirectiveType> expected(comments.size());
+    auto regexStart = clock_type::now();
+    for (auto i = 0; i < iterations; i++)
+    {
+        for (size_t index = 0; index < comments.size(); index++)
+        {
+            auto &comment = comments[index];
+            expected[index] = regexDirective(text, comment, comment.multiLine ? multiLine : singleLine);
+        }
+    }
+
+    auto regexMs = elapsedMs(regexStart);
+
+    auto mismatches = 0;
+    for (size_t index = 0; index < comments.size(); index++)
+    {
+        auto &comment = comments[index];
+        if (expected[index] != scanner.getDirectiveFromComment(text, comment.start, comment.end, comment.multiLine))
+        {
+            mismatches++;
+        }
+    }
+
+    std::cout << "file:                   " << args[1] << std::endl;
+    std::cout << "iterations:             " << iterations << std::endl;
+    std::cout << "comments:               " << comments.size() << std::endl;
+    std::cout << "directives:             " << directives << std::endl;
+    std::cout << "scan (ms/iter):         " << scanMs / iterations << std::endl;
+    std::cout << "directives (ms/iter):   " << matcherMs / iterations << std::endl;
+    std::cout << "std::wregex (ms/iter):  " << regexMs / iterations << std::endl;
+    std::cout << "mismatches:             " << mismatches << std::endl;
+
+    return mismatches == 0 ? 0 : 1;
+}
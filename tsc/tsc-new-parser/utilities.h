@@ -12,6 +12,12 @@
 #include "scanner.h"
 #include "types.h"
 
+// scanner does not use regular expressions, they are declared for utilities and parser only
+using regex = std::wregex;
+using sregex_iterator = std::wsregex_iterator;
+using smatch = std::wsmatch;
+#define regex_replace std::regex_replace
+
 namespace ts
 {
 namespace Extension
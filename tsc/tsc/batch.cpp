@@ -0,0 +1,201 @@
+#include "TypeScript/DataStructs.h"
+
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/DialectRegistry.h"
+#include "mlir/IR/MLIRContext.h"
+
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Allocator.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/StringSaver.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "TypeScript/TypeScriptCompiler/Defines.h"
+
+#include <condition_variable>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define DEBUG_TYPE "tsc"
+
+namespace cl = llvm::cl;
+
+extern cl::opt<enum Action> emitAction;
+extern cl::opt<unsigned> batchThreads;
+
+void loadMLIRDialects(mlir::MLIRContext &);
+std::string getDefaultOutputFileName(enum Action, llvm::StringRef);
+int compileTypeScriptFileIntoMLIR(mlir::MLIRContext &, llvm::SourceMgr &, mlir::OwningOpRef<mlir::ModuleOp> &, llvm::StringRef, CompileOptions&);
+int runMLIRPasses(mlir::MLIRContext &, llvm::SourceMgr &, mlir::OwningOpRef<mlir::ModuleOp> &, CompileOptions&);
+int dumpObjOrAssembly(int, char **, enum Action, std::string, mlir::ModuleOp, CompileOptions&);
+
+// Batch mode (--batch, --server):
+//  - every line of stdin is a request "<input> [-o <output>]", paths with spaces are quoted
+//  - requests are compiled by --batch-threads threads, each thread has own MLIRContext made from the shared
+//    DialectRegistry and keeps parsed default lib between requests
+//  - for every request "ok <input>" or "error <input>" is written to stdout when it is done (in order of completion),
+//    diagnostics go to stderr
+//  - the process exits at the end of stdin
+
+namespace
+{
+
+struct BatchRequest
+{
+    std::string line;
+    std::string input;
+    std::string output;
+};
+
+class BatchCompiler
+{
+  public:
+    BatchCompiler(int argc, char **argv, mlir::DialectRegistry &registry, CompileOptions &compileOptions)
+        : argc(argc), argv(argv), registry(registry), compileOptions(compileOptions)
+    {
+    }
+
+    int run()
+    {
+        auto threadsCount = batchThreads > 0 ? (unsigned)batchThreads : std::max(1u, std::thread::hardware_concurrency());
+        for (auto index = 0u; index < threadsCount; index++)
+        {
+            workers.emplace_back([this]() { workerLoop(); });
+        }
+
+        std::string line;
+        while (std::getline(std::cin, line))
+        {
+            if (llvm::StringRef(line).trim().empty())
+            {
+                continue;
+            }
+
+            {
+                std::lock_guard<std::mutex> lock(queueMutex);
+                queue.push_back(line);
+            }
+
+            queueCondition.notify_one();
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            endOfInput = true;
+        }
+
+        queueCondition.notify_all();
+        for (auto &worker : workers)
+        {
+            worker.join();
+        }
+
+        return failed ? 1 : 0;
+    }
+
+  private:
+    void workerLoop()
+    {
+        // contexts are not shared, diagnostic handlers of MLIRContext are global for it
+        mlir::MLIRContext mlirContext(registry, mlir::MLIRContext::Threading::DISABLED);
+        loadMLIRDialects(mlirContext);
+
+        while (true)
+        {
+            std::string line;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [&]() { return endOfInput || !queue.empty(); });
+                if (queue.empty())
+                {
+                    return;
+                }
+
+                line = std::move(queue.front());
+                queue.pop_front();
+            }
+
+            BatchRequest request;
+            request.line = line;
+            auto result = parseRequest(request) ? compile(mlirContext, request) : -1;
+            reply(request, result);
+        }
+    }
+
+    bool parseRequest(BatchRequest &request)
+    {
+        llvm::BumpPtrAllocator allocator;
+        llvm::StringSaver saver(allocator);
+        llvm::SmallVector<const char *> args;
+        cl::TokenizeGNUCommandLine(request.line, saver, args);
+
+        if (args.size() == 1 || (args.size() == 3 && llvm::StringRef(args[1]) == "-o"))
+        {
+            request.input = args[0];
+            request.output = args.size() == 3 ? args[2] : "";
+            return request.input != "-";
+        }
+
+        llvm::errs() << "tsc: error: bad request, expected '<input> [-o <output>]': " << request.line << "\n";
+        return false;
+    }
+
+    int compile(mlir::MLIRContext &mlirContext, BatchRequest &request)
+    {
+        LLVM_DEBUG(llvm::dbgs() << "\n!! batch: compiling " << request.input << "\n";);
+
+        // compiler changes options by the source (f.e. "/// <reference no-default-lib="true"/>")
+        auto requestCompileOptions = compileOptions;
+
+        llvm::SourceMgr sourceMgr;
+        mlir::OwningOpRef<mlir::ModuleOp> module;
+        if (int error = compileTypeScriptFileIntoMLIR(mlirContext, sourceMgr, module, request.input, requestCompileOptions))
+        {
+            return error;
+        }
+
+        if (int error = runMLIRPasses(mlirContext, sourceMgr, module, requestCompileOptions))
+        {
+            return error;
+        }
+
+        auto output = request.output.empty() ? getDefaultOutputFileName(emitAction, request.input) : request.output;
+        return dumpObjOrAssembly(argc, argv, emitAction, output, *module, requestCompileOptions);
+    }
+
+    void reply(BatchRequest &request, int result)
+    {
+        std::lock_guard<std::mutex> lock(replyMutex);
+        failed |= result != 0;
+        llvm::outs() << (result == 0 ? "ok " : "error ") << (request.input.empty() ? request.line : request.input) << "\n";
+        llvm::outs().flush();
+    }
+
+    int argc;
+    char **argv;
+    mlir::DialectRegistry &registry;
+    CompileOptions &compileOptions;
+
+    std::vector<std::thread> workers;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<std::string> queue;
+    bool endOfInput = false;
+
+    std::mutex replyMutex;
+    bool failed = false;
+};
+
+} // namespace
+
+int runBatch(int argc, char **argv, mlir::DialectRegistry &registry, CompileOptions &compileOptions)
+{
+    BatchCompiler batchCompiler(argc, argv, registry, compileOptions);
+    return batchCompiler.run();
+}
@@ -2,6 +2,7 @@
 
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/Timing.h"
 
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/MemoryBuffer.h"
@@ -25,12 +26,13 @@ extern cl::opt<bool> generateDebugInfo;
 extern cl::opt<bool> lldbDebugInfo;
 extern cl::opt<std::string> TargetTriple;
 
-int compileTypeScriptFileIntoMLIR(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::OwningOpRef<mlir::ModuleOp> &module, CompileOptions &compileOptions)
-{
-    auto fileName = llvm::StringRef(inputFilename);
+mlir::TimingScope &getRootTiming();
+void addCompileStatistics(const CompileStatistics &);
 
+int compileTypeScriptFileIntoMLIR(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::OwningOpRef<mlir::ModuleOp> &module, llvm::StringRef fileName, CompileOptions &compileOptions)
+{
     // Handle '.ts' input to the compiler.
-    auto fileOrErr = llvm::MemoryBuffer::getFileOrSTDIN(inputFilename);
+    auto fileOrErr = llvm::MemoryBuffer::getFileOrSTDIN(fileName);
     if (std::error_code ec = fileOrErr.getError())
     {
         llvm::WithColor::error(llvm::errs(), "tsc") << "Could not open input file: " << ec.message() << "\n";
@@ -39,6 +41,13 @@ int compileTypeScriptFileIntoMLIR(mlir::MLIRContext &context, llvm::SourceMgr &s
     
     sourceMgr.AddNewSourceBuffer(std::move(*fileOrErr), llvm::SMLoc());
 
-    module = mlirGenFromSource(context, fileName, sourceMgr, compileOptions);
+    CompileStatistics statistics;
+    module = mlirGenFromSource(context, fileName, sourceMgr, compileOptions, getRootTiming(), statistics);
+    addCompileStatistics(statistics);
     return !module ? 1 : 0;
 }
+
+int compileTypeScriptFileIntoMLIR(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::OwningOpRef<mlir::ModuleOp> &module, CompileOptions &compileOptions)
+{
+    return compileTypeScriptFileIntoMLIR(context, sourceMgr, module, inputFilename, compileOptions);
+}
@@ -13,6 +13,7 @@
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Target/TargetMachine.h"
 
 #include "TypeScript/TypeScriptCompiler/Defines.h"
 
@@ -30,7 +31,7 @@ extern cl::opt<bool> lldbDebugInfo;
 
 std::unique_ptr<llvm::ToolOutputFile> getOutputStream(enum Action);
 int registerMLIRDialects(mlir::ModuleOp);
-std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&);
+std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&, llvm::TargetMachine *);
 
 int dumpAST()
 {
@@ -74,7 +75,7 @@ int dumpLLVMIR(mlir::ModuleOp module, CompileOptions &compileOptions)
     llvm::InitializeNativeTarget();
     llvm::InitializeNativeTargetAsmPrinter();
 
-    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions);
+    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions, nullptr);
     if (auto err = optPipeline(llvmModule.get()))
     {
         llvm::WithColor::error(llvm::errs(), "tsc") << "Failed to optimize LLVM IR " << err << "\n";
@@ -12,6 +12,7 @@
 #include "llvm/Support/InitLLVM.h"
 #include "llvm/Support/Process.h"
 #include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/Path.h"
 
 #include "TypeScript/DataStructs.h"
@@ -28,7 +29,10 @@ extern cl::opt<std::string> llvmlibpath;
 extern cl::opt<std::string> tsclibpath;
 extern cl::opt<std::string> emsdksysrootpath;
 extern cl::opt<bool> enableOpt;
+extern cl::opt<int> optLevel;
 extern cl::list<std::string> libs;
+extern cl::opt<std::string> profileGenerate;
+extern cl::opt<enum LTOMode> ltoMode;
 
 std::string getDefaultOutputFileName(enum Action);
 
@@ -118,6 +122,19 @@ std::string getTscLibPath(std::string driverPath)
     return "";    
 }
 
+bool hasTscLib(std::string driverPath, llvm::StringRef name, bool win)
+{
+    auto libPath = getTscLibPath(driverPath);
+    if (libPath.empty())
+    {
+        return false;
+    }
+
+    llvm::SmallString<256> path(libPath);
+    llvm::sys::path::append(path, win ? (name + ".lib").str() : ("lib" + name + ".a").str());
+    return llvm::sys::fs::exists(path);
+}
+
 std::string getEMSDKSysRootPath(std::string driverPath)
 {
     if (!emsdksysrootpath.empty())
@@ -253,6 +270,7 @@ int buildExe(int argc, char **argv, std::string objFileName, CompileOptions &com
     auto wasm = arch == llvm::Triple::wasm32 || arch == llvm::Triple::wasm64;
     auto emscripten = os == llvm::Triple::Emscripten;
     auto shared = emitAction == BuildDll;
+    auto lto = ltoMode != LTONone;
     
     if (wasm)
     {
@@ -260,6 +278,23 @@ int buildExe(int argc, char **argv, std::string objFileName, CompileOptions &com
         isTscLibNeeded = false;        
     }
 
+    // slim runtime has own thread pool and dlopen wrapper, so LLVMSupport is not needed,
+    // bitcode build of it lets linker inline runtime calls into user code
+    const char *tscRuntimeLibOpt = "-lTypeScriptAsyncRuntime";
+    if (isTscLibNeeded)
+    {
+        if (lto && hasTscLib(driverPath, "TypeScriptSlimRuntimeLTO", win))
+        {
+            tscRuntimeLibOpt = "-lTypeScriptSlimRuntimeLTO";
+            isLLVMLibNeeded = false;
+        }
+        else if (hasTscLib(driverPath, "TypeScriptSlimRuntime", win))
+        {
+            tscRuntimeLibOpt = "-lTypeScriptSlimRuntime";
+            isLLVMLibNeeded = false;
+        }
+    }
+
     args.push_back(objFileName.c_str());
     if (win && shared)
     {
@@ -355,6 +390,11 @@ int buildExe(int argc, char **argv, std::string objFileName, CompileOptions &com
     }
 
     // tsc libs
+    if (compileOptions.allocProfile && isTscLibNeeded)
+    {
+        args.push_back("-lTypeScriptGCProfile");
+    }
+
     if (!disableGC)
     {    
         args.push_back("-lgcmt-lib");
@@ -362,7 +402,7 @@ int buildExe(int argc, char **argv, std::string objFileName, CompileOptions &com
 
     if (isTscLibNeeded)
     {
-        args.push_back("-lTypeScriptAsyncRuntime");
+        args.push_back(tscRuntimeLibOpt);
     }
 
     if (isLLVMLibNeeded)
@@ -381,10 +421,35 @@ int buildExe(int argc, char **argv, std::string objFileName, CompileOptions &com
         args.push_back("-lstdc++");
         args.push_back("-lm");
         args.push_back("-lpthread");
-        args.push_back("-ltinfo");
+        if (isLLVMLibNeeded)
+        {
+            args.push_back("-ltinfo");
+        }
+
         args.push_back("-ldl");
     }
 
+    std::string ltoOptLevelOpt;
+    if (lto)
+    {
+        args.push_back(ltoMode == LTOThin ? "-flto=thin" : "-flto=full");
+        if (!wasm)
+        {
+            // wasm-ld supports LTO already
+            args.push_back("-fuse-ld=lld");
+        }
+
+        // optimization level of LTO backend
+        ltoOptLevelOpt = "-O" + std::to_string(enableOpt ? optLevel.getValue() : 0);
+        args.push_back(ltoOptLevelOpt.c_str());
+    }
+
+    if (profileGenerate.getNumOccurrences() > 0 && !wasm)
+    {
+        // links compiler-rt profile runtime which writes .profraw at exit
+        args.push_back("-fprofile-generate");
+    }
+
     if (wasm && emscripten)
     {
         //args.push_back("--sysroot=C:/utils/emsdk/upstream/emscripten/cache/sysroot");
@@ -2,13 +2,24 @@
 
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/Target/LLVMIR/Export.h"
+
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/Orc/ExecutionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/ExecutionEngine/Orc/RTDyldObjectLinkingLayer.h"
+#include "llvm/ExecutionEngine/SectionMemoryManager.h"
+#include "llvm/IR/LLVMContext.h"
 
 #include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/SubtargetFeature.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/TargetSelect.h"
 #include "llvm/Support/PrettyStackTrace.h"
 #include "llvm/Support/Signals.h"
 #include "llvm/Support/WithColor.h"
+#include "llvm/Target/TargetMachine.h"
 
 #define DEBUG_TYPE "tsc"
 
@@ -23,33 +34,263 @@ extern cl::opt<std::string> objectFilename;
 extern cl::opt<bool> disableGC;
 extern cl::opt<std::string> mainFuncName;
 extern cl::opt<std::string> inputFilename;
+extern cl::opt<bool> lazyJit;
+extern cl::opt<unsigned> jitCompileThreads;
+extern cl::opt<bool> tieredJit;
+extern cl::opt<bool> perfMap;
+extern cl::opt<bool> jitDump;
 
 // obj
 extern cl::opt<std::string> TargetTriple;
 
 int registerMLIRDialects(mlir::ModuleOp);
-std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&);
+std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&, llvm::TargetMachine *);
+std::unique_ptr<llvm::TargetMachine> createJITTargetMachine();
+bool storeJitCacheObject(llvm::StringRef, llvm::function_ref<void(llvm::StringRef)>);
+void registerPerfJITEventListeners(llvm::function_ref<void(llvm::JITEventListener &)>);
+
+using RuntimeSymbolMapFn = std::function<llvm::orc::SymbolMap(llvm::orc::MangleAndInterner)>;
+int runTieredJit(mlir::ModuleOp, CompileOptions &, llvm::TargetMachine &, RuntimeSymbolMapFn, bool &);
 
-int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compileOptions)
+static void reportMissingGC()
 {
-    // Print a stack trace if we signal out.
-    llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
-    llvm::PrettyStackTraceProgram X(argc, argv);
-    llvm::setBugReportMsg("PLEASE submit a bug report to https://github.com/ASDAlexander77/TypeScriptCompiler/issues and include the crash backtrace.");
+#ifdef WIN32
+#define LIB_NAME ""
+#define LIB_EXT "dll"
+#else
+#define LIB_NAME "lib"
+#define LIB_EXT "so"
+#endif
+    llvm::WithColor::error(llvm::errs(), "tsc") << "JIT initialization failed. Missing GC library. Did you forget to provide it via "
+                    "'--shared-libs=" LIB_NAME "TypeScriptRuntime." LIB_EXT "'? or you can switch it off by using '-nogc'\n";
+}
 
-    llvm::llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+int reportJitError(llvm::StringRef message, llvm::Error error)
+{
+    llvm::WithColor::error(llvm::errs(), "tsc") << message << ", error: " << error << "\n";
+    return -1;
+}
 
-    registerMLIRDialects(module);
+using MlirRunnerInitFn = void (*)(llvm::StringMap<void *> &);
+using MlirRunnerDestroyFn = void (*)();
 
-    // Initialize LLVM targets.
-    llvm::InitializeNativeTarget();
-    llvm::InitializeNativeTargetAsmPrinter();
+llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> createObjectLinkingLayer(llvm::orc::ExecutionSession &session,
+                                                                                const llvm::Triple &triple)
+{
+    auto objectLayer = std::make_unique<llvm::orc::RTDyldObjectLinkingLayer>(
+        session, []() { return std::make_unique<llvm::SectionMemoryManager>(); });
+
+    // the same as in mlir::ExecutionEngine
+    if (!enableOpt)
+    {
+        objectLayer->registerJITEventListener(*llvm::JITEventListener::createGDBRegistrationListener());
+    }
+
+    registerPerfJITEventListeners([&](llvm::JITEventListener &listener) { objectLayer->registerJITEventListener(listener); });
+
+    if (triple.isOSBinFormatCOFF())
+    {
+        objectLayer->setOverrideObjectFlagsWithResponsibilityFlags(true);
+        objectLayer->setAutoClaimResponsibilityForObjectSymbols(true);
+    }
+
+    return std::move(objectLayer);
+}
+
+llvm::orc::JITTargetMachineBuilder getJITTargetMachineBuilder(llvm::TargetMachine &targetMachine)
+{
+    llvm::orc::JITTargetMachineBuilder tmBuilder(targetMachine.getTargetTriple());
+    tmBuilder.setCPU(targetMachine.getTargetCPU().str());
+    tmBuilder.addFeatures(llvm::SubtargetFeatures(targetMachine.getTargetFeatureString()).getFeatures());
+    tmBuilder.setCodeGenOptLevel(targetMachine.getOptLevel());
+    return tmBuilder;
+}
+
+// runtime symbols and symbols of loaded shared libraries
+int defineJitSymbols(llvm::orc::LLJIT &jit, RuntimeSymbolMapFn runtimeSymbolMap, bool &noGC)
+{
+    auto &mainJD = jit.getMainJITDylib();
+
+    llvm::orc::MangleAndInterner interner(jit.getExecutionSession(), jit.getDataLayout());
+    if (auto err = mainJD.define(llvm::orc::absoluteSymbols(runtimeSymbolMap(interner))))
+    {
+        return reportJitError("JIT registering runtime symbols failed", std::move(err));
+    }
+
+    if (noGC)
+    {
+        reportMissingGC();
+        return -1;
+    }
+
+    auto processSymbols = llvm::orc::DynamicLibrarySearchGenerator::GetForCurrentProcess(jit.getDataLayout().getGlobalPrefix());
+    if (!processSymbols)
+    {
+        return reportJitError("JIT search of process symbols failed", processSymbols.takeError());
+    }
+
+    mainJD.addGenerator(std::move(*processSymbols));
+    return 0;
+}
+
+int invokeJitMain(llvm::orc::LLJIT &jit)
+{
+    using VoidFn = void (*)();
+
+    auto gctorsAddr = jit.lookup("__mlir_gctors");
+    if (gctorsAddr)
+    {
+        gctorsAddr->toPtr<VoidFn>()();
+    }
+    else if (auto err = llvm::handleErrors(gctorsAddr.takeError(), [](const llvm::orc::SymbolsNotFound &) {}))
+    {
+        // module without global constructors does not have "__mlir_gctors"
+        return reportJitError("JIT calling global constructors failed", std::move(err));
+    }
+
+    auto mainAddr = jit.lookup(mainFuncName);
+    if (!mainAddr)
+    {
+        return reportJitError("JIT invocation failed", mainAddr.takeError());
+    }
+
+    mainAddr->toPtr<VoidFn>()();
+    return 0;
+}
+
+// LLVM IR of module for ORC JIT (lazy, eager and tiered), with data layout and triple of the JIT
+std::unique_ptr<llvm::Module> translateModuleForJit(mlir::ModuleOp module, llvm::LLVMContext &llvmContext, llvm::orc::LLJIT &jit)
+{
+    auto llvmModule = mlir::translateModuleToLLVMIR(module, llvmContext);
+    if (!llvmModule)
+    {
+        llvm::WithColor::error(llvm::errs(), "tsc") << "Failed to emit LLVM IR\n";
+        return nullptr;
+    }
+
+    llvmModule->setDataLayout(jit.getDataLayout());
+    llvmModule->setTargetTriple(jit.getTargetTriple().getTriple());
+    return llvmModule;
+}
+
+// Lazy JIT: module is split per function by CompileOnDemandLayer, every function is optimized and compiled
+// on the first call (on compile threads if any), declarations of lib.d.ts which are never called are not compiled.
+// Eager JIT on LLJIT: used instead of mlir::ExecutionEngine when perf listeners (--perf-map, --jitdump) are needed,
+// as the engine does not let to register own listeners
+static int runOrcJit(mlir::ModuleOp module, std::function<llvm::Error(llvm::Module *)> optPipeline,
+                     CompileOptions &compileOptions, llvm::TargetMachine &targetMachine,
+                     RuntimeSymbolMapFn runtimeSymbolMap, bool &noGC, bool lazy)
+{
+    auto maybeJit = lazy
+        ? llvm::Expected<std::unique_ptr<llvm::orc::LLJIT>>(llvm::orc::LLLazyJITBuilder()
+            .setJITTargetMachineBuilder(getJITTargetMachineBuilder(targetMachine))
+            .setNumCompileThreads(jitCompileThreads)
+            .setObjectLinkingLayerCreator(createObjectLinkingLayer)
+            .create())
+        : llvm::orc::LLJITBuilder()
+            .setJITTargetMachineBuilder(getJITTargetMachineBuilder(targetMachine))
+            .setObjectLinkingLayerCreator(createObjectLinkingLayer)
+            .create();
+    if (!maybeJit)
+    {
+        return reportJitError(lazy ? "Lazy JIT is not supported for the target, use JIT without --lazy-jit" : "JIT initialization failed",
+                              maybeJit.takeError());
+    }
+
+    auto &jit = *maybeJit;
+    if (auto error = defineJitSymbols(*jit, runtimeSymbolMap, noGC))
+    {
+        return error;
+    }
+
+    auto llvmContext = std::make_unique<llvm::LLVMContext>();
+    auto llvmModule = translateModuleForJit(module, *llvmContext, *jit);
+    if (!llvmModule)
+    {
+        return -1;
+    }
+
+    // optimization is applied to every partition of module when it is requested (to whole module by eager JIT).
+    // Partitions are optimized by compile threads at the same time, and TargetMachine is not thread safe (it caches
+    // subtargets), so with compile threads every partition is optimized with own TargetMachine
+    auto tmBuilder = getJITTargetMachineBuilder(targetMachine);
+    auto ownTargetMachine = lazy && jitCompileThreads > 0;
+    jit->getIRTransformLayer().setTransform(
+        [optPipeline, tmBuilder, ownTargetMachine, &compileOptions](
+            llvm::orc::ThreadSafeModule tsm,
+            llvm::orc::MaterializationResponsibility &) -> llvm::Expected<llvm::orc::ThreadSafeModule> {
+            if (!ownTargetMachine)
+            {
+                if (auto err = tsm.withModuleDo([&](llvm::Module &m) { return optPipeline(&m); }))
+                {
+                    return std::move(err);
+                }
+
+                return std::move(tsm);
+            }
+
+            auto partitionTmBuilder = tmBuilder;
+            auto partitionTargetMachine = partitionTmBuilder.createTargetMachine();
+            if (!partitionTargetMachine)
+            {
+                return partitionTargetMachine.takeError();
+            }
+
+            auto partitionOptPipeline =
+                getTransformer(enableOpt, optLevel, sizeLevel, compileOptions, partitionTargetMachine->get());
+            if (auto err = tsm.withModuleDo([&](llvm::Module &m) { return partitionOptPipeline(&m); }))
+            {
+                return std::move(err);
+            }
+
+            return std::move(tsm);
+        });
+
+    llvm::orc::ThreadSafeModule tsm(std::move(llvmModule), std::move(llvmContext));
+    auto err = lazy
+        ? static_cast<llvm::orc::LLLazyJIT &>(*jit).addLazyIRModule(std::move(tsm))
+        : jit->addIRModule(std::move(tsm));
+    if (err)
+    {
+        return reportJitError("JIT adding module failed", std::move(err));
+    }
+
+    return invokeJitMain(*jit);
+}
+
+// object file produced by JIT before (see --jit-cache) is linked without MLIR and LLVM IR
+static int linkAndRunObject(std::unique_ptr<llvm::MemoryBuffer> object, llvm::TargetMachine &targetMachine,
+                            RuntimeSymbolMapFn runtimeSymbolMap, bool &noGC)
+{
+    auto maybeJit = llvm::orc::LLJITBuilder()
+        .setJITTargetMachineBuilder(getJITTargetMachineBuilder(targetMachine))
+        .setObjectLinkingLayerCreator(createObjectLinkingLayer)
+        .create();
+    if (!maybeJit)
+    {
+        return reportJitError("JIT initialization failed", maybeJit.takeError());
+    }
 
-    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions);
+    auto &jit = *maybeJit;
+    if (auto error = defineJitSymbols(*jit, runtimeSymbolMap, noGC))
+    {
+        return error;
+    }
 
-    // If shared library implements custom mlir-runner library init and destroy
-    // functions, we'll use them to register the library with the execution
-    // engine. Otherwise we'll pass library directly to the execution engine.
+    if (auto err = jit->addObjectFile(std::move(object)))
+    {
+        return reportJitError("JIT adding object file failed", std::move(err));
+    }
+
+    return invokeJitMain(*jit);
+}
+
+// If shared library implements custom mlir-runner library init and destroy
+// functions, we'll use them to register the library with the execution
+// engine. Otherwise we'll pass library directly to the execution engine.
+static int loadSharedLibs(CompileOptions &compileOptions, llvm::StringMap<void *> &exportSymbols,
+                          mlir::SmallVectorImpl<MlirRunnerDestroyFn> &destroyFns)
+{
     mlir::SmallVector<mlir::SmallString<256>, 4> libPaths;
 
     if (!compileOptions.noDefaultLib)
@@ -71,12 +312,6 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
     // Libraries that we'll pass to the ExecutionEngine for loading.
     mlir::SmallVector<mlir::StringRef, 4> executionEngineLibs;
 
-    using MlirRunnerInitFn = void (*)(llvm::StringMap<void *> &);
-    using MlirRunnerDestroyFn = void (*)();
-
-    llvm::StringMap<void *> exportSymbols;
-    mlir::SmallVector<MlirRunnerDestroyFn> destroyFns;
-
     // Handle libraries that do support mlir-runner init/destroy callbacks.
     for (auto &libPath : libPaths)
     {
@@ -121,31 +356,84 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
         destroyFns.push_back(destroyFn);
     }
 
-    auto noGC = false;
+    return 0;
+}
 
-    // Build a runtime symbol map from the config and exported symbols.
-    auto runtimeSymbolMap = [&](llvm::orc::MangleAndInterner interner) {
-        auto symbolMap = llvm::orc::SymbolMap();
-        for (auto &exportSymbol : exportSymbols)
-        {
-            LLVM_DEBUG(llvm::dbgs() << "loading symbol: " << exportSymbol.getKey() << "\n";);
-            symbolMap[interner(exportSymbol.getKey())] = { llvm::orc::ExecutorAddr::fromPtr(exportSymbol.getValue()), llvm::JITSymbolFlags::Exported };
-        }
+static llvm::orc::SymbolMap getRuntimeSymbolMap(llvm::StringMap<void *> &exportSymbols, llvm::orc::MangleAndInterner interner,
+                                                bool &noGC)
+{
+    auto symbolMap = llvm::orc::SymbolMap();
+    for (auto &exportSymbol : exportSymbols)
+    {
+        LLVM_DEBUG(llvm::dbgs() << "loading symbol: " << exportSymbol.getKey() << "\n";);
+        symbolMap[interner(exportSymbol.getKey())] = { llvm::orc::ExecutorAddr::fromPtr(exportSymbol.getValue()), llvm::JITSymbolFlags::Exported };
+    }
 
-        if (!disableGC && symbolMap.count(interner("GC_init")) == 0)
-        {
-            noGC = true;
-        }
+    if (!disableGC && symbolMap.count(interner("GC_init")) == 0)
+    {
+        noGC = true;
+    }
+
+    return symbolMap;
+}
+
+int runJitObject(int argc, char **argv, std::unique_ptr<llvm::MemoryBuffer> object, CompileOptions &compileOptions)
+{
+    // Print a stack trace if we signal out.
+    llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+    llvm::PrettyStackTraceProgram X(argc, argv);
+    llvm::setBugReportMsg("PLEASE submit a bug report to https://github.com/ASDAlexander77/TypeScriptCompiler/issues and include the crash backtrace.");
+
+    llvm::llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+
+    // Initialize LLVM targets.
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    auto targetMachine = createJITTargetMachine();
+    if (!targetMachine)
+    {
+        return -1;
+    }
+
+    llvm::StringMap<void *> exportSymbols;
+    mlir::SmallVector<MlirRunnerDestroyFn> destroyFns;
+    if (auto error = loadSharedLibs(compileOptions, exportSymbols, destroyFns))
+    {
+        return error;
+    }
 
-        return symbolMap;
+    auto noGC = false;
+    auto runtimeSymbolMap = [&](llvm::orc::MangleAndInterner interner) {
+        return getRuntimeSymbolMap(exportSymbols, interner, noGC);
     };
 
+    auto result = linkAndRunObject(std::move(object), *targetMachine, runtimeSymbolMap, noGC);
+
+    // Run all dynamic library destroy callbacks to prepare for the shutdown.
+    llvm::for_each(destroyFns, [](MlirRunnerDestroyFn destroy) { destroy(); });
+
+    return result;
+}
+
+// eager JIT on mlir::ExecutionEngine, which dumps object file (--dump-object-file, --jit-cache)
+static int runExecutionEngine(mlir::ModuleOp module, std::function<llvm::Error(llvm::Module *)> optPipeline,
+                              llvm::TargetMachine &targetMachine, RuntimeSymbolMapFn runtimeSymbolMap, bool &noGC,
+                              llvm::StringRef cacheObjectFile, llvm::function_ref<void()> storeCacheDependencies)
+{
+    if (perfMap && !dumpObjectFile)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--perf-map is not written while compiling into --jit-cache, next runs of cached object write it\n";
+    }
+
     // Create an MLIR execution engine. The execution engine eagerly JIT-compiles
     // the module.
     mlir::ExecutionEngineOptions engineOptions;
     engineOptions.transformer = optPipeline;
-    engineOptions.enableObjectDump = dumpObjectFile;
+    engineOptions.jitCodeGenOptLevel = targetMachine.getOptLevel();
+    engineOptions.enableObjectDump = dumpObjectFile || !cacheObjectFile.empty();
     engineOptions.enableGDBNotificationListener = !enableOpt;
+    engineOptions.enablePerfNotificationListener = jitDump;
     auto maybeEngine = mlir::ExecutionEngine::create(module, engineOptions);
     assert(maybeEngine && "failed to construct an execution engine");
     auto &engine = maybeEngine.get();
@@ -153,15 +441,7 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
     engine->registerSymbols(runtimeSymbolMap);
     if (noGC)
     {
-#ifdef WIN32
-#define LIB_NAME ""
-#define LIB_EXT "dll"
-#else
-#define LIB_NAME "lib"
-#define LIB_EXT "so"
-#endif
-        llvm::WithColor::error(llvm::errs(), "tsc") << "JIT initialization failed. Missing GC library. Did you forget to provide it via "
-                        "'--shared-libs=" LIB_NAME "TypeScriptRuntime." LIB_EXT "'? or you can switch it off by using '-nogc'\n";
+        reportMissingGC();
         return -1;
     }
 
@@ -191,6 +471,22 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
         return 0;
     }
 
+    if (!cacheObjectFile.empty())
+    {
+        // module is compiled at first lookup, object is stored before running as "main" may not return
+        auto expectedFPtr = engine->lookup(mainFuncName);
+        if (!expectedFPtr)
+        {
+            llvm::WithColor::error(llvm::errs(), "tsc") << expectedFPtr.takeError();
+            return -1;
+        }
+
+        if (storeJitCacheObject(cacheObjectFile, [&](llvm::StringRef tempFile) { engine->dumpToObjectFile(tempFile); }))
+        {
+            storeCacheDependencies();
+        }
+    }
+
     if (module.lookupSymbol("__mlir_gctors"))
     {
         auto gctorsResult = engine->invokePacked("__mlir_gctors");
@@ -203,10 +499,6 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
 
     // Invoke the JIT-compiled function.
     auto invocationResult = engine->invokePacked(mainFuncName);
-
-    // Run all dynamic library destroy callbacks to prepare for the shutdown.
-    llvm::for_each(destroyFns, [](MlirRunnerDestroyFn destroy) { destroy(); });
-
     if (invocationResult)
     {
         llvm::WithColor::error(llvm::errs(), "tsc") << "JIT invocation failed, error: " << invocationResult << "\n";
@@ -215,3 +507,64 @@ int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compile
 
     return 0;
 }
+
+int runJit(int argc, char **argv, mlir::ModuleOp module, CompileOptions &compileOptions, llvm::StringRef cacheObjectFile,
+           llvm::function_ref<void()> storeCacheDependencies)
+{
+    // Print a stack trace if we signal out.
+    llvm::sys::PrintStackTraceOnErrorSignal(argv[0]);
+    llvm::PrettyStackTraceProgram X(argc, argv);
+    llvm::setBugReportMsg("PLEASE submit a bug report to https://github.com/ASDAlexander77/TypeScriptCompiler/issues and include the crash backtrace.");
+
+    llvm::llvm_shutdown_obj Y; // Call llvm_shutdown() on exit.
+
+    registerMLIRDialects(module);
+
+    // Initialize LLVM targets.
+    llvm::InitializeNativeTarget();
+    llvm::InitializeNativeTargetAsmPrinter();
+
+    // the same CPU and features are used to optimize and to generate code
+    auto targetMachine = createJITTargetMachine();
+    if (!targetMachine)
+    {
+        return -1;
+    }
+
+    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions, targetMachine.get());
+
+    llvm::StringMap<void *> exportSymbols;
+    mlir::SmallVector<MlirRunnerDestroyFn> destroyFns;
+    if (auto error = loadSharedLibs(compileOptions, exportSymbols, destroyFns))
+    {
+        return error;
+    }
+
+    auto noGC = false;
+
+    // Build a runtime symbol map from the config and exported symbols.
+    auto runtimeSymbolMap = [&](llvm::orc::MangleAndInterner interner) {
+        return getRuntimeSymbolMap(exportSymbols, interner, noGC);
+    };
+
+    int result;
+    if (tieredJit && !dumpObjectFile && cacheObjectFile.empty())
+    {
+        result = runTieredJit(module, compileOptions, *targetMachine, runtimeSymbolMap, noGC);
+    }
+    // object file of lazy JIT is not one, so object file is dumped by eager JIT only
+    else if ((lazyJit || perfMap || jitDump) && !dumpObjectFile && cacheObjectFile.empty())
+    {
+        result = runOrcJit(module, optPipeline, compileOptions, *targetMachine, runtimeSymbolMap, noGC, lazyJit);
+    }
+    else
+    {
+        result = runExecutionEngine(module, optPipeline, *targetMachine, runtimeSymbolMap, noGC, cacheObjectFile,
+                                    storeCacheDependencies);
+    }
+
+    // Run all dynamic library destroy callbacks to prepare for the shutdown.
+    llvm::for_each(destroyFns, [](MlirRunnerDestroyFn destroy) { destroy(); });
+
+    return result;
+}
@@ -0,0 +1,189 @@
+#include "TypeScript/Version.h"
+#include "TypeScript/DataStructs.h"
+
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/SourceMgr.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Target/TargetMachine.h"
+
+#define DEBUG_TYPE "tsc"
+
+namespace cl = llvm::cl;
+
+extern cl::opt<std::string> inputFilename;
+extern cl::opt<std::string> jitCacheDir;
+extern cl::opt<bool> enableOpt;
+extern cl::opt<int> optLevel;
+extern cl::opt<int> sizeLevel;
+
+std::unique_ptr<llvm::TargetMachine> createJITTargetMachine();
+
+// JIT cache (--jit-cache=<dir>) keeps two files per key:
+//   <key>.o    - object file of the module compiled by JIT
+//   <key>.deps - "<sha256> <path>" of every file loaded by compiler besides the main one (imports, lib.d.ts)
+// The key is hash of the main file, options, target and the compiler itself.
+
+static std::string hashOf(llvm::StringRef data)
+{
+    return llvm::toHex(llvm::SHA256::hash(llvm::arrayRefFromStringRef(data)), true);
+}
+
+static std::string getJitCacheFile(llvm::StringRef key, llvm::StringRef ext)
+{
+    llvm::SmallString<256> path(jitCacheDir);
+    llvm::sys::path::append(path, key + ext);
+    return std::string(path);
+}
+
+// writes into temporary file first, so other instances of compiler never see incomplete file
+static bool writeJitCacheFile(llvm::StringRef path, llvm::function_ref<void(llvm::StringRef)> write)
+{
+    if (auto ec = llvm::sys::fs::create_directories(llvm::sys::path::parent_path(path)))
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "JIT cache is not written: " << ec.message() << "\n";
+        return false;
+    }
+
+    llvm::SmallString<256> tempPath;
+    llvm::sys::fs::createUniquePath(path + ".%%%%%%.tmp", tempPath, false);
+
+    write(tempPath);
+
+    if (auto ec = llvm::sys::fs::rename(tempPath, path))
+    {
+        llvm::sys::fs::remove(tempPath);
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "JIT cache is not written: " << ec.message() << "\n";
+        return false;
+    }
+
+    return true;
+}
+
+std::string getJitCacheKey(const char *argv0, CompileOptions &compileOptions)
+{
+    if (inputFilename == "-")
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--jit-cache is ignored for input from stdin\n";
+        return "";
+    }
+
+    auto fileOrErr = llvm::MemoryBuffer::getFile(inputFilename);
+    if (!fileOrErr)
+    {
+        // error is reported by compiler
+        return "";
+    }
+
+    auto targetMachine = createJITTargetMachine();
+    if (!targetMachine)
+    {
+        return "";
+    }
+
+    // rebuilt compiler of the same version must not use old objects
+    auto executable = llvm::sys::fs::getMainExecutable(argv0, (void *)&getJitCacheKey);
+    llvm::sys::fs::file_status executableStatus;
+    llvm::sys::fs::status(executable, executableStatus);
+
+    llvm::SmallString<256> inputPath(inputFilename);
+    llvm::sys::fs::make_absolute(inputPath);
+
+    std::string keyData;
+    llvm::raw_string_ostream os(keyData);
+    os << TSC_PACKAGE_VERSION << '\0'
+       << executable << '\0'
+       << executableStatus.getLastModificationTime().time_since_epoch().count() << '\0'
+       << inputPath << '\0'
+       << (*fileOrErr)->getBuffer() << '\0'
+       << compileOptions.isJit << compileOptions.disableGC << compileOptions.enableBuiltins
+       << compileOptions.noDefaultLib << compileOptions.generateDebugInfo << compileOptions.lldbDebugInfo
+       << compileOptions.sizeBits << (int)compileOptions.exportOpt << compileOptions.allocProfile << '\0'
+       << compileOptions.moduleTargetTriple << '\0'
+       << enableOpt << optLevel << sizeLevel << '\0'
+       << targetMachine->getTargetTriple().str() << '\0'
+       << targetMachine->getTargetCPU() << '\0'
+       << targetMachine->getTargetFeatureString() << '\0';
+
+    return hashOf(os.str());
+}
+
+std::string getJitCacheObjectFile(llvm::StringRef key)
+{
+    return getJitCacheFile(key, ".o");
+}
+
+std::unique_ptr<llvm::MemoryBuffer> loadJitCache(llvm::StringRef key)
+{
+    if (key.empty())
+    {
+        return nullptr;
+    }
+
+    auto depsOrErr = llvm::MemoryBuffer::getFile(getJitCacheFile(key, ".deps"));
+    if (!depsOrErr)
+    {
+        return nullptr;
+    }
+
+    llvm::SmallVector<llvm::StringRef> lines;
+    (*depsOrErr)->getBuffer().split(lines, '\n', -1, false);
+    for (auto line : lines)
+    {
+        auto [hash, path] = line.split(' ');
+        auto fileOrErr = llvm::MemoryBuffer::getFile(path);
+        if (!fileOrErr || hashOf((*fileOrErr)->getBuffer()) != hash)
+        {
+            LLVM_DEBUG(llvm::dbgs() << "\n!! JIT cache: changed dependency: " << path << "\n";);
+            return nullptr;
+        }
+    }
+
+    auto objectOrErr = llvm::MemoryBuffer::getFile(getJitCacheObjectFile(key));
+    if (!objectOrErr)
+    {
+        return nullptr;
+    }
+
+    LLVM_DEBUG(llvm::dbgs() << "\n!! JIT cache: hit: " << key << "\n";);
+
+    return std::move(*objectOrErr);
+}
+
+void storeJitCacheDependencies(llvm::StringRef key, llvm::SourceMgr &sourceMgr)
+{
+    writeJitCacheFile(getJitCacheFile(key, ".deps"), [&](llvm::StringRef tempFile) {
+        std::error_code ec;
+        llvm::raw_fd_ostream os(tempFile, ec, llvm::sys::fs::OF_None);
+        if (ec)
+        {
+            return;
+        }
+
+        // main file is a part of the key
+        for (auto id = sourceMgr.getMainFileID() + 1; id <= sourceMgr.getNumBuffers(); id++)
+        {
+            const auto *buffer = sourceMgr.getMemoryBuffer(id);
+            llvm::SmallString<256> path(buffer->getBufferIdentifier());
+            llvm::sys::fs::make_absolute(path);
+            os << hashOf(buffer->getBuffer()) << ' ' << path << '\n';
+        }
+    });
+}
+
+// dependencies of the key are removed before object and written again after it (storeJitCacheDependencies),
+// so object is never paired with dependencies of other compilation
+bool storeJitCacheObject(llvm::StringRef objectFile, llvm::function_ref<void(llvm::StringRef)> write)
+{
+    llvm::SmallString<256> depsFile(objectFile);
+    llvm::sys::path::replace_extension(depsFile, ".deps");
+    llvm::sys::fs::remove(depsFile);
+
+    return writeJitCacheFile(objectFile, write);
+}
@@ -1,8 +1,10 @@
 #include "mlir/ExecutionEngine/ExecutionEngine.h"
 #include "mlir/IR/BuiltinOps.h"
+#include "mlir/Support/Timing.h"
 #include "mlir/Target/LLVMIR/Export.h"
 
 // for dump obj
+#include "llvm/ExecutionEngine/Orc/JITTargetMachineBuilder.h"
 #include "llvm/IR/LegacyPassManager.h"
 #include "llvm/IR/Verifier.h"
 #include "llvm/CodeGen/CommandFlags.h"
@@ -13,8 +15,12 @@
 #include "llvm/IR/DiagnosticPrinter.h"
 #include "llvm/MC/MCTargetOptionsCommandFlags.h"
 #include "llvm/Analysis/TargetLibraryInfo.h"
+#include "llvm/Analysis/ModuleSummaryAnalysis.h"
+#include "llvm/Analysis/ProfileSummaryInfo.h"
+#include "llvm/Bitcode/BitcodeWriter.h"
 
 #include "llvm/TargetParser/Host.h"
+#include "llvm/TargetParser/SubtargetFeature.h"
 #include "llvm/Support/ToolOutputFile.h"
 #include "llvm/Support/CommandLine.h"
 #include "llvm/Support/TargetSelect.h"
@@ -34,11 +40,14 @@ extern cl::opt<bool> enableOpt;
 extern cl::opt<int> optLevel;
 extern cl::opt<int> sizeLevel;
 extern cl::opt<std::string> outputFilename;
+extern cl::opt<std::string> profileUse;
+extern cl::opt<enum LTOMode> ltoMode;
 
 std::string getDefaultOutputFileName(enum Action);
 std::unique_ptr<llvm::ToolOutputFile> getOutputStream(enum Action, std::string);
 int registerMLIRDialects(mlir::ModuleOp);
-std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&);
+std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&, llvm::TargetMachine *);
+mlir::TimingScope &getRootTiming();
 
 static llvm::codegen::RegisterCodeGenFlags CGF;
 
@@ -247,6 +256,45 @@ int setupTargetTriple(llvm::Module *llvmModule, std::unique_ptr<llvm::TargetMach
     return 0;
 }
 
+// Target machine of host for JIT, CPU and features can be changed by -mcpu (-mcpu=native) and -mattr
+std::unique_ptr<llvm::TargetMachine> createJITTargetMachine()
+{
+    auto tmBuilderOrError = llvm::orc::JITTargetMachineBuilder::detectHost();
+    if (!tmBuilderOrError)
+    {
+        llvm::WithColor::error(llvm::errs(), "tsc") << "Failed to detect host: " << tmBuilderOrError.takeError() << "\n";
+        return nullptr;
+    }
+
+    auto &tmBuilder = *tmBuilderOrError;
+
+    auto CPUStr = llvm::codegen::getCPUStr();
+    if (!CPUStr.empty())
+    {
+        tmBuilder.setCPU(CPUStr);
+    }
+
+    auto Features = llvm::codegen::getFeaturesStr();
+    if (!Features.empty())
+    {
+        tmBuilder.addFeatures(llvm::SubtargetFeatures(Features).getFeatures());
+    }
+
+    if (auto Level = llvm::CodeGenOpt::parseLevel(enableOpt ? mapToLevel(optLevel) : '0')) 
+    {
+        tmBuilder.setCodeGenOptLevel(*Level);
+    }
+
+    auto tmOrError = tmBuilder.createTargetMachine();
+    if (!tmOrError)
+    {
+        llvm::WithColor::error(llvm::errs(), "tsc") << "Failed to create target machine: " << tmOrError.takeError() << "\n";
+        return nullptr;
+    }
+
+    return std::move(*tmOrError);
+}
+
 int dumpObjOrAssembly(int argc, char **argv, enum Action emitAction, std::string outputFile, mlir::ModuleOp module, CompileOptions &compileOptions)
 {
     registerMLIRDialects(module);
@@ -273,7 +321,13 @@ int dumpObjOrAssembly(int argc, char **argv, enum Action emitAction, std::string
         return retCode;
     }
 
-    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions);
+    if (!profileUse.empty() && Target->getTargetTriple().isOSBinFormatELF())
+    {
+        // cold blocks by profile are moved out of functions into .text.split. sections
+        Target->Options.EnableMachineFunctionSplitter = true;
+    }
+
+    auto optPipeline = getTransformer(enableOpt, optLevel, sizeLevel, compileOptions, Target.get());
     if (auto err = optPipeline(llvmModule.get()))
     {
         llvm::WithColor::error(llvm::errs(), "tsc") << "Failed to optimize LLVM IR " << err << "\n";
@@ -324,6 +378,26 @@ int dumpObjOrAssembly(int argc, char **argv, enum Action emitAction, std::string
         return -1;        
     }
 
+    // assembly is always generated by target, --lto changes object files only
+    if (ltoMode != LTONone && emitAction != DumpAssembly)
+    {
+        // code generation is done by linker, object file is LLVM bitcode
+        if (ltoMode == LTOThin)
+        {
+            // summary is needed by ThinLTO to import functions across modules
+            llvm::ProfileSummaryInfo PSI(*llvmModule);
+            auto index = llvm::buildModuleSummaryIndex(*llvmModule, nullptr, &PSI);
+            llvm::WriteBitcodeToFile(*llvmModule, FDOut->os(), false, &index);
+        }
+        else
+        {
+            llvm::WriteBitcodeToFile(*llvmModule, FDOut->os());
+        }
+
+        FDOut->keep();
+        return 0;
+    }
+
     auto fileFormat = emitAction == DumpObj ? llvm::CGFT_ObjectFile : emitAction == DumpAssembly ? llvm::CGFT_AssemblyFile : llvm::CGFT_Null;
     if (llvm::mc::getExplicitRelaxAll() && /*llvm::codegen::getFileType()*/ fileFormat != llvm::CGFT_ObjectFile)
     {
@@ -359,7 +433,9 @@ int dumpObjOrAssembly(int argc, char **argv, enum Action emitAction, std::string
         // Before executing passes, print the final values of the LLVM options.
         //llvm::cl::PrintOptionValues();
 
+        auto emitTiming = getRootTiming().nest("emit-object");
         PM.run(*llvmModule.get());
+        emitTiming.stop();
 
         auto HasError = ((const LLCDiagnosticHandler *)(Context.getDiagHandlerPtr()))->HasError;
         if (*HasError)
@@ -22,6 +22,8 @@ extern cl::opt<std::string> TargetTriple;
 extern cl::opt<enum Exports> exportAction;
 extern cl::opt<bool> enableBuiltins;
 extern cl::opt<bool> noDefaultLib;
+extern cl::opt<bool> typeCacheStats;
+extern cl::opt<bool> allocProfile;
 
 // obj
 extern cl::opt<std::string> TargetTriple;
@@ -43,9 +45,17 @@ CompileOptions prepareOptions()
     compileOptions.exportOpt = exportAction;
     compileOptions.generateDebugInfo = generateDebugInfo;
     compileOptions.lldbDebugInfo = lldbDebugInfo;
+    compileOptions.typeCacheStats = typeCacheStats;
     compileOptions.moduleTargetTriple = moduleTargetTriple;
     compileOptions.isWindows = TheTriple.isKnownWindowsMSVCEnvironment();
     compileOptions.isWasm = TheTriple.getArch() == llvm::Triple::wasm64 || TheTriple.getArch() == llvm::Triple::wasm32;
+    // wasm is linked without runtime libraries, so profiled entry points of collector are not there
+    if (allocProfile && compileOptions.isWasm)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--alloc-profile is ignored for WebAssembly\n";
+    }
+
+    compileOptions.allocProfile = allocProfile && !disableGC && !compileOptions.isWasm;
     compileOptions.sizeBits = 32;
     if (
         TheTriple.getArch() == llvm::Triple::UnknownArch
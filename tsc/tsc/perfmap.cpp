@@ -0,0 +1,145 @@
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Demangle/Demangle.h"
+#include "llvm/ExecutionEngine/JITEventListener.h"
+#include "llvm/ExecutionEngine/RuntimeDyld.h"
+#include "llvm/Object/ObjectFile.h"
+#include "llvm/Object/SymbolSize.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Process.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include <mutex>
+
+#define DEBUG_TYPE "tsc"
+
+namespace cl = llvm::cl;
+
+extern cl::opt<bool> perfMap;
+extern cl::opt<bool> jitDump;
+
+// Profiling of JIT-ed code by Linux perf:
+//  - --perf-map appends "<address> <size> <name>" of every function of loaded object to /tmp/perf-<pid>.map,
+//    perf reads it at "perf report" time
+//  - --jitdump uses PerfJITEventListener of LLVM (LLVM built with LLVM_USE_PERF), which writes
+//    jit-<pid>.dump for "perf inject --jit"
+
+namespace
+{
+
+class PerfMapListener : public llvm::JITEventListener
+{
+  public:
+    void notifyObjectLoaded(ObjectKey key, const llvm::object::ObjectFile &obj,
+                            const llvm::RuntimeDyld::LoadedObjectInfo &loadedObjectInfo) override
+    {
+        // addresses of symbols in debug object are addresses of loaded sections
+        auto debugObjOwner = loadedObjectInfo.getObjectForDebug(obj);
+        auto *debugObj = debugObjOwner.getBinary();
+        if (!debugObj)
+        {
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!open())
+        {
+            return;
+        }
+
+        for (auto &symbolSize : llvm::object::computeSymbolSizes(*debugObj))
+        {
+            auto symbol = symbolSize.first;
+
+            auto type = symbol.getType();
+            if (!type || *type != llvm::object::SymbolRef::ST_Function)
+            {
+                llvm::consumeError(type.takeError());
+                continue;
+            }
+
+            auto name = symbol.getName();
+            if (!name)
+            {
+                llvm::consumeError(name.takeError());
+                continue;
+            }
+
+            auto address = symbol.getAddress();
+            if (!address)
+            {
+                llvm::consumeError(address.takeError());
+                continue;
+            }
+
+            if (symbolSize.second == 0)
+            {
+                continue;
+            }
+
+            // names of TypeScript functions are not mangled, demangle() keeps them as is
+            *os << llvm::format_hex_no_prefix(*address, 1) << ' ' << llvm::format_hex_no_prefix(symbolSize.second, 1) << ' '
+                << llvm::demangle(name->str()) << '\n';
+        }
+
+        os->flush();
+    }
+
+  private:
+    bool open()
+    {
+        if (os || failed)
+        {
+            return !failed;
+        }
+
+        llvm::SmallString<64> path;
+        (llvm::Twine("/tmp/perf-") + llvm::Twine(llvm::sys::Process::getProcessId()) + ".map").toVector(path);
+
+        std::error_code ec;
+        os = std::make_unique<llvm::raw_fd_ostream>(path, ec, llvm::sys::fs::OF_Append | llvm::sys::fs::OF_Text);
+        if (ec)
+        {
+            llvm::WithColor::warning(llvm::errs(), "tsc") << "Could not write perf map " << path << ": " << ec.message() << "\n";
+            os.reset();
+            failed = true;
+        }
+
+        return !failed;
+    }
+
+    // objects are loaded by compile threads of lazy and tiered JIT
+    std::mutex mutex;
+    std::unique_ptr<llvm::raw_fd_ostream> os;
+    bool failed = false;
+};
+
+} // namespace
+
+// listeners are shared by all object layers of the process
+void registerPerfJITEventListeners(llvm::function_ref<void(llvm::JITEventListener &)> registerListener)
+{
+    if (perfMap)
+    {
+        static PerfMapListener perfMapListener;
+        registerListener(perfMapListener);
+    }
+
+    if (jitDump)
+    {
+        static auto *perfJITEventListener = llvm::JITEventListener::createPerfJITEventListener();
+        if (!perfJITEventListener)
+        {
+            static std::once_flag warned;
+            std::call_once(warned, []() {
+                llvm::WithColor::warning(llvm::errs(), "tsc") << "--jitdump is not supported, LLVM is built without LLVM_USE_PERF\n";
+            });
+            return;
+        }
+
+        registerListener(*perfJITEventListener);
+    }
+}
@@ -0,0 +1,449 @@
+#include "TypeScript/DataStructs.h"
+
+#include "mlir/IR/BuiltinOps.h"
+
+#include "llvm/ExecutionEngine/Orc/CompileUtils.h"
+#include "llvm/ExecutionEngine/Orc/IndirectionUtils.h"
+#include "llvm/ExecutionEngine/Orc/LLJIT.h"
+#include "llvm/IR/IRBuilder.h"
+#include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Module.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Debug.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/Utils/BasicBlockUtils.h"
+#include "llvm/Transforms/Utils/Cloning.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#define DEBUG_TYPE "tsc"
+
+namespace cl = llvm::cl;
+
+extern cl::opt<int> optLevel;
+extern cl::opt<int> sizeLevel;
+extern cl::opt<unsigned> jitTierThreshold;
+
+using RuntimeSymbolMapFn = std::function<llvm::orc::SymbolMap(llvm::orc::MangleAndInterner)>;
+
+std::function<llvm::Error(llvm::Module *)> getTransformer(bool, int, int, CompileOptions&, llvm::TargetMachine *);
+int reportJitError(llvm::StringRef, llvm::Error);
+llvm::Expected<std::unique_ptr<llvm::orc::ObjectLayer>> createObjectLinkingLayer(llvm::orc::ExecutionSession &, const llvm::Triple &);
+llvm::orc::JITTargetMachineBuilder getJITTargetMachineBuilder(llvm::TargetMachine &);
+int defineJitSymbols(llvm::orc::LLJIT &, RuntimeSymbolMapFn, bool &);
+int invokeJitMain(llvm::orc::LLJIT &);
+std::unique_ptr<llvm::Module> translateModuleForJit(mlir::ModuleOp, llvm::LLVMContext &, llvm::orc::LLJIT &);
+
+// Tiered JIT (--tiered-jit):
+//  - every function "f" is called through indirect stub "f" of IndirectStubsManager
+//  - tier 0: the whole module is compiled without optimization, bodies are named "f$t0" and count calls at entry
+//  - when counter of "f" reaches --jit-tier-threshold, "f" is optimized (--opt_level) and compiled alone on
+//    background thread into "f$t1" and the stub is redirected to it, running frames of "f$t0" stay valid
+
+namespace
+{
+
+static const char *TIER_UP_FUNC_NAME = "__tsc_jit_tier_up";
+
+class TieredJit
+{
+  public:
+    TieredJit(std::unique_ptr<llvm::orc::LLJIT> jit, std::unique_ptr<llvm::orc::IndirectStubsManager> stubs,
+              std::unique_ptr<llvm::TargetMachine> tier0TargetMachine, std::unique_ptr<llvm::TargetMachine> tier1TargetMachine,
+              std::function<llvm::Error(llvm::Module *)> tier0Pipeline, std::function<llvm::Error(llvm::Module *)> tier1Pipeline)
+        : jit(std::move(jit)), stubs(std::move(stubs)), tier0TargetMachine(std::move(tier0TargetMachine)),
+          tier1TargetMachine(std::move(tier1TargetMachine)), tier0Pipeline(tier0Pipeline), tier1Pipeline(tier1Pipeline)
+    {
+        current = this;
+    }
+
+    ~TieredJit()
+    {
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            stopping = true;
+        }
+
+        queueCondition.notify_one();
+        if (compileThread.joinable())
+        {
+            compileThread.join();
+        }
+
+        current = nullptr;
+    }
+
+    llvm::orc::LLJIT &getJit()
+    {
+        return *jit;
+    }
+
+    llvm::Error addModule(std::unique_ptr<llvm::Module> module, std::unique_ptr<llvm::LLVMContext> context)
+    {
+        llvmContext = std::move(context);
+        llvmModule = std::move(module);
+
+        exposeLocalSymbols();
+
+        for (auto &func : *llvmModule)
+        {
+            if (!func.isDeclaration() && !func.isIntrinsic())
+            {
+                functions.push_back(&func);
+            }
+        }
+
+        tierUpRequested = std::make_unique<std::atomic<bool>[]>(functions.size());
+
+        if (auto err = defineStubs())
+        {
+            return err;
+        }
+
+        if (auto err = addTier0())
+        {
+            return err;
+        }
+
+        compileThread = std::thread([this]() { compileLoop(); });
+        return llvm::Error::success();
+    }
+
+    static void tierUp(int32_t index)
+    {
+        if (current)
+        {
+            current->requestTierUp(index);
+        }
+    }
+
+  private:
+    // functions of different tiers are in different objects, so all symbols must be visible for linker
+    void exposeLocalSymbols()
+    {
+        auto index = 0;
+        for (auto &globalValue : llvmModule->global_values())
+        {
+            if (!globalValue.hasLocalLinkage())
+            {
+                continue;
+            }
+
+            if (!globalValue.hasName())
+            {
+                globalValue.setName(".anon");
+            }
+
+            globalValue.setName(globalValue.getName() + "$" + llvm::Twine(index++));
+            globalValue.setLinkage(llvm::GlobalValue::ExternalLinkage);
+            globalValue.setVisibility(llvm::GlobalValue::HiddenVisibility);
+        }
+    }
+
+    llvm::Error defineStubs()
+    {
+        llvm::StringMap<std::pair<llvm::orc::ExecutorAddr, llvm::JITSymbolFlags>> stubInits;
+        for (auto *func : functions)
+        {
+            stubInits[func->getName()] = {llvm::orc::ExecutorAddr(),
+                                          llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+        }
+
+        if (auto err = stubs->createStubs(stubInits))
+        {
+            return err;
+        }
+
+        llvm::orc::MangleAndInterner interner(jit->getExecutionSession(), jit->getDataLayout());
+        llvm::orc::SymbolMap stubSymbols;
+        for (auto *func : functions)
+        {
+            auto stub = stubs->findStub(func->getName(), false);
+            stubSymbols[interner(func->getName())] = {stub.getAddress(), stub.getFlags()};
+        }
+
+        stubSymbols[interner(TIER_UP_FUNC_NAME)] = {llvm::orc::ExecutorAddr::fromPtr(&TieredJit::tierUp),
+                                                    llvm::JITSymbolFlags::Exported | llvm::JITSymbolFlags::Callable};
+
+        return jit->getMainJITDylib().define(llvm::orc::absoluteSymbols(std::move(stubSymbols)));
+    }
+
+    llvm::Error addTier0()
+    {
+        auto tier0Module = llvm::CloneModule(*llvmModule);
+
+        auto &context = tier0Module->getContext();
+        auto *i32Type = llvm::Type::getInt32Ty(context);
+        auto tierUpFunc = tier0Module->getOrInsertFunction(
+            TIER_UP_FUNC_NAME, llvm::FunctionType::get(llvm::Type::getVoidTy(context), {i32Type}, false));
+
+        for (auto index = 0u; index < functions.size(); index++)
+        {
+            auto name = functions[index]->getName();
+            auto *func = tier0Module->getFunction(name);
+
+            // all references to function (calls, pointers) use the stub
+            func->setName(name + "$t0");
+            auto *stubDecl = llvm::Function::Create(func->getFunctionType(), llvm::GlobalValue::ExternalLinkage, name,
+                                                   tier0Module.get());
+            stubDecl->copyAttributesFrom(func);
+            stubDecl->setLinkage(llvm::GlobalValue::ExternalLinkage);
+            stubDecl->setVisibility(llvm::GlobalValue::DefaultVisibility);
+            func->replaceAllUsesWith(stubDecl);
+
+            insertCallCounter(*func, index, tierUpFunc);
+        }
+
+        if (auto err = tier0Pipeline(tier0Module.get()))
+        {
+            return err;
+        }
+
+        llvm::orc::SimpleCompiler compiler(*tier0TargetMachine);
+        auto object = compiler(*tier0Module);
+        if (!object)
+        {
+            return object.takeError();
+        }
+
+        if (auto err = jit->addObjectFile(std::move(*object)))
+        {
+            return err;
+        }
+
+        for (auto *func : functions)
+        {
+            auto address = jit->lookup((func->getName() + "$t0").str());
+            if (!address)
+            {
+                return address.takeError();
+            }
+
+            if (auto err = stubs->updatePointer(func->getName(), *address))
+            {
+                return err;
+            }
+        }
+
+        return llvm::Error::success();
+    }
+
+    // if (atomic ++f$calls == threshold) __tsc_jit_tier_up(index);
+    // functions are called by many threads, relaxed order is enough as only one of them sees the threshold
+    void insertCallCounter(llvm::Function &func, unsigned index, llvm::FunctionCallee tierUpFunc)
+    {
+        auto *module = func.getParent();
+        auto *i32Type = llvm::Type::getInt32Ty(module->getContext());
+
+        auto *counter = new llvm::GlobalVariable(*module, i32Type, false, llvm::GlobalValue::InternalLinkage,
+                                                 llvm::ConstantInt::get(i32Type, 0), func.getName() + "$calls");
+
+        // allocas stay in entry block
+        auto insertPoint = func.getEntryBlock().getFirstInsertionPt();
+        while (llvm::isa<llvm::AllocaInst>(*insertPoint))
+        {
+            ++insertPoint;
+        }
+
+        llvm::IRBuilder<> builder(&*insertPoint);
+        auto *oldCalls = builder.CreateAtomicRMW(llvm::AtomicRMWInst::Add, counter, builder.getInt32(1), llvm::MaybeAlign(),
+                                                 llvm::AtomicOrdering::Monotonic);
+        auto *calls = builder.CreateAdd(oldCalls, builder.getInt32(1));
+        auto *isHot = builder.CreateICmpEQ(calls, builder.getInt32(jitTierThreshold));
+
+        auto *thenTerm = llvm::SplitBlockAndInsertIfThen(isHot, &*builder.GetInsertPoint(), false);
+        builder.SetInsertPoint(thenTerm);
+        builder.CreateCall(tierUpFunc, {builder.getInt32(index)});
+    }
+
+    void requestTierUp(int32_t index)
+    {
+        if (index < 0 || (size_t)index >= functions.size() || tierUpRequested[index].exchange(true))
+        {
+            return;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(queueMutex);
+            queue.push_back(index);
+        }
+
+        queueCondition.notify_one();
+    }
+
+    void compileLoop()
+    {
+        while (true)
+        {
+            int32_t index;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex);
+                queueCondition.wait(lock, [&]() { return stopping || !queue.empty(); });
+                if (stopping)
+                {
+                    return;
+                }
+
+                index = queue.front();
+                queue.pop_front();
+            }
+
+            // module and its context are used only by this thread after tier 0
+            if (auto err = addTier1(index))
+            {
+                LLVM_DEBUG(llvm::dbgs() << "\n!! tiered JIT: failed to optimize " << functions[index]->getName() << ": "
+                                        << llvm::toString(std::move(err)) << "\n";);
+                llvm::consumeError(std::move(err));
+            }
+        }
+    }
+
+    llvm::Error addTier1(int32_t index)
+    {
+        auto *origFunc = functions[index];
+        auto name = origFunc->getName();
+
+        // other functions and globals are declarations, they are resolved to stubs and tier 0 object
+        llvm::ValueToValueMapTy valueMap;
+        auto tier1Module = llvm::CloneModule(
+            *llvmModule, valueMap, [&](const llvm::GlobalValue *globalValue) { return globalValue == origFunc; });
+
+        // llvm.global_ctors and others are already in tier 0 object
+        for (auto &global : llvm::make_early_inc_range(tier1Module->globals()))
+        {
+            if (global.getName().starts_with("llvm.") && global.isDeclaration())
+            {
+                global.eraseFromParent();
+            }
+        }
+
+        auto *func = tier1Module->getFunction(name);
+        auto tier1Name = (name + "$t1").str();
+        func->setName(tier1Name);
+        auto *stubDecl = llvm::Function::Create(func->getFunctionType(), llvm::GlobalValue::ExternalLinkage, name,
+                                               tier1Module.get());
+        stubDecl->copyAttributesFrom(func);
+        stubDecl->setLinkage(llvm::GlobalValue::ExternalLinkage);
+        stubDecl->setVisibility(llvm::GlobalValue::DefaultVisibility);
+        func->replaceAllUsesWith(stubDecl);
+
+        if (auto err = tier1Pipeline(tier1Module.get()))
+        {
+            return err;
+        }
+
+        llvm::orc::SimpleCompiler compiler(*tier1TargetMachine);
+        auto object = compiler(*tier1Module);
+        if (!object)
+        {
+            return object.takeError();
+        }
+
+        if (auto err = jit->addObjectFile(std::move(*object)))
+        {
+            return err;
+        }
+
+        auto address = jit->lookup(tier1Name);
+        if (!address)
+        {
+            return address.takeError();
+        }
+
+        LLVM_DEBUG(llvm::dbgs() << "\n!! tiered JIT: optimized " << name << "\n";);
+
+        // the stub is one pointer, calls which are in progress complete in tier 0 code
+        return stubs->updatePointer(name, *address);
+    }
+
+    static TieredJit *current;
+
+    std::unique_ptr<llvm::orc::LLJIT> jit;
+    std::unique_ptr<llvm::orc::IndirectStubsManager> stubs;
+    std::unique_ptr<llvm::TargetMachine> tier0TargetMachine;
+    std::unique_ptr<llvm::TargetMachine> tier1TargetMachine;
+    std::function<llvm::Error(llvm::Module *)> tier0Pipeline;
+    std::function<llvm::Error(llvm::Module *)> tier1Pipeline;
+
+    std::unique_ptr<llvm::LLVMContext> llvmContext;
+    std::unique_ptr<llvm::Module> llvmModule;
+    std::vector<llvm::Function *> functions;
+    std::unique_ptr<std::atomic<bool>[]> tierUpRequested;
+
+    std::thread compileThread;
+    std::mutex queueMutex;
+    std::condition_variable queueCondition;
+    std::deque<int32_t> queue;
+    bool stopping = false;
+};
+
+TieredJit *TieredJit::current = nullptr;
+
+} // namespace
+
+int runTieredJit(mlir::ModuleOp module, CompileOptions &compileOptions, llvm::TargetMachine &targetMachine,
+                 RuntimeSymbolMapFn runtimeSymbolMap, bool &noGC)
+{
+    auto tier0Builder = getJITTargetMachineBuilder(targetMachine);
+    tier0Builder.setCodeGenOptLevel(llvm::CodeGenOpt::None);
+    auto tier0TargetMachine = tier0Builder.createTargetMachine();
+    if (!tier0TargetMachine)
+    {
+        return reportJitError("JIT initialization failed", tier0TargetMachine.takeError());
+    }
+
+    auto tier1Builder = getJITTargetMachineBuilder(targetMachine);
+    tier1Builder.setCodeGenOptLevel(llvm::CodeGenOpt::Aggressive);
+    auto tier1TargetMachine = tier1Builder.createTargetMachine();
+    if (!tier1TargetMachine)
+    {
+        return reportJitError("JIT initialization failed", tier1TargetMachine.takeError());
+    }
+
+    auto maybeJit = llvm::orc::LLJITBuilder()
+        .setJITTargetMachineBuilder(getJITTargetMachineBuilder(targetMachine))
+        .setObjectLinkingLayerCreator(createObjectLinkingLayer)
+        .create();
+    if (!maybeJit)
+    {
+        return reportJitError("JIT initialization failed", maybeJit.takeError());
+    }
+
+    auto &jit = *maybeJit;
+    if (auto error = defineJitSymbols(*jit, runtimeSymbolMap, noGC))
+    {
+        return error;
+    }
+
+    auto stubsManagerBuilder = llvm::orc::createLocalIndirectStubsManagerBuilder(jit->getTargetTriple());
+    if (!stubsManagerBuilder)
+    {
+        llvm::WithColor::error(llvm::errs(), "tsc") << "Tiered JIT is not supported for the target, use JIT without --tiered-jit\n";
+        return -1;
+    }
+
+    auto llvmContext = std::make_unique<llvm::LLVMContext>();
+    auto llvmModule = translateModuleForJit(module, *llvmContext, *jit);
+    if (!llvmModule)
+    {
+        return -1;
+    }
+
+    auto tier0Pipeline = getTransformer(false, 0, 0, compileOptions, tier0TargetMachine->get());
+    auto tier1Pipeline = getTransformer(true, optLevel, sizeLevel, compileOptions, tier1TargetMachine->get());
+
+    TieredJit tieredJit(std::move(jit), stubsManagerBuilder(), std::move(*tier0TargetMachine),
+                        std::move(*tier1TargetMachine), tier0Pipeline, tier1Pipeline);
+    if (auto err = tieredJit.addModule(std::move(llvmModule), std::move(llvmContext)))
+    {
+        return reportJitError("JIT adding module failed", std::move(err));
+    }
+
+    return invokeJitMain(tieredJit.getJit());
+}
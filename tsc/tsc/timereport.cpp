@@ -0,0 +1,242 @@
+#include "TypeScript/DataStructs.h"
+
+#include "mlir/Support/Timing.h"
+
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/WithColor.h"
+#include "llvm/Support/raw_ostream.h"
+
+#include "TypeScript/TypeScriptCompiler/Defines.h"
+
+#include <chrono>
+#include <mutex>
+#include <thread>
+
+#define DEBUG_TYPE "tsc"
+
+namespace cl = llvm::cl;
+
+extern cl::opt<std::string> inputFilename;
+extern cl::opt<enum TimeReport> timeReport;
+extern cl::opt<std::string> timeReportFile;
+
+// Time report (--time-report=text|json):
+//  - phases are nested timers of mlir::TimingManager: parse, discovery, codegen (MLIRGen), mlir-lowering (with
+//    timers of passes), llvm-opt, emit-object
+//  - "text" is printed by mlir::DefaultTimingManager, "json" by JsonTimingManager below
+//  - counters of code generator are summed for all compiled files
+
+namespace
+{
+
+// timers are nested per thread, timers with the same name are merged when printed
+class JsonTimingManager : public mlir::TimingManager
+{
+  public:
+    JsonTimingManager() : root("total")
+    {
+    }
+
+    void print(llvm::raw_ostream &os, const CompileStatistics &statistics)
+    {
+        llvm::json::OStream json(os, 2);
+        json.object([&]() {
+            json.attribute("version", 1);
+            json.attribute("input", inputFilename.getValue());
+            json.attribute("wall", root.seconds());
+            json.attributeArray("phases", [&]() { printPhases(json, {&root}); });
+            json.attributeObject("statistics", [&]() {
+                json.attribute("statements", statistics.statements);
+                json.attribute("processStatementsIterations", statistics.processStatementsIterations);
+                json.attribute("genericInstantiations", statistics.genericInstantiations);
+                json.attribute("evaluateCalls", statistics.evaluateCalls);
+            });
+        });
+
+        os << "\n";
+    }
+
+  protected:
+    std::optional<void *> rootTimer() override
+    {
+        return &root;
+    }
+
+    void startTimer(void *handle) override
+    {
+        static_cast<TimerNode *>(handle)->start = std::chrono::steady_clock::now();
+    }
+
+    void stopTimer(void *handle) override
+    {
+        auto *timer = static_cast<TimerNode *>(handle);
+        timer->wall += std::chrono::steady_clock::now() - timer->start;
+        timer->count++;
+    }
+
+    void *nestTimer(void *handle, const void *id, llvm::function_ref<std::string()> nameBuilder) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto &child = static_cast<TimerNode *>(handle)->children[{id, std::this_thread::get_id()}];
+        if (!child)
+        {
+            child = std::make_unique<TimerNode>(nameBuilder());
+        }
+
+        return child.get();
+    }
+
+    void hideTimer(void *handle) override
+    {
+    }
+
+  private:
+    struct TimerNode
+    {
+        TimerNode(std::string name) : name(std::move(name))
+        {
+        }
+
+        double seconds() const
+        {
+            return std::chrono::duration<double>(wall).count();
+        }
+
+        std::string name;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::steady_clock::duration wall{};
+        unsigned count = 0;
+        llvm::MapVector<std::pair<const void *, std::thread::id>, std::unique_ptr<TimerNode>> children;
+    };
+
+    void printPhases(llvm::json::OStream &json, llvm::ArrayRef<TimerNode *> timers)
+    {
+        llvm::MapVector<llvm::StringRef, llvm::SmallVector<TimerNode *>> phases;
+        for (auto *timer : timers)
+        {
+            for (auto &child : timer->children)
+            {
+                phases[child.second->name].push_back(child.second.get());
+            }
+        }
+
+        for (auto &phase : phases)
+        {
+            std::chrono::steady_clock::duration wall{};
+            auto count = 0u;
+            for (auto *timer : phase.second)
+            {
+                wall += timer->wall;
+                count += timer->count;
+            }
+
+            json.object([&]() {
+                json.attribute("name", phase.first);
+                json.attribute("wall", std::chrono::duration<double>(wall).count());
+                json.attribute("count", count);
+                json.attributeArray("phases", [&]() { printPhases(json, phase.second); });
+            });
+        }
+    }
+
+    TimerNode root;
+    std::mutex mutex;
+};
+
+std::unique_ptr<mlir::TimingManager> timingManager;
+mlir::TimingScope rootTiming;
+CompileStatistics compileStatistics;
+std::mutex compileStatisticsMutex;
+
+} // namespace
+
+void initTimeReport()
+{
+    if (timeReport == TimeReportJson)
+    {
+        timingManager = std::make_unique<JsonTimingManager>();
+    }
+    else
+    {
+        // --mlir-timing is used when --time-report is not set
+        auto defaultTimingManager = std::make_unique<mlir::DefaultTimingManager>();
+        mlir::applyDefaultTimingManagerCLOptions(*defaultTimingManager);
+        if (timeReport == TimeReportText)
+        {
+            defaultTimingManager->setEnabled(true);
+            defaultTimingManager->setDisplayMode(mlir::DefaultTimingManager::DisplayMode::Tree);
+        }
+
+        timingManager = std::move(defaultTimingManager);
+    }
+
+    rootTiming = timingManager->getRootScope();
+}
+
+mlir::TimingScope &getRootTiming()
+{
+    return rootTiming;
+}
+
+void addCompileStatistics(const CompileStatistics &statistics)
+{
+    std::lock_guard<std::mutex> lock(compileStatisticsMutex);
+    compileStatistics.statements += statistics.statements;
+    compileStatistics.processStatementsIterations += statistics.processStatementsIterations;
+    compileStatistics.genericInstantiations += statistics.genericInstantiations;
+    compileStatistics.evaluateCalls += statistics.evaluateCalls;
+}
+
+void printTimeReport()
+{
+    if (!timingManager)
+    {
+        return;
+    }
+
+    rootTiming.stop();
+    rootTiming = mlir::TimingScope();
+
+    if (timeReport == TimeReportNone)
+    {
+        // --mlir-timing report is printed by DefaultTimingManager
+        timingManager.reset();
+        return;
+    }
+
+    // stdout is used by JIT-ed code, so report goes to stderr by default
+    std::unique_ptr<llvm::raw_fd_ostream> fileStream;
+    if (!timeReportFile.empty())
+    {
+        std::error_code ec;
+        fileStream = std::make_unique<llvm::raw_fd_ostream>(timeReportFile, ec, llvm::sys::fs::OF_Text);
+        if (ec)
+        {
+            llvm::WithColor::error(llvm::errs(), "tsc") << "Could not write time report: " << ec.message() << "\n";
+            fileStream.reset();
+        }
+    }
+
+    auto &os = fileStream ? *fileStream : llvm::errs();
+    if (timeReport == TimeReportJson)
+    {
+        static_cast<JsonTimingManager *>(timingManager.get())->print(os, compileStatistics);
+        timingManager.reset();
+        return;
+    }
+
+    // DefaultTimingManager prints report when destroyed
+    static_cast<mlir::DefaultTimingManager *>(timingManager.get())->setOutput(os);
+    timingManager.reset();
+
+    os << "===-------------------------------------------------------------------------===\n"
+       << "                         Code generator statistics\n"
+       << "===-------------------------------------------------------------------------===\n"
+       << "  " << compileStatistics.statements << " statements\n"
+       << "  " << compileStatistics.processStatementsIterations << " processStatements iterations\n"
+       << "  " << compileStatistics.genericInstantiations << " generic instantiations\n"
+       << "  " << compileStatistics.evaluateCalls << " evaluate() calls\n";
+}
@@ -24,6 +24,7 @@
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/Pass/PassManager.h"
+#include "mlir/Support/Timing.h"
 #include "mlir/InitAllDialects.h"
 #include "mlir/InitAllPasses.h"
 #include "mlir/Target/LLVMIR/Dialect/Builtin/BuiltinToLLVMIRTranslation.h"
@@ -35,7 +36,12 @@
 #include "llvm/Passes/OptimizationLevel.h"
 #include "llvm/Passes/PassBuilder.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/PGOOptions.h"
 #include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Target/TargetMachine.h"
+#include "llvm/Transforms/IPO/HotColdSplitting.h"
 
 #ifdef GC_ENABLE
 #include "llvm/IR/GCStrategy.h"
@@ -63,6 +69,11 @@ extern cl::opt<int> optLevel;
 extern cl::opt<int> sizeLevel;
 extern cl::opt<bool> disableGC;
 extern cl::opt<bool> disableWarnings;
+extern cl::opt<std::string> profileGenerate;
+extern cl::opt<std::string> profileUse;
+extern cl::opt<enum LTOMode> ltoMode;
+
+mlir::TimingScope &getRootTiming();
 
 int runMLIRPasses(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::OwningOpRef<mlir::ModuleOp> &module, CompileOptions &compileOptions)
 {
@@ -74,6 +85,9 @@ int runMLIRPasses(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::
     // Apply any generic pass manager command line options and run the pipeline.
     applyPassManagerCLOptions(pm);
 
+    auto timing = getRootTiming().nest("mlir-lowering");
+    pm.enableTiming(timing);
+
     // Check to see what granularity of MLIR we are compiling to.
     bool isLoweringToAffine = emitAction >= Action::DumpMLIRAffine;
     bool isLoweringToLLVM = emitAction >= Action::DumpMLIRLLVM;
@@ -89,6 +103,17 @@ int runMLIRPasses(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::
 #ifndef AFFINE_MODULE_PASS
         mlir::OpPassManager &optPM = pm.nest<mlir::typescript::FuncOp>();
 
+#ifdef ENABLE_OPT_PASSES
+        if (enableOpt)
+        {
+            // must be done before ++/-- and loops are lowered
+            optPM.addPass(mlir::typescript::createIntegerRangePass());
+            optPM.addPass(mlir::typescript::createStructuredLoopsPass());
+            // must be done before try/catch are lowered into landing pads
+            optPM.addPass(mlir::typescript::createLocalThrowPass());
+        }
+#endif
+
         // Partially lower the TypeScript dialect with a few cleanups afterwards.
         optPM.addPass(mlir::typescript::createLowerToAffineTSFuncPass(compileOptions));
         optPM.addPass(mlir::createCanonicalizerPass());
@@ -114,6 +139,7 @@ int runMLIRPasses(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::
         if (enableOpt)
         {
             optPM.addPass(mlir::createCSEPass());
+            pm.addPass(mlir::createSCFForLoopCanonicalizationPass());
             pm.addPass(mlir::createLoopInvariantCodeMotionPass());
             pm.addPass(mlir::createStripDebugInfoPass());
             pm.addPass(mlir::createInlinerPass());
@@ -139,6 +165,7 @@ int runMLIRPasses(mlir::MLIRContext &context, llvm::SourceMgr &sourceMgr, mlir::
         pm.addPass(mlir::createConvertAsyncToLLVMPass());
 #endif
         pm.addPass(mlir::typescript::createLowerToLLVMPass(compileOptions));
+        pm.addPass(mlir::typescript::createStringPoolPass());
         pm.addNestedPass<mlir::LLVM::LLVMFuncOp>(mlir::LLVM::createDIScopeForLLVMFuncOpPass());
         if (!disableGC)
         {
@@ -175,6 +202,30 @@ int registerMLIRDialects(mlir::ModuleOp module)
     return 0;
 }
 
+// the same attributes as llvm::codegen::setFunctionAttributes sets, needed when module is created by JIT
+static void setTargetFunctionAttributes(llvm::TargetMachine *targetMachine, llvm::Module &module)
+{
+    auto cpu = targetMachine->getTargetCPU();
+    auto features = targetMachine->getTargetFeatureString();
+    for (auto &func : module)
+    {
+        if (func.isDeclaration())
+        {
+            continue;
+        }
+
+        if (!cpu.empty() && !func.hasFnAttribute("target-cpu"))
+        {
+            func.addFnAttr("target-cpu", cpu);
+        }
+
+        if (!features.empty() && !func.hasFnAttribute("target-features"))
+        {
+            func.addFnAttr("target-features", features);
+        }
+    }
+}
+
 static std::optional<llvm::OptimizationLevel> mapToLevel(unsigned optLevel, unsigned sizeLevel)
 {
     switch (optLevel)
@@ -204,6 +255,30 @@ static std::optional<llvm::OptimizationLevel> mapToLevel(unsigned optLevel, unsi
     return std::nullopt;
 }
 
+// the same file names as clang uses for -fprofile-generate[=dir] and -fprofile-use=file
+static std::optional<llvm::PGOOptions> getPGOOptions(const CompileOptions &compileOptions)
+{
+    // JIT does not have profile runtime
+    if (compileOptions.isJit)
+    {
+        return std::nullopt;
+    }
+
+    if (profileGenerate.getNumOccurrences() > 0)
+    {
+        llvm::SmallString<128> profileFile(profileGenerate);
+        llvm::sys::path::append(profileFile, "default_%m.profraw");
+        return llvm::PGOOptions(std::string(profileFile), "", "", "", nullptr, llvm::PGOOptions::IRInstr);
+    }
+
+    if (!profileUse.empty())
+    {
+        return llvm::PGOOptions(profileUse, "", "", "", llvm::vfs::getRealFileSystem(), llvm::PGOOptions::IRUse);
+    }
+
+    return std::nullopt;
+}
+
 std::function<llvm::Error(llvm::Module *)> makeCustomPassesWithOptimizingTransformer(
     std::optional<unsigned> mbOptLevel, std::optional<unsigned> mbSizeLevel, llvm::TargetMachine *targetMachine, CompileOptions &compileOptions)
 {
@@ -222,7 +297,34 @@ std::function<llvm::Error(llvm::Module *)> makeCustomPassesWithOptimizingTransfo
         llvm::CGSCCAnalysisManager cgam;
         llvm::ModuleAnalysisManager mam;
 
-        llvm::PassBuilder pb(targetMachine);
+        if (targetMachine)
+        {
+            // cost models of vectorizers depend on target features
+            setTargetFunctionAttributes(targetMachine, *m);
+        }
+
+        // the same as clang does, vectorizers are enabled from O2 (and Os)
+        llvm::PipelineTuningOptions pto;
+        pto.LoopVectorization = ol->getSpeedupLevel() > 1 && ol->getSizeLevel() < 2;
+        pto.SLPVectorization = ol->getSpeedupLevel() > 1 && ol->getSizeLevel() < 2;
+
+        auto pgoOptions = getPGOOptions(compileOptions);
+        if (pgoOptions && pgoOptions->Action == llvm::PGOOptions::IRUse && !llvm::sys::fs::exists(pgoOptions->ProfileFile))
+        {
+            return llvm::make_error<llvm::StringError>(
+                llvm::formatv("profile file '{0}' does not exist", pgoOptions->ProfileFile).str(),
+                llvm::inconvertibleErrorCode());
+        }
+
+        llvm::PassBuilder pb(targetMachine, pto, pgoOptions);
+
+        if (pgoOptions && pgoOptions->Action == llvm::PGOOptions::IRUse && *ol != llvm::OptimizationLevel::O0)
+        {
+            // move cold code (by profile) out of hot functions
+            pb.registerOptimizerLastEPCallback([](llvm::ModulePassManager &mpm, llvm::OptimizationLevel) {
+                mpm.addPass(llvm::HotColdSplittingPass());
+            });
+        }
 
         pb.registerModuleAnalyses(mam);
         pb.registerCGSCCAnalyses(cgam);
@@ -255,8 +357,14 @@ std::function<llvm::Error(llvm::Module *)> makeCustomPassesWithOptimizingTransfo
             mpm.addPass(ts::AliasPass(true, compileOptions.sizeBits));
         }
 
+        // with LTO the rest of optimizations is done by linker
+        auto lto = compileOptions.isJit ? LTONone : ltoMode.getValue();
         if (*ol == llvm::OptimizationLevel::O0)
-            mpm.addPass(pb.buildO0DefaultPipeline(*ol));
+            mpm.addPass(pb.buildO0DefaultPipeline(*ol, lto != LTONone));
+        else if (lto == LTOThin)
+            mpm.addPass(pb.buildThinLTOPreLinkDefaultPipeline(*ol));
+        else if (lto == LTOFull)
+            mpm.addPass(pb.buildLTOPreLinkDefaultPipeline(*ol));
         else
             mpm.addPass(pb.buildPerModuleDefaultPipeline(*ol));
 
@@ -288,21 +396,25 @@ std::function<llvm::Error(llvm::Module *)> makeCustomPassesWithOptimizingTransfo
     };
 }
 
-std::function<llvm::Error(llvm::Module *)> getTransformer(bool enableOpt, int optLevel, int sizeLevel, CompileOptions &compileOptions)
+std::function<llvm::Error(llvm::Module *)> getTransformer(bool enableOpt, int optLevel, int sizeLevel, CompileOptions &compileOptions,
+                                                          llvm::TargetMachine *targetMachine)
 {
 #ifdef ENABLE_CUSTOM_PASSES
     auto optPipeline = makeCustomPassesWithOptimizingTransformer(
         /*optLevel=*/enableOpt ? optLevel : 0,
         /*sizeLevel=*/enableOpt ? sizeLevel : 0,
-        /*targetMachine=*/nullptr,
+        targetMachine,
         compileOptions);
 #else
     // An optimization pipeline to use within the execution engine.
     auto optPipeline = mlir::makeOptimizingTransformer(
         /*optLevel=*/enableOpt ? optLevel : 0,
         /*sizeLevel=*/enableOpt ? sizeLevel : 0,
-        /*targetMachine=*/nullptr);
+        targetMachine);
 #endif
 
-    return optPipeline;
+    return [optPipeline](llvm::Module *module) -> llvm::Error {
+        auto timing = getRootTiming().nest("llvm-opt");
+        return optPipeline(module);
+    };
 }
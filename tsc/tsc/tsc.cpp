@@ -11,7 +11,9 @@
 #include "mlir/Pass/PassManager.h"
 #include "mlir/Debug/Counter.h"
 
+#include "llvm/ADT/ScopeExit.h"
 #include "llvm/Support/CommandLine.h"
+#include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/WithColor.h"
 #include "llvm/Support/Path.h"
@@ -42,7 +44,15 @@ int dumpLLVMIR(mlir::ModuleOp, CompileOptions&);
 int dumpObjOrAssembly(int, char **, enum Action, std::string, mlir::ModuleOp, CompileOptions&);
 int dumpObjOrAssembly(int, char **, mlir::ModuleOp, CompileOptions&);
 int buildExe(int, char **, std::string, CompileOptions&);
-int runJit(int, char **, mlir::ModuleOp, CompileOptions&);
+int runJit(int, char **, mlir::ModuleOp, CompileOptions&, llvm::StringRef, llvm::function_ref<void()>);
+int runJitObject(int, char **, std::unique_ptr<llvm::MemoryBuffer>, CompileOptions&);
+std::string getJitCacheKey(const char *, CompileOptions&);
+std::unique_ptr<llvm::MemoryBuffer> loadJitCache(llvm::StringRef);
+void storeJitCacheDependencies(llvm::StringRef, llvm::SourceMgr &);
+std::string getJitCacheObjectFile(llvm::StringRef);
+int runBatch(int, char **, mlir::DialectRegistry &, CompileOptions&);
+void initTimeReport();
+void printTimeReport();
 
 extern cl::OptionCategory ObjOrAssemblyCategory;
 cl::OptionCategory TypeScriptCompilerCategory("Compiler Options");
@@ -80,20 +90,46 @@ cl::opt<bool> enableOpt{"opt", cl::desc("Enable optimizations"), cl::init(false)
 cl::opt<int> optLevel{"opt_level", cl::desc("Optimization level"), cl::ZeroOrMore, cl::value_desc("0-3"), cl::init(3), cl::cat(TypeScriptCompilerCategory)};
 cl::opt<int> sizeLevel{"size_level", cl::desc("Optimization size level"), cl::ZeroOrMore, cl::value_desc("value"), cl::init(0), cl::cat(TypeScriptCompilerCategory)};
 
+// PGO
+cl::opt<std::string> profileGenerate{"profile-generate", cl::ValueOptional, cl::desc("Instrument code to write execution profile into directory <dir> (current directory by default), merge it with 'llvm-profdata merge'"), cl::value_desc("dir"), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<std::string> profileUse{"profile-use", cl::desc("Use execution profile to optimize code"), cl::value_desc("file.profdata"), cl::cat(TypeScriptCompilerCategory)};
+
 // dump obj
 cl::list<std::string> clSharedLibs{"shared-libs", cl::desc("Libraries to link dynamically. (used in --emit=jit)"), cl::ZeroOrMore, cl::MiscFlags::CommaSeparated,
                                    cl::cat(TypeScriptCompilerCategory)};
 
 cl::opt<std::string> mainFuncName{"e", cl::desc("The function to be called (default=main)"), cl::value_desc("function name"), cl::init("main"), cl::cat(TypeScriptCompilerCategory)};
 
+cl::opt<bool> lazyJit{"lazy-jit", cl::desc("Compile functions on the first call instead of the whole module before running (used in --emit=jit)"), cl::init(false), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<unsigned> jitCompileThreads{"jit-compile-threads", cl::desc("Number of background threads to compile functions (used with --lazy-jit)"), cl::value_desc("N"), cl::init(0), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<bool> tieredJit{"tiered-jit", cl::desc("Run functions unoptimized first and optimize them in background after --jit-tier-threshold calls (used in --emit=jit)"), cl::init(false), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<unsigned> jitTierThreshold{"jit-tier-threshold", cl::desc("Number of calls of function to optimize it (used with --tiered-jit)"), cl::value_desc("N"), cl::init(1000), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<std::string> jitCacheDir{"jit-cache", cl::desc("Directory to keep compiled object files, unchanged sources are run without compiling (used in --emit=jit)"), cl::value_desc("dir"), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<bool> perfMap{"perf-map", cl::desc("Write addresses and names of JIT-ed functions into /tmp/perf-<pid>.map for Linux perf (used in --emit=jit)"), cl::init(false), cl::cat(TypeScriptCompilerCategory)};
+cl::opt<bool> jitDump{"jitdump", cl::desc("Write jit-<pid>.dump for 'perf inject --jit', LLVM must be built with LLVM_USE_PERF (used in --emit=jit)"), cl::init(false), cl::cat(TypeScriptCompilerCategory)};
+
+cl::opt<bool> batchMode{"batch", cl::desc("Compile files listed in stdin one per line ('<input> [-o <output>]') in one process, reply '<ok|error> <input>' for each (used in --emit=obj and --emit=asm)"), cl::init(false), cl::cat(TypeScriptCompilerCategory)};
+cl::alias serverMode{"server", cl::desc("Alias for --batch"), cl::aliasopt(batchMode)};
+cl::opt<unsigned> batchThreads{"batch-threads", cl::desc("Number of threads to compile files (used with --batch, number of cores by default)"), cl::value_desc("N"), cl::init(0), cl::cat(TypeScriptCompilerCategory)};
+
 cl::opt<bool> dumpObjectFile{"dump-object-file", cl::Hidden, cl::desc("Dump JITted-compiled object to file specified with "
                                                                  "-object-filename (<input file>.o by default)."), cl::cat(TypeScriptCompilerDebugCategory)};
 
 cl::opt<std::string> objectFilename{"object-filename", cl::Hidden, cl::desc("Dump JITted-compiled object to file <input file>.o"), cl::cat(TypeScriptCompilerDebugCategory)};
 
+cl::opt<enum TimeReport> timeReport("time-report", cl::desc("Print time of compilation phases and counters of code generator"),
+                                       cl::values(clEnumValN(TimeReportText, "text", "report as text")),
+                                       cl::values(clEnumValN(TimeReportJson, "json", "report as JSON")),
+                                       cl::init(TimeReportNone),
+                                       cl::cat(TypeScriptCompilerCategory));
+cl::opt<std::string> timeReportFile{"time-report-file", cl::desc("Write time report to file instead of stderr (used with --time-report)"), cl::value_desc("filename"), cl::cat(TypeScriptCompilerCategory)};
+
+cl::opt<bool> typeCacheStats{"type-cache-stats", cl::Hidden, cl::desc("Print hits and misses of type relation cache of code generator"), cl::cat(TypeScriptCompilerDebugCategory)};
+
 // cl::opt<std::string> targetTriple("mtriple", cl::desc("Override target triple for module"));
 
 cl::opt<bool> disableGC("nogc", cl::desc("Disable Garbage collection"), cl::cat(TypeScriptCompilerCategory));
+cl::opt<bool> allocProfile("alloc-profile", cl::desc("Count GC allocations per call site and print top sites, GC count, pause time and heap size at exit"), cl::cat(TypeScriptCompilerCategory));
 cl::opt<bool> disableWarnings("nowarn", cl::desc("Disable Warnings"), cl::cat(TypeScriptCompilerCategory));
 cl::opt<bool> generateDebugInfo("di", cl::desc("Generate Debug Infomation"), cl::cat(TypeScriptCompilerCategory));
 cl::opt<bool> lldbDebugInfo("lldb", cl::desc("Debug Infomation for LLDB"), cl::cat(TypeScriptCompilerCategory));
@@ -107,6 +143,11 @@ cl::opt<std::string> llvmlibpath("llvm-lib-path", cl::desc("LLVM library path. S
 cl::opt<std::string> tsclibpath("tsc-lib-path", cl::desc("TypeScript Compiler Runtime library path. Should point to file 'TypeScriptAsyncRuntime.lib' or TSC_LIB_PATH environmental variable"), cl::value_desc("tsclibpath"), cl::cat(TypeScriptCompilerBuildCategory));
 cl::opt<std::string> emsdksysrootpath("emsdk-sysroot-path", cl::desc("TypeScript Compiler Runtime library path. Should point to dir '<...>/emsdk/upstream/emscripten/cache/sysroot' or EMSDK_SYSROOT_PATH environmental variable. (used when '-mtriple=wasm32-pc-emscripten')"), cl::value_desc("emsdksysrootpath"), cl::cat(TypeScriptCompilerBuildCategory));
 cl::list<std::string> libs{"lib", cl::desc("Libraries to link statically. (used in --emit=exe)"), cl::ZeroOrMore, cl::MiscFlags::CommaSeparated, cl::cat(TypeScriptCompilerBuildCategory)};
+cl::opt<enum LTOMode> ltoMode("lto", cl::desc("Link time optimization, object file contains LLVM bitcode and it is linked by LLD"),
+                                       cl::values(clEnumValN(LTOThin, "thin", "ThinLTO")),
+                                       cl::values(clEnumValN(LTOFull, "full", "full (monolithic) LTO")),
+                                       cl::init(LTONone),
+                                       cl::cat(TypeScriptCompilerBuildCategory));
 
 cl::opt<bool> noDefaultLib("no-default-lib", cl::desc("Disable loading default lib"), cl::init(false), cl::cat(TypeScriptCompilerCategory));
 cl::opt<bool> enableBuiltins("builtins", cl::desc("Builtin functionality (needed if Default lib is not provided)"), cl::init(true), cl::cat(TypeScriptCompilerCategory));
@@ -137,6 +178,27 @@ std::string GetTemporaryPath(llvm::StringRef Prefix, llvm::StringRef Suffix)
     return std::string(Path.str());
 }
 
+void loadMLIRDialects(mlir::MLIRContext &mlirContext)
+{
+    // Load our Dialect in this MLIR Context.
+    mlirContext.getOrLoadDialect<mlir::typescript::TypeScriptDialect>();
+    mlirContext.getOrLoadDialect<mlir::arith::ArithDialect>();
+    mlirContext.getOrLoadDialect<mlir::math::MathDialect>();
+    mlirContext.getOrLoadDialect<mlir::cf::ControlFlowDialect>();
+    mlirContext.getOrLoadDialect<mlir::func::FuncDialect>();
+    mlirContext.getOrLoadDialect<mlir::DLTIDialect>();
+    mlirContext.getOrLoadDialect<mlir::LLVM::LLVMDialect>();
+#ifdef ENABLE_ASYNC
+    mlirContext.getOrLoadDialect<mlir::async::AsyncDialect>();
+#endif
+
+#ifdef NDEBUG
+    mlirContext.printOpOnDiagnostic(false);
+#else 
+    mlirContext.printStackTraceOnDiagnostic(true);
+#endif
+}
+
 int main(int argc, char **argv)
 {
     // version printer
@@ -190,34 +252,55 @@ int main(int argc, char **argv)
 
     cl::ParseCommandLineOptions(argc, argv, "TypeScript native compiler\n");
 
-    if (emitAction == Action::DumpAST)
+    if (profileGenerate.getNumOccurrences() > 0 && !profileUse.empty())
     {
-        return dumpAST();
+        llvm::WithColor::error(llvm::errs(), "tsc") << "--profile-generate and --profile-use can't be used together\n";
+        return -1;
     }
 
-    // If we aren't dumping the AST, then we are compiling with/to MLIR.
-    mlir::DialectRegistry registry;
-    //mlir::func::registerAllExtensions(registry);
-    registerAllExtensions(registry);
+    if (ltoMode != LTONone && emitAction == Action::RunJIT)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--lto is ignored by JIT\n";
+    }
 
-    mlir::MLIRContext mlirContext(registry);
-    // Load our Dialect in this MLIR Context.
-    mlirContext.getOrLoadDialect<mlir::typescript::TypeScriptDialect>();
-    mlirContext.getOrLoadDialect<mlir::arith::ArithDialect>();
-    mlirContext.getOrLoadDialect<mlir::math::MathDialect>();
-    mlirContext.getOrLoadDialect<mlir::cf::ControlFlowDialect>();
-    mlirContext.getOrLoadDialect<mlir::func::FuncDialect>();
-    mlirContext.getOrLoadDialect<mlir::DLTIDialect>();
-    mlirContext.getOrLoadDialect<mlir::LLVM::LLVMDialect>();
-#ifdef ENABLE_ASYNC
-    mlirContext.getOrLoadDialect<mlir::async::AsyncDialect>();
-#endif
+    if (ltoMode != LTONone && emitAction == Action::DumpAssembly)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--lto is ignored with --emit=asm, assembly is generated by target\n";
+    }
 
-#ifdef NDEBUG
-    mlirContext.printOpOnDiagnostic(false);
-#else 
-    mlirContext.printStackTraceOnDiagnostic(true);
-#endif
+    if (lazyJit && dumpObjectFile)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--lazy-jit is ignored with --dump-object-file\n";
+    }
+
+    if (tieredJit && (lazyJit || dumpObjectFile || !jitCacheDir.empty()))
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--tiered-jit is ignored with --lazy-jit, --dump-object-file and --jit-cache\n";
+    }
+
+    if (lazyJit && !jitCacheDir.empty())
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--lazy-jit is ignored with --jit-cache\n";
+    }
+
+    if ((perfMap || jitDump) && emitAction != Action::RunJIT)
+    {
+        llvm::WithColor::warning(llvm::errs(), "tsc") << "--perf-map and --jitdump are used by JIT only\n";
+    }
+
+    if (batchMode && emitAction != Action::DumpObj && emitAction != Action::DumpAssembly)
+    {
+        llvm::WithColor::error(llvm::errs(), "tsc") << "--batch can be used only with --emit=obj or --emit=asm\n";
+        return -1;
+    }
+
+    if (emitAction == Action::DumpAST)
+    {
+        return dumpAST();
+    }
+
+    initTimeReport();
+    auto timeReportPrinter = llvm::make_scope_exit(printTimeReport);
 
     auto compileOptions = prepareOptions();
 
@@ -225,6 +308,30 @@ int main(int argc, char **argv)
     std::string fullPath = "jslib/";
     compileOptions.noDefaultLib |= !llvm::sys::fs::exists(fullPath);
 
+    // object file of the same sources and options is run without compiling
+    std::string jitCacheKey;
+    if (emitAction == Action::RunJIT && !jitCacheDir.empty() && !dumpObjectFile)
+    {
+        jitCacheKey = getJitCacheKey(argv[0], compileOptions);
+        if (auto cachedObject = loadJitCache(jitCacheKey))
+        {
+            return runJitObject(argc, argv, std::move(cachedObject), compileOptions);
+        }
+    }
+
+    // If we aren't dumping the AST, then we are compiling with/to MLIR.
+    mlir::DialectRegistry registry;
+    //mlir::func::registerAllExtensions(registry);
+    registerAllExtensions(registry);
+
+    if (batchMode)
+    {
+        return runBatch(argc, argv, registry, compileOptions);
+    }
+
+    mlir::MLIRContext mlirContext(registry);
+    loadMLIRDialects(mlirContext);
+
     llvm::SourceMgr sourceMgr;
     mlir::OwningOpRef<mlir::ModuleOp> module;
     if (int error = compileTypeScriptFileIntoMLIR(mlirContext, sourceMgr, module, compileOptions))
@@ -274,7 +381,9 @@ int main(int argc, char **argv)
     // Otherwise, we must be running the jit.
     if (emitAction == Action::RunJIT)
     {
-        return runJit(argc, argv, *module, compileOptions);
+        // dependencies are stored after object, so stale object of the key is never loaded with them
+        return runJit(argc, argv, *module, compileOptions, jitCacheKey.empty() ? "" : getJitCacheObjectFile(jitCacheKey),
+                      [&]() { storeJitCacheDependencies(jitCacheKey, sourceMgr); });
     }
 
     llvm::WithColor::error(llvm::errs(), "tsc") << "No action specified (parsing only?), use -emit=<action>\n";
@@ -99,9 +99,9 @@ std::string getDefaultExt(enum Action emitAction)
     return ext;    
 }
 
-std::string getDefaultOutputFileName(enum Action emitAction)
+std::string getDefaultOutputFileName(enum Action emitAction, llvm::StringRef IFN)
 {
-    if (inputFilename == "-")
+    if (IFN == "-")
     {
         return "-";
     }
@@ -109,7 +109,6 @@ std::string getDefaultOutputFileName(enum Action emitAction)
     std::string fileNameResult;
 
     // If InputFilename ends in .bc or .ll, remove it.
-    llvm::StringRef IFN = inputFilename;
     if (IFN.endswith(".ts"))
         fileNameResult = std::string(IFN.drop_back(3));
     else if (IFN.endswith(".mlir"))
@@ -201,6 +200,11 @@ std::string getDefaultOutputFileName(enum Action emitAction)
     return fileNameResult;
 }
 
+std::string getDefaultOutputFileName(enum Action emitAction)
+{
+    return getDefaultOutputFileName(emitAction, inputFilename);
+}
+
 std::string getDefaultOutputFileName()
 {
     return getDefaultOutputFileName(emitAction);